@@ -0,0 +1,136 @@
+#include "sonify.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Peak of one tone, low enough that a full set of voices rarely clips
+#define SONIFY_TONE_GAIN 0.12
+// Rise of every tone, long enough not to click
+#define SONIFY_ATTACK_SAMPLES 88
+// Reads are heard softer than the writes that move values
+#define SONIFY_READ_GAIN 0.6f
+
+void sonifier_init(struct Sonifier *sonifier)
+{
+    sonifier->bank = malloc((size_t)SONIFY_NOTES * SONIFY_TONE_SAMPLES * sizeof(float));
+    if (sonifier->bank == NULL)
+    {
+        fputs("Failed to allocate memory for tone bank\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+    const double pi = 3.14159265358979323846;
+    for (int note = 0; note < SONIFY_NOTES; note++)
+    {
+        double step = 2.0 * pi * SONIFY_LOWEST_HZ * pow(2.0, note / 12.0) / SONIFY_SAMPLE_RATE;
+        float *tone = sonifier->bank + (size_t)note * SONIFY_TONE_SAMPLES;
+        for (int i = 0; i < SONIFY_TONE_SAMPLES; i++)
+        {
+            // A quick rise, then a decay that reaches silence at the last sample so a finished voice doesn't click
+            double envelope;
+            if (i < SONIFY_ATTACK_SAMPLES)
+                envelope = (double)i / SONIFY_ATTACK_SAMPLES;
+            else
+            {
+                double left = 1.0 - (double)(i - SONIFY_ATTACK_SAMPLES) / (SONIFY_TONE_SAMPLES - SONIFY_ATTACK_SAMPLES);
+                envelope = left * left;
+            }
+            // The second harmonic keeps the low notes audible on small speakers
+            double phase = step * i;
+            tone[i] = (float)(SONIFY_TONE_GAIN * envelope * (sin(phase) + 0.3 * sin(2.0 * phase)));
+        }
+    }
+    sonifier->queue.noteScale = 0.0f;
+    atomic_store(&sonifier->queue.head, 0);
+    sonifier->queue.tail = 0;
+    for (size_t i = 0; i < SONIFY_QUEUE_CAPACITY; i++)
+    {
+        atomic_store(&sonifier->queue.slots[i].sequence, i);
+        sonifier->queue.slots[i].event = 0;
+    }
+    memset(sonifier->voices, 0, sizeof(sonifier->voices));
+    sonifier->nextVoice = 0;
+    atomic_store(&sonifier->flush, false);
+}
+
+void sonifier_free(struct Sonifier *sonifier)
+{
+    free(sonifier->bank);
+    sonifier->bank = NULL;
+}
+
+void sonifier_scale(struct Sonifier *sonifier, SortValueType maximum)
+{
+    sonifier->queue.noteScale = maximum > 0 ? (float)(SONIFY_NOTES - 1) / (float)maximum : 0.0f;
+}
+
+void sonifier_flush(struct Sonifier *sonifier)
+{
+    atomic_store(&sonifier->flush, true);
+}
+
+// Take every event published so far off the queue, at most its capacity
+static size_t sonifier_pop(struct Sonifier *sonifier)
+{
+    struct ToneQueue *queue = &sonifier->queue;
+    size_t popped = 0;
+    // Producers refill the slots freed here while it runs, so it stops at the capacity pending holds
+    while (popped < SONIFY_QUEUE_CAPACITY)
+    {
+        struct ToneSlot *slot = &queue->slots[queue->tail & (SONIFY_QUEUE_CAPACITY - 1)];
+        if (atomic_load_explicit(&slot->sequence, memory_order_acquire) != queue->tail + 1)
+            return popped;
+        sonifier->pending[popped++] = slot->event;
+        atomic_store_explicit(&slot->sequence, queue->tail + SONIFY_QUEUE_CAPACITY, memory_order_release);
+        queue->tail++;
+    }
+    return popped;
+}
+
+void sonifier_mix(struct Sonifier *sonifier, float *output, size_t frames)
+{
+    size_t events = sonifier_pop(sonifier);
+    if (atomic_exchange(&sonifier->flush, false))
+    {
+        events = 0;
+        memset(sonifier->voices, 0, sizeof(sonifier->voices));
+    }
+    // As many tones as the voices hold without one being cut off before it has faded out
+    size_t limit = SONIFY_VOICES * frames / SONIFY_TONE_SAMPLES;
+    if (limit < 1)
+        limit = 1;
+    size_t started = events < limit ? events : limit;
+    for (size_t i = 0; i < started; i++)
+    {
+        uint32_t event = sonifier->pending[i * events / started];
+        struct ToneVoice *voice = &sonifier->voices[sonifier->nextVoice];
+        sonifier->nextVoice = (sonifier->nextVoice + 1) % SONIFY_VOICES;
+        voice->samples = sonifier->bank + (size_t)(event & (SONIFY_EVENT_WRITE - 1)) * SONIFY_TONE_SAMPLES;
+        voice->position = -(int)(i * frames / started);
+        voice->gain = (event & SONIFY_EVENT_WRITE) != 0 ? 1.0f : SONIFY_READ_GAIN;
+    }
+    memset(output, 0, frames * sizeof(float));
+    for (size_t v = 0; v < SONIFY_VOICES; v++)
+    {
+        struct ToneVoice *voice = &sonifier->voices[v];
+        if (voice->samples == NULL)
+            continue;
+        // Stretch of the buffer the tone covers, a contiguous add the compiler vectorizes
+        size_t first = voice->position < 0 ? (size_t)-voice->position : 0;
+        const float *samples = voice->samples + (voice->position + (int)first);
+        size_t left = (size_t)(SONIFY_TONE_SAMPLES - (voice->position + (int)first));
+        size_t last = frames - first < left ? frames : first + left;
+        float gain = voice->gain;
+        for (size_t i = first; i < last; i++)
+        {
+            output[i] += gain * samples[i - first];
+        }
+        voice->position += (int)frames;
+        if (voice->position >= SONIFY_TONE_SAMPLES)
+            voice->samples = NULL;
+    }
+    for (size_t i = 0; i < frames; i++)
+    {
+        output[i] = fminf(fmaxf(output[i], -1.0f), 1.0f);
+    }
+}
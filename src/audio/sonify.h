@@ -0,0 +1,113 @@
+#ifndef SONIFY_H
+#define SONIFY_H
+
+#include "sorts/sort_types.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Rate the tones are synthesized and mixed at, mono 32 bit float
+#define SONIFY_SAMPLE_RATE 44100
+// Pitches values are mapped onto, a semitone apart upwards from SONIFY_LOWEST_HZ
+#define SONIFY_NOTES 48
+#define SONIFY_LOWEST_HZ 110.0
+// Length of every tone, 30 ms
+#define SONIFY_TONE_SAMPLES 1323
+// Tones sounding at once, starting another steals the one started longest ago
+#define SONIFY_VOICES 32
+// Events waiting for the mixer, a power of two so positions wrap with a mask
+#define SONIFY_QUEUE_CAPACITY 4096
+
+// An event queued with this bit set is a write, otherwise a read
+#define SONIFY_EVENT_WRITE 0x10000u
+
+struct ToneSlot {
+    // Position the slot is free to be written at, or one past the position it holds an event for
+    _Atomic size_t sequence;
+    uint32_t event;
+};
+
+/*
+* Bounded lock-free queue of the accesses to be heard, after Vyukov's MPMC queue with a single consumer. Sorting
+* threads, every worker of a parallel sort, and the drawing thread replaying a streamed sort push into it and the
+* audio callback pops. A push claims a slot with one compare and swap and never waits: when the queue is full the
+* event is dropped, the mixer could only have played a sample of them anyway.
+*/
+struct ToneQueue {
+    // Values are mapped onto notes by multiplying by this, set before the producers of a run start
+    float noteScale;
+    char padding[64];
+    _Atomic size_t head;
+    char producerPadding[64];
+    // Consumer side
+    size_t tail;
+    struct ToneSlot slots[SONIFY_QUEUE_CAPACITY];
+};
+
+// A tone being played, samples is NULL for an idle voice
+struct ToneVoice {
+    const float *samples;
+    // Sample of the tone played at the start of the next buffer, negative while it is yet to start
+    int position;
+    float gain;
+};
+
+/*
+* Turns array accesses into sound. Every note is synthesized once up front, envelope and all, into a bank of tones,
+* so playing one is only adding a stretch of it into the output. Events popped for a buffer are spread evenly over
+* it, and at most as many are started as the voices can play without cutting one off, picked evenly from whatever
+* arrived; the rest are dropped so the sound keeps up with the sort. The mixer allocates nothing and takes no
+* locks, it runs on the audio device's thread.
+*/
+struct Sonifier {
+    struct ToneQueue queue;
+    // SONIFY_NOTES tones of SONIFY_TONE_SAMPLES each
+    float *bank;
+    struct ToneVoice voices[SONIFY_VOICES];
+    // Voice the next tone starts on, every tone is the same length so this is always the oldest
+    size_t nextVoice;
+    // Set to have the mixer throw away what is queued and silence every voice before its next buffer
+    _Atomic bool flush;
+    // Events popped for the buffer being mixed
+    uint32_t pending[SONIFY_QUEUE_CAPACITY];
+};
+
+void sonifier_init(struct Sonifier *sonifier);
+void sonifier_free(struct Sonifier *sonifier);
+// Map values from 0 to maximum onto the notes, while nothing is pushing
+void sonifier_scale(struct Sonifier *sonifier, SortValueType maximum);
+// Drop everything queued and stop every tone, from any thread
+void sonifier_flush(struct Sonifier *sonifier);
+// Mix the next frames samples into output, from the consumer only
+void sonifier_mix(struct Sonifier *sonifier, float *output, size_t frames);
+
+// Queue the tone of value, dropping it when the queue is full. Never blocks
+static inline void tone_queue_push(struct ToneQueue *queue, SortValueType value, bool write)
+{
+    uint32_t note = (uint32_t)((float)value * queue->noteScale);
+    if (note >= SONIFY_NOTES)
+        note = SONIFY_NOTES - 1;
+    size_t position = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    struct ToneSlot *slot;
+    for (;;)
+    {
+        slot = &queue->slots[position & (SONIFY_QUEUE_CAPACITY - 1)];
+        size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        if (sequence == position)
+        {
+            if (atomic_compare_exchange_weak_explicit(&queue->head, &position, position + 1, memory_order_relaxed,
+                                                      memory_order_relaxed))
+                break;
+        }
+        // The slot still holds an event from a lap ago
+        else if (sequence < position)
+            return;
+        else
+            position = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    }
+    slot->event = note | (write ? SONIFY_EVENT_WRITE : 0u);
+    atomic_store_explicit(&slot->sequence, position + 1, memory_order_release);
+}
+
+#endif // !SONIFY_H
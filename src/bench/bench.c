@@ -0,0 +1,221 @@
+#include "bench.h"
+#include "sorts/distribution.h"
+#include "sorts/random.h"
+#include "io/results.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const struct BenchSuite suites[] = {
+    {"phases", "Barrier overhead per phase of the parallel odd-even and shear sorts", bench_phases},
+    {"select", "Selection of the k smallest values against sorting everything and taking a prefix", bench_select},
+    {"shuffle", "Shuffle throughput of the seeded generator against libc rand()", bench_shuffle},
+    {"auto", "Auto sort decisions and timings against every sort it can dispatch to", bench_auto},
+    {"matrix", "Every sort against every input distribution", bench_matrix},
+    {"generate", "Input generation throughput per distribution and thread count", bench_generate},
+    {"file", "Sorts run directly on a memory mapped binary file of keys", bench_file},
+    {"external", "Out of core sort throughput for files larger than the memory budget", bench_external},
+    {"kway", "Loser tree k-way merge against repeated two-way merges for k = 2..1024", bench_kway},
+    {"perf", "Hardware counters (cycles, IPC, cache, branch and TLB misses) of every sort", bench_perf},
+    {"isa", "Dispatched kernels at every CPU level from scalar up to the one detected", bench_isa},
+    {"compare", "Per kernel wall time of two CSV results logs side by side, as before and after PGO", bench_compare},
+};
+static const size_t totalSuites = sizeof(suites) / sizeof(struct BenchSuite);
+
+size_t bench_parse_sizes(const char *text, size_t *sizes, size_t maxSizes)
+{
+    size_t written = 0;
+    while (*text != '\0' && written < maxSizes)
+    {
+        char *end;
+        errno = 0;
+        unsigned long long size = strtoull(text, &end, 10);
+        if (end == text || errno != 0)
+        {
+            fprintf(stderr, "Invalid size list: %s\n", text);
+            exit(EXIT_FAILURE);
+        }
+        switch (*end)
+        {
+        case 'k':
+        case 'K':
+            size <<= 10;
+            end++;
+            break;
+        case 'm':
+        case 'M':
+            size <<= 20;
+            end++;
+            break;
+        case 'g':
+        case 'G':
+            size <<= 30;
+            end++;
+            break;
+        default:
+            break;
+        }
+        sizes[written++] = (size_t)size;
+        text = *end == ',' ? end + 1 : end;
+    }
+    return written;
+}
+
+size_t bench_parse_distributions(const char *text, enum Distribution *distributions, size_t maxDistributions)
+{
+    size_t written = 0;
+    if (strcmp(text, "all") == 0)
+    {
+        for (enum Distribution d = 0; d < NumDistributions && written < maxDistributions; d++)
+            distributions[written++] = d;
+        return written;
+    }
+    char name[64];
+    while (*text != '\0' && written < maxDistributions)
+    {
+        size_t length = strcspn(text, ",");
+        if (length >= sizeof(name))
+            length = sizeof(name) - 1;
+        memcpy(name, text, length);
+        name[length] = '\0';
+        enum Distribution distribution = distribution_from_name(name);
+        if (distribution == NumDistributions)
+        {
+            fprintf(stderr, "Unknown distribution: %s\n", name);
+            exit(EXIT_FAILURE);
+        }
+        distributions[written++] = distribution;
+        text += strcspn(text, ",");
+        if (*text == ',')
+            text++;
+    }
+    return written;
+}
+
+const char *bench_option(int argc, char **argv, const char *name, const char *fallback)
+{
+    for (int i = 0; i + 1 < argc; i++)
+    {
+        if (strcmp(argv[i], name) == 0)
+            return argv[i + 1];
+    }
+    return fallback;
+}
+
+SortValueType *bench_alloc_values(size_t count)
+{
+    SortValueType *values = malloc(count * sizeof(SortValueType));
+    if (values == NULL)
+    {
+        fputs("Failed to allocate memory for benchmark values\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+    return values;
+}
+
+void bench_fill_shuffled(SortValueType *values, size_t count)
+{
+    const size_t largest = (SortValueType)~(SortValueType)0;
+    for (size_t i = 0; i < count; i++)
+    {
+        values[i] = (SortValueType)(i % largest + 1);
+    }
+    shuffle(values, count, NULL);
+}
+
+struct SortFunctionArgs bench_sort_args(struct BenchRun *run, SortValueType *values, size_t count)
+{
+    sort_stats_reset(&run->sortStats);
+    run->sortStats.heatmap = NULL;
+    run->sortStats.pacer = NULL;
+    run->sortStats.ops = NULL;
+    run->sortStats.tones = NULL;
+    atomic_store(&run->cancelSort, false);
+    run->speed = 0.0f;
+    struct SortFunctionArgs args = {&run->sortStats, values, count, &run->cancelSort, &run->speed, NULL};
+    return args;
+}
+
+// Results log opened from --results, shared by every suite
+static struct ResultsLog results;
+static bool recording = false;
+
+void bench_record(const char *suite, const char *algorithm, size_t count, const char *distribution,
+                  uint64_t wallNanoseconds, const struct SortStats *sortStats, const struct PerfSample *perf)
+{
+    if (!recording)
+        return;
+    struct RunRecord record;
+    record.source = suite;
+    record.algorithm = algorithm;
+    record.count = count;
+    record.distribution = distribution;
+    record.seed = random_global_seed();
+    record.wallNanoseconds = wallNanoseconds;
+    record.sortStats = *sortStats;
+    record.perf = perf;
+    results_write(&results, &record);
+}
+
+double nanoseconds_to_milliseconds(uint64_t nanoseconds)
+{
+    return (double)nanoseconds / 1e6;
+}
+
+static void print_usage(void)
+{
+    fputs("Usage: SortSimBench <suite> [--seed n] [--trace trace.json] [--results runs.csv|runs.jsonl]\n"
+          "                    [--isa scalar|sse4.2|avx2|avx512] [options]\n\nSuites:\n", stderr);
+    for (size_t i = 0; i < totalSuites; i++)
+    {
+        fprintf(stderr, "  %-10s %s\n", suites[i].name, suites[i].description);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    random_set_global_seed(strtoull(bench_option(argc, argv, "--seed", "1"), NULL, 0));
+    random_seed_thread(RandomStreamBench);
+    // Every suite runs the kernels of the widest instruction set the CPU has unless --isa holds them to a lower one
+    cpu_dispatch_init();
+    const char *isaName = bench_option(argc, argv, "--isa", NULL);
+    if (isaName != NULL && !cpu_dispatch_force(isaName))
+        return EXIT_FAILURE;
+    if (argc < 2)
+    {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+    const char *resultsPath = bench_option(argc, argv, "--results", NULL);
+    if (resultsPath != NULL)
+    {
+        if (!results_open(&results, resultsPath, "SortSimBench"))
+            return EXIT_FAILURE;
+        recording = true;
+    }
+    const char *tracePath = bench_option(argc, argv, "--trace", NULL);
+    if (tracePath != NULL)
+    {
+        trace_enable();
+        trace_thread_name("Bench");
+    }
+    for (size_t i = 0; i < totalSuites; i++)
+    {
+        if (strcmp(argv[1], suites[i].name) == 0)
+        {
+            int result = suites[i].run(argc - 2, argv + 2);
+            if (tracePath != NULL)
+            {
+                if (!trace_write(tracePath))
+                    result = EXIT_FAILURE;
+                trace_shutdown();
+            }
+            if (recording)
+                results_close(&results);
+            return result;
+        }
+    }
+    print_usage();
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,57 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "sorts/sorts.h"
+#include "perf/perf_counters.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define BENCH_MAX_LIST 32
+
+// Stats, cancel flag and zero delay that a headless sort run points its SortFunctionArgs at
+struct BenchRun {
+    struct SortStats sortStats;
+    _Atomic bool cancelSort;
+    float speed;
+};
+
+// A benchmark suite, run as `SortSimBench <name> [options]`
+struct BenchSuite {
+    const char *name;
+    const char *description;
+    int (*run)(int argc, char **argv);
+};
+
+// Parse a comma separated list of sizes such as "256,4k,1m". Returns how many were written to sizes
+size_t bench_parse_sizes(const char *text, size_t *sizes, size_t maxSizes);
+// Parse a comma separated list of distribution names such as "shuffled,few-unique", or "all". Returns how many
+// were written to distributions
+size_t bench_parse_distributions(const char *text, enum Distribution *distributions, size_t maxDistributions);
+// Value of `--name value` in argv, or fallback when it is missing
+const char *bench_option(int argc, char **argv, const char *name, const char *fallback);
+// Allocate count values or exit
+SortValueType *bench_alloc_values(size_t count);
+// Fill values with a shuffled permutation of 1..count, wrapping around past the largest SortValueType
+void bench_fill_shuffled(SortValueType *values, size_t count);
+// Reset run and return sort arguments that run values at full speed
+struct SortFunctionArgs bench_sort_args(struct BenchRun *run, SortValueType *values, size_t count);
+double nanoseconds_to_milliseconds(uint64_t nanoseconds);
+// Append a run to the --results log, nothing happens without one. perf may be NULL
+void bench_record(const char *suite, const char *algorithm, size_t count, const char *distribution,
+                  uint64_t wallNanoseconds, const struct SortStats *sortStats, const struct PerfSample *perf);
+
+int bench_phases(int argc, char **argv);
+int bench_select(int argc, char **argv);
+int bench_auto(int argc, char **argv);
+int bench_shuffle(int argc, char **argv);
+int bench_matrix(int argc, char **argv);
+int bench_generate(int argc, char **argv);
+int bench_file(int argc, char **argv);
+int bench_external(int argc, char **argv);
+int bench_kway(int argc, char **argv);
+int bench_perf(int argc, char **argv);
+int bench_isa(int argc, char **argv);
+int bench_compare(int argc, char **argv);
+
+#endif // !BENCH_H
@@ -0,0 +1,74 @@
+#include "bench.h"
+#include "sorts/auto_sort.h"
+#include "sorts/distribution.h"
+#include "sorts/random.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+* For every input distribution and size print what the auto sort decided and why, then how long the auto sort took
+* (probe included) next to each sort it can dispatch to, so a wrong decision shows up as a slower row.
+*/
+int bench_auto(int argc, char **argv)
+{
+    size_t sizes[BENCH_MAX_LIST];
+    size_t sizeCount = bench_parse_sizes(bench_option(argc, argv, "--sizes", "1k,64k,1m"), sizes, BENCH_MAX_LIST);
+    enum Distribution distributions[NumDistributions];
+    size_t distributionCount = bench_parse_distributions(
+        bench_option(argc, argv, "--dist", "shuffled,sorted,reversed,sorted-runs,few-unique"), distributions,
+        NumDistributions);
+    const enum SortType candidates[] = {AutoSort, InsertionSort, CountingSort, RadixSort, NaturalMergeSort,
+                                        IntroSort};
+    const size_t totalCandidates = sizeof(candidates) / sizeof(enum SortType);
+
+    for (size_t i = 0; i < sizeCount; i++)
+    {
+        size_t count = sizes[i];
+        SortValueType *input = bench_alloc_values(count);
+        SortValueType *values = bench_alloc_values(count);
+        for (size_t d = 0; d < distributionCount; d++)
+        {
+            const char *distributionName = distributionNames[distributions[d]];
+            distribution_generate(input, count, distributions[d], NULL, random_next(random_thread_state()), 0);
+            struct AutoSortDecision decision;
+            uint64_t start = monotonic_nanoseconds();
+            auto_sort_probe(input, count, &decision);
+            uint64_t probeTime = monotonic_nanoseconds() - start;
+            printf("\n%s, %zu values: probe took %.3f ms and picked %s (%s)\n", distributionName, count,
+                   nanoseconds_to_milliseconds(probeTime), sortNames[decision.sort], decision.reason);
+            printf("  %-20s %12s %14s\n", "sort", "ms", "comparisons");
+            for (size_t c = 0; c < totalCandidates; c++)
+            {
+                // Quadratic sorts are only worth timing on small inputs
+                if (candidates[c] == InsertionSort && count > 65536 && distributions[d] != DistributionSorted)
+                    continue;
+                struct BenchRun run;
+                memcpy(values, input, count * sizeof(SortValueType));
+                struct SortFunctionArgs args = bench_sort_args(&run, values, count);
+                start = monotonic_nanoseconds();
+                if (candidates[c] == AutoSort)
+                {
+                    auto_sort_probe(values, count, &decision);
+                    auto_sort_dispatch(args, &decision);
+                }
+                else
+                {
+                    sortFunctions[candidates[c]](args);
+                }
+                uint64_t elapsed = monotonic_nanoseconds() - start;
+                if (!is_already_sorted(values, count, NULL))
+                {
+                    fprintf(stderr, "%s failed to sort %zu %s values\n", sortNames[candidates[c]], count,
+                            distributionName);
+                    return EXIT_FAILURE;
+                }
+                printf("  %-20s %12.3f %14zu\n", sortNames[candidates[c]], nanoseconds_to_milliseconds(elapsed),
+                       run.sortStats.comparisons);
+            }
+        }
+        free(values);
+        free(input);
+    }
+    return EXIT_SUCCESS;
+}
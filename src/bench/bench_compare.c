@@ -0,0 +1,204 @@
+#include "bench.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Longest CSV line read, records are far shorter
+#define COMPARE_LINE_LENGTH 4096
+// Longest field kept, longer ones are cut
+#define COMPARE_FIELD_LENGTH 96
+
+enum CompareColumn {
+    CompareSource,
+    CompareAlgorithm,
+    CompareSize,
+    CompareDistribution,
+    CompareWall,
+    NumCompareColumns,
+};
+
+static const char *const compareColumnNames[NumCompareColumns] = {"source", "algorithm", "size", "distribution",
+                                                                   "wall_ms"};
+
+// One kernel on one input, with its fastest time in each of the two logs, NAN where it is missing
+struct CompareEntry {
+    char source[COMPARE_FIELD_LENGTH];
+    char algorithm[COMPARE_FIELD_LENGTH];
+    char distribution[COMPARE_FIELD_LENGTH];
+    size_t size;
+    double milliseconds[2];
+};
+
+struct CompareTable {
+    struct CompareEntry *entries;
+    size_t count;
+    size_t capacity;
+};
+
+// Split one CSV line into fields, unquoting them. Returns the number of fields written
+static size_t compare_split(char *line, char fields[][COMPARE_FIELD_LENGTH], size_t maxFields)
+{
+    size_t written = 0;
+    char *cursor = line;
+    while (written < maxFields)
+    {
+        char *field = fields[written++];
+        size_t length = 0;
+        bool quoted = *cursor == '"';
+        if (quoted)
+            cursor++;
+        for (; *cursor != '\0'; cursor++)
+        {
+            if (quoted && *cursor == '"')
+            {
+                // A doubled quote is a quote, a single one ends the field
+                if (cursor[1] != '"')
+                {
+                    quoted = false;
+                    continue;
+                }
+                cursor++;
+            }
+            else if (!quoted && (*cursor == ',' || *cursor == '\n' || *cursor == '\r'))
+                break;
+            if (length + 1 < COMPARE_FIELD_LENGTH)
+                field[length++] = *cursor;
+        }
+        field[length] = '\0';
+        if (*cursor != ',')
+            break;
+        cursor++;
+    }
+    return written;
+}
+
+static struct CompareEntry *compare_find(struct CompareTable *table, char fields[][COMPARE_FIELD_LENGTH],
+                                         const size_t *columns, size_t size)
+{
+    for (size_t i = 0; i < table->count; i++)
+    {
+        struct CompareEntry *entry = &table->entries[i];
+        if (entry->size == size && strcmp(entry->source, fields[columns[CompareSource]]) == 0 &&
+            strcmp(entry->algorithm, fields[columns[CompareAlgorithm]]) == 0 &&
+            strcmp(entry->distribution, fields[columns[CompareDistribution]]) == 0)
+            return entry;
+    }
+    if (table->count == table->capacity)
+    {
+        table->capacity = table->capacity > 0 ? table->capacity * 2 : 64;
+        table->entries = realloc(table->entries, table->capacity * sizeof(struct CompareEntry));
+        if (table->entries == NULL)
+        {
+            fputs("Failed to allocate memory for benchmark comparison\n", stderr);
+            exit(EXIT_FAILURE);
+        }
+    }
+    struct CompareEntry *entry = &table->entries[table->count++];
+    snprintf(entry->source, sizeof(entry->source), "%s", fields[columns[CompareSource]]);
+    snprintf(entry->algorithm, sizeof(entry->algorithm), "%s", fields[columns[CompareAlgorithm]]);
+    snprintf(entry->distribution, sizeof(entry->distribution), "%s", fields[columns[CompareDistribution]]);
+    entry->size = size;
+    entry->milliseconds[0] = NAN;
+    entry->milliseconds[1] = NAN;
+    return entry;
+}
+
+// Read the wall times of a CSV results log into side 0 or 1 of the table. Prints why and returns false on failure
+static bool compare_read(struct CompareTable *table, const char *path, size_t side)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Failed to open %s\n", path);
+        return false;
+    }
+    static char line[COMPARE_LINE_LENGTH];
+    static char fields[64][COMPARE_FIELD_LENGTH];
+    size_t columns[NumCompareColumns];
+    size_t fieldCount = 0;
+    bool found = fgets(line, sizeof(line), file) != NULL;
+    if (found)
+    {
+        fieldCount = compare_split(line, fields, 64);
+        for (size_t c = 0; c < NumCompareColumns && found; c++)
+        {
+            found = false;
+            for (size_t f = 0; f < fieldCount && !found; f++)
+            {
+                found = strcmp(fields[f], compareColumnNames[c]) == 0;
+                columns[c] = f;
+            }
+        }
+    }
+    if (!found)
+    {
+        fprintf(stderr, "%s is not a CSV results log, write one with --results runs.csv\n", path);
+        fclose(file);
+        return false;
+    }
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        if (compare_split(line, fields, 64) != fieldCount)
+            continue;
+        size_t size = (size_t)strtoull(fields[columns[CompareSize]], NULL, 10);
+        double milliseconds = strtod(fields[columns[CompareWall]], NULL);
+        struct CompareEntry *entry = compare_find(table, fields, columns, size);
+        // Repeats of a run keep their fastest time, the one least disturbed by the rest of the machine
+        if (isnan(entry->milliseconds[side]) || milliseconds < entry->milliseconds[side])
+            entry->milliseconds[side] = milliseconds;
+    }
+    fclose(file);
+    return true;
+}
+
+/*
+* Wall time of every kernel in one results log against another, such as the same suites run on a build before and
+* after a change to its flags. Runs are matched by suite, algorithm, distribution and size, and runs only one of
+* the logs has are left out. Ends with the geometric mean of the speedups, above 1 when the second log is faster.
+*/
+int bench_compare(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        fputs("Usage: SortSimBench compare before.csv after.csv\n", stderr);
+        return EXIT_FAILURE;
+    }
+    struct CompareTable table = {NULL, 0, 0};
+    if (!compare_read(&table, argv[0], 0) || !compare_read(&table, argv[1], 1))
+    {
+        free(table.entries);
+        return EXIT_FAILURE;
+    }
+    printf("%-8s %-22s %-14s %9s %12s %12s %8s\n", "suite", "algorithm", "distribution", "size", "before ms",
+           "after ms", "speedup");
+    double logSum = 0.0;
+    size_t compared = 0;
+    for (size_t i = 0; i < table.count; i++)
+    {
+        const struct CompareEntry *entry = &table.entries[i];
+        double before = entry->milliseconds[0];
+        double after = entry->milliseconds[1];
+        if (isnan(before) || isnan(after))
+            continue;
+        printf("%-8s %-22s %-14s %9zu %12.3f %12.3f", entry->source, entry->algorithm, entry->distribution,
+               entry->size, before, after);
+        // Runs too quick for the clock to time say nothing about either build
+        if (before > 0.0 && after > 0.0)
+        {
+            printf(" %7.2fx\n", before / after);
+            logSum += log(before / after);
+            compared++;
+        }
+        else
+        {
+            printf(" %8s\n", "-");
+        }
+    }
+    if (compared > 0)
+        printf("\nGeometric mean speedup over %zu runs: %.3fx\n", compared, exp(logSum / (double)compared));
+    else
+        puts("\nNo run is in both logs");
+    free(table.entries);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,129 @@
+#include "bench.h"
+#include "io/external_sort.h"
+#include "sorts/distribution.h"
+#include "sorts/random.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BENCH_EXTERNAL_BLOCK ((size_t)1 << 20)
+
+// Sum and xor of every key in a file, which a sort has to leave as they were. Sortedness and the count alone don't
+// catch a key lost and another written twice
+struct KeyChecksum {
+    uint64_t sum;
+    uint64_t xorSum;
+};
+
+static void key_checksum_add(struct KeyChecksum *checksum, const SortValueType *values, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        checksum->sum += (uint64_t)values[i];
+        checksum->xorSum ^= (uint64_t)values[i];
+    }
+}
+
+// Write count values to path, generated a block at a time so the file can be far larger than memory, and checksum
+// them
+static bool write_input(const char *path, size_t count, enum Distribution distribution, struct KeyChecksum *checksum)
+{
+    FILE *file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        perror(path);
+        return false;
+    }
+    SortValueType *block = bench_alloc_values(BENCH_EXTERNAL_BLOCK);
+    bool ok = true;
+    for (size_t written = 0; written < count && ok; written += BENCH_EXTERNAL_BLOCK)
+    {
+        size_t n = count - written < BENCH_EXTERNAL_BLOCK ? count - written : BENCH_EXTERNAL_BLOCK;
+        distribution_generate(block, n, distribution, NULL, random_next(random_thread_state()), 0);
+        key_checksum_add(checksum, block, n);
+        ok = fwrite(block, sizeof(SortValueType), n, file) == n;
+    }
+    free(block);
+    return fclose(file) == 0 && ok;
+}
+
+// Stream path back and check it holds count values in ascending order with the checksum of the input
+static bool check_output(const char *path, size_t count, const struct KeyChecksum *expected)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        perror(path);
+        return false;
+    }
+    SortValueType *block = bench_alloc_values(BENCH_EXTERNAL_BLOCK);
+    size_t seen = 0;
+    SortValueType previous = 0;
+    struct KeyChecksum checksum = {0, 0};
+    bool sorted = true;
+    size_t n;
+    while (sorted && (n = fread(block, sizeof(SortValueType), BENCH_EXTERNAL_BLOCK, file)) > 0)
+    {
+        sorted = is_already_sorted(block, n, NULL) && (seen == 0 || previous <= block[0]);
+        previous = block[n - 1];
+        key_checksum_add(&checksum, block, n);
+        seen += n;
+    }
+    free(block);
+    fclose(file);
+    return sorted && seen == count && checksum.sum == expected->sum && checksum.xorSum == expected->xorSum;
+}
+
+/*
+* Sort a generated file with the external sort under a memory budget smaller than the file, and report the
+* throughput. The input and output are written to --temp, which should be on the disk being measured.
+*/
+int bench_external(int argc, char **argv)
+{
+    size_t sizes[BENCH_MAX_LIST];
+    size_t sizeCount = bench_parse_sizes(bench_option(argc, argv, "--sizes", "16m,64m"), sizes, BENCH_MAX_LIST);
+    size_t memoryBudgets[BENCH_MAX_LIST];
+    size_t memoryCount = bench_parse_sizes(bench_option(argc, argv, "--memory", "16m,64m"), memoryBudgets,
+                                           BENCH_MAX_LIST);
+    enum Distribution distribution;
+    bench_parse_distributions(bench_option(argc, argv, "--dist", "random"), &distribution, 1);
+    const char *directory = bench_option(argc, argv, "--temp", ".");
+    char inputPath[1024];
+    char outputPath[1024];
+    snprintf(inputPath, sizeof(inputPath), "%s/sortsim-bench-input.bin", directory);
+    snprintf(outputPath, sizeof(outputPath), "%s/sortsim-bench-output.bin", directory);
+
+    printf("%12s %10s %6s %6s %10s %10s\n", "values", "memory", "runs", "passes", "ms", "MiB/s");
+    for (size_t i = 0; i < sizeCount; i++)
+    {
+        struct KeyChecksum checksum = {0, 0};
+        if (!write_input(inputPath, sizes[i], distribution, &checksum))
+        {
+            fprintf(stderr, "Failed to write %s\n", inputPath);
+            return EXIT_FAILURE;
+        }
+        for (size_t m = 0; m < memoryCount; m++)
+        {
+            struct ExternalSortOptions options = {inputPath, outputPath, directory, memoryBudgets[m]};
+            struct ExternalSortProgress progress;
+            struct BenchRun run;
+            bench_sort_args(&run, NULL, 0);
+            uint64_t start = monotonic_nanoseconds();
+            bool ok = external_sort(&options, &run.sortStats, &run.cancelSort, &progress);
+            uint64_t elapsed = monotonic_nanoseconds() - start;
+            if (!ok || !check_output(outputPath, sizes[i], &checksum))
+            {
+                fprintf(stderr, "External sort of %zu values with %zu bytes failed\n", sizes[i], memoryBudgets[m]);
+                remove(inputPath);
+                remove(outputPath);
+                return EXIT_FAILURE;
+            }
+            double mebibytes = (double)(sizes[i] * sizeof(SortValueType)) / 1048576.0;
+            printf("%12zu %9zuM %6zu %6zu %10.1f %10.1f\n", sizes[i], memoryBudgets[m] >> 20,
+                   atomic_load(&progress.generatedRuns), atomic_load(&progress.pass), nanoseconds_to_milliseconds(elapsed),
+                   mebibytes / ((double)elapsed / 1e9));
+        }
+    }
+    remove(inputPath);
+    remove(outputPath);
+    return EXIT_SUCCESS;
+}
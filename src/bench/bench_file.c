@@ -0,0 +1,69 @@
+#include "bench.h"
+#include "io/dataset.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+* Sort a binary file of keys straight from its mapping with each listed sort. Every sort gets a fresh copy on write
+* mapping so the file is left as it was, unless --in-place is given, which sorts the file itself with the first sort.
+*/
+int bench_file(int argc, char **argv)
+{
+    const char *path = bench_option(argc, argv, "--load", NULL);
+    if (path == NULL)
+    {
+        fputs("Usage: SortSimBench file --load path [--key-bits n] [--sorts radix,intro] [--in-place]\n", stderr);
+        return EXIT_FAILURE;
+    }
+    unsigned keyBits = (unsigned)strtoul(bench_option(argc, argv, "--key-bits", "0"), NULL, 10);
+    if (keyBits == 0)
+        keyBits = SORTSIM_KEY_BITS;
+    bool inPlace = false;
+    for (int i = 0; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--in-place") == 0)
+            inPlace = true;
+    }
+
+    enum SortType sorts[BENCH_MAX_LIST];
+    size_t sortCount = 0;
+    char list[256];
+    snprintf(list, sizeof(list), "%s", bench_option(argc, argv, "--sorts", "radix,intro,merge,auto"));
+    for (char *name = strtok(list, ","); name != NULL && sortCount < BENCH_MAX_LIST; name = strtok(NULL, ","))
+    {
+        sorts[sortCount] = sort_from_name(name);
+        if (sorts[sortCount] == NumSorts)
+        {
+            fprintf(stderr, "Unknown sort: %s\n", name);
+            return EXIT_FAILURE;
+        }
+        sortCount++;
+    }
+    if (inPlace)
+        sortCount = sortCount > 1 ? 1 : sortCount;
+
+    printf("%-20s %14s %12s %12s\n", "sort", "values", "map ms", "sort ms");
+    for (size_t s = 0; s < sortCount; s++)
+    {
+        struct Dataset dataset;
+        uint64_t start = monotonic_nanoseconds();
+        if (!dataset_open(&dataset, path, keyBits, inPlace ? DatasetInPlace : DatasetCopyOnWrite))
+            return EXIT_FAILURE;
+        dataset_advise(&dataset, sorts[s]);
+        uint64_t mapped = monotonic_nanoseconds();
+        struct BenchRun run;
+        sortFunctions[sorts[s]](bench_sort_args(&run, dataset.values, dataset.count));
+        uint64_t sorted = monotonic_nanoseconds();
+        if (!is_already_sorted(dataset.values, dataset.count, NULL))
+        {
+            fprintf(stderr, "%s failed to sort %s\n", sortNames[sorts[s]], path);
+            return EXIT_FAILURE;
+        }
+        printf("%-20s %14zu %12.3f %12.3f\n", sortNames[sorts[s]], dataset.count,
+               nanoseconds_to_milliseconds(mapped - start), nanoseconds_to_milliseconds(sorted - mapped));
+        bench_record("file", sortNames[sorts[s]], dataset.count, path, sorted - mapped, &run.sortStats, NULL);
+        dataset_close(&dataset);
+    }
+    return EXIT_SUCCESS;
+}
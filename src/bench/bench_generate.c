@@ -0,0 +1,54 @@
+#include "bench.h"
+#include "parallel/thread_pool.h"
+#include "sorts/distribution.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+* Nanoseconds per value to generate each distribution with each worker count. The output only depends on the
+* seed, so every worker count is also checked to produce exactly what the single threaded run did.
+*/
+int bench_generate(int argc, char **argv)
+{
+    size_t sizes[BENCH_MAX_LIST];
+    size_t sizeCount = bench_parse_sizes(bench_option(argc, argv, "--sizes", "1m,16m"), sizes, BENCH_MAX_LIST);
+    enum Distribution distributions[NumDistributions];
+    size_t distributionCount =
+        bench_parse_distributions(bench_option(argc, argv, "--dist", "all"), distributions, NumDistributions);
+    char defaultWorkers[32];
+    snprintf(defaultWorkers, sizeof(defaultWorkers), "1,%zu", hardware_thread_count());
+    size_t workers[BENCH_MAX_LIST];
+    size_t workerCount = bench_parse_sizes(bench_option(argc, argv, "--workers", defaultWorkers), workers,
+                                           BENCH_MAX_LIST);
+    const uint64_t seed = 42;
+
+    printf("%-14s %11s %8s %10s %10s\n", "distribution", "size", "workers", "ms", "ns/value");
+    for (size_t i = 0; i < sizeCount; i++)
+    {
+        size_t count = sizes[i];
+        SortValueType *reference = bench_alloc_values(count);
+        SortValueType *values = bench_alloc_values(count);
+        for (size_t d = 0; d < distributionCount; d++)
+        {
+            distribution_generate(reference, count, distributions[d], NULL, seed, 1);
+            for (size_t w = 0; w < workerCount; w++)
+            {
+                uint64_t start = monotonic_nanoseconds();
+                distribution_generate(values, count, distributions[d], NULL, seed, workers[w]);
+                uint64_t elapsed = monotonic_nanoseconds() - start;
+                if (memcmp(values, reference, count * sizeof(SortValueType)) != 0)
+                {
+                    fprintf(stderr, "%s output changed with %zu workers\n", distributionNames[distributions[d]],
+                            workers[w]);
+                    return EXIT_FAILURE;
+                }
+                printf("%-14s %11zu %8zu %10.3f %10.3f\n", distributionNames[distributions[d]], count, workers[w],
+                       nanoseconds_to_milliseconds(elapsed), (double)elapsed / (double)count);
+            }
+        }
+        free(values);
+        free(reference);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,127 @@
+#include "bench.h"
+#include "sorts/cpu_dispatch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum IsaKernel {
+    IsaSortedCheck,
+    IsaOrderScan,
+    IsaRadixHistograms,
+    IsaRadixSort,
+    NumIsaKernels,
+};
+
+static const char *const isaKernelNames[NumIsaKernels] = {"Sorted Check", "Order Scan", "Radix Histograms",
+                                                          "Radix Sort"};
+// Input each kernel is timed on. The sortedness check gets a sorted array so it reads all of it
+static const char *const isaKernelInputs[NumIsaKernels] = {"Sorted", "Shuffled", "Shuffled", "Shuffled"};
+
+// One run of kernel through the bound kernels, returns the nanoseconds it took
+static uint64_t isa_run(enum IsaKernel kernel, struct BenchRun *run, SortValueType *values,
+                        const SortValueType *input, size_t count, size_t (*histograms)[RADIX_BUCKETS])
+{
+    struct SortFunctionArgs args = bench_sort_args(run, values, count);
+    memcpy(values, input, count * sizeof(SortValueType));
+    uint64_t start = monotonic_nanoseconds();
+    struct OrderScan scan;
+    switch (kernel)
+    {
+    case IsaSortedCheck:
+        if (!is_already_sorted(values, count, &run->sortStats))
+        {
+            fputs("Sortedness check found a descent in sorted input\n", stderr);
+            exit(EXIT_FAILURE);
+        }
+        break;
+    case IsaOrderScan:
+        scan = scan_order(values, count);
+        // Every adjacent pair is a descent, equal or neither, and there are count - 1 of them
+        if (scan.descents + scan.equals >= count)
+        {
+            fputs("Order scan counted more pairs than there are\n", stderr);
+            exit(EXIT_FAILURE);
+        }
+        break;
+    case IsaRadixHistograms:
+        memset(histograms, 0, RADIX_PASSES * sizeof(*histograms));
+        sort_kernels()->radixHistograms(values, count, histograms);
+        break;
+    default:
+        radix_sort(args);
+        break;
+    }
+    uint64_t elapsed = monotonic_nanoseconds() - start;
+    if (kernel == IsaRadixSort && !is_already_sorted(values, count, NULL))
+    {
+        fprintf(stderr, "Radix sort at %s left %zu values unsorted\n", cpuLevelNames[cpu_dispatch_level()], count);
+        exit(EXIT_FAILURE);
+    }
+    return elapsed;
+}
+
+/*
+* Every dispatched kernel at every CPU level this machine runs, from scalar up to the one it detected, on the
+* same inputs. Each time is the best of --repeats runs, next to its speedup over the scalar build of the kernel.
+* The level bound before the suite, detected or forced with --isa, is bound again after it.
+*/
+int bench_isa(int argc, char **argv)
+{
+    size_t sizes[BENCH_MAX_LIST];
+    size_t sizeCount = bench_parse_sizes(bench_option(argc, argv, "--sizes", "64k,1m,16m"), sizes, BENCH_MAX_LIST);
+    int repeats = atoi(bench_option(argc, argv, "--repeats", "5"));
+    if (repeats < 1)
+        repeats = 1;
+    enum CpuLevel bound = cpu_dispatch_level();
+    enum CpuLevel detected = cpu_detected_level();
+    printf("Detected %s\n", cpuLevelNames[detected]);
+    printf("%-18s %-8s %11s %10s %10s %8s\n", "kernel", "level", "size", "ms", "ns/value", "speedup");
+    struct BenchRun run;
+    size_t(*histograms)[RADIX_BUCKETS] = malloc(RADIX_PASSES * sizeof(*histograms));
+    if (histograms == NULL)
+    {
+        fputs("Failed to allocate memory for benchmark histograms\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < sizeCount; i++)
+    {
+        size_t count = sizes[i];
+        SortValueType *shuffled = bench_alloc_values(count);
+        SortValueType *sorted = bench_alloc_values(count);
+        SortValueType *values = bench_alloc_values(count);
+        bench_fill_shuffled(shuffled, count);
+        memcpy(sorted, shuffled, count * sizeof(SortValueType));
+        cpu_dispatch_set_level(CpuLevelScalar);
+        radix_sort(bench_sort_args(&run, sorted, count));
+        for (int kernel = 0; kernel < NumIsaKernels; kernel++)
+        {
+            const SortValueType *input = kernel == IsaSortedCheck ? sorted : shuffled;
+            uint64_t scalar = 0;
+            for (int level = CpuLevelScalar; level <= (int)detected; level++)
+            {
+                cpu_dispatch_set_level((enum CpuLevel)level);
+                uint64_t best = UINT64_MAX;
+                for (int r = 0; r < repeats; r++)
+                {
+                    uint64_t elapsed = isa_run((enum IsaKernel)kernel, &run, values, input, count, histograms);
+                    if (elapsed < best)
+                        best = elapsed;
+                }
+                if (level == CpuLevelScalar)
+                    scalar = best;
+                printf("%-18s %-8s %11zu %10.3f %10.3f %7.2fx\n", isaKernelNames[kernel], cpuLevelNames[level], count,
+                       nanoseconds_to_milliseconds(best), (double)best / (double)count,
+                       best > 0 ? (double)scalar / (double)best : 0.0);
+                char algorithm[64];
+                snprintf(algorithm, sizeof(algorithm), "%s (%s)", isaKernelNames[kernel], cpuLevelNames[level]);
+                bench_record("isa", algorithm, count, isaKernelInputs[kernel], best, &run.sortStats, NULL);
+            }
+        }
+        free(values);
+        free(sorted);
+        free(shuffled);
+    }
+    free(histograms);
+    cpu_dispatch_set_level(bound);
+    return EXIT_SUCCESS;
+}
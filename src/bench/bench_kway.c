@@ -0,0 +1,162 @@
+#include "bench.h"
+#include "io/merge_files.h"
+#include "sorts/kway_merge.h"
+#include "sorts/merge_sort.h"
+#include "sorts/radix_sort.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Bounds of k sorted shards laid out one after another, shard i is [bounds[i], bounds[i + 1])
+static void shard_bounds(size_t *bounds, size_t count, size_t k)
+{
+    for (size_t i = 0; i <= k; i++)
+    {
+        bounds[i] = count * i / k;
+    }
+}
+
+// Fold the shards into the first one left to right with merge_sort_merge(), k - 1 merges of a growing prefix
+static void pairwise_sequential(struct SortFunctionArgs *args, const size_t *bounds, size_t k)
+{
+    for (size_t i = 1; i < k; i++)
+    {
+        if (bounds[i] > 0 && bounds[i + 1] > bounds[i])
+            merge_sort_merge(0, bounds[i] - 1, bounds[i + 1] - 1, args);
+    }
+}
+
+// Merge neighbouring shards with merge_sort_merge() in rounds, halving the shard count each round
+static void pairwise_balanced(struct SortFunctionArgs *args, const size_t *bounds, size_t k)
+{
+    for (size_t width = 1; width < k; width *= 2)
+    {
+        for (size_t i = 0; i + width < k; i += 2 * width)
+        {
+            size_t low = bounds[i];
+            size_t mid = bounds[i + width];
+            size_t high = bounds[i + 2 * width < k ? i + 2 * width : k];
+            if (mid > low && high > mid)
+                merge_sort_merge(low, mid - 1, high - 1, args);
+        }
+    }
+}
+
+// Merge files given with --files into --output, for merging shards that are already on disk
+static int bench_kway_files(int argc, char **argv, const char *list)
+{
+    const char *outputPath = bench_option(argc, argv, "--output", "merged.bin");
+    char *copy = malloc(strlen(list) + 1);
+    const char *paths[1024];
+    size_t k = 0;
+    if (copy == NULL)
+    {
+        fputs("Failed to allocate memory for file list\n", stderr);
+        return EXIT_FAILURE;
+    }
+    strcpy(copy, list);
+    for (char *path = strtok(copy, ","); path != NULL && k < 1024; path = strtok(NULL, ","))
+    {
+        paths[k++] = path;
+    }
+    struct BenchRun run;
+    bench_sort_args(&run, NULL, 0);
+    uint64_t start = monotonic_nanoseconds();
+    bool ok = merge_files(paths, k, outputPath, &run.sortStats);
+    uint64_t elapsed = monotonic_nanoseconds() - start;
+    free(copy);
+    if (!ok)
+        return EXIT_FAILURE;
+    printf("Merged %zu files into %s: %zu values, %zu comparisons, %.3f ms\n", k, outputPath,
+           run.sortStats.arrayWrites, run.sortStats.comparisons, nanoseconds_to_milliseconds(elapsed));
+    return EXIT_SUCCESS;
+}
+
+/*
+* Merge k sorted shards with the loser tree and with the existing two-way merge(), either folding shards in one at
+* a time or in balanced rounds. The loser tree makes about n log2(k) comparisons in one pass over the data, the
+* fold about n k / 2, and the balanced rounds match the loser tree's comparisons but copy the data log2(k) times.
+*/
+int bench_kway(int argc, char **argv)
+{
+    const char *files = bench_option(argc, argv, "--files", NULL);
+    if (files != NULL)
+        return bench_kway_files(argc, argv, files);
+    size_t sizes[BENCH_MAX_LIST];
+    size_t sizeCount = bench_parse_sizes(bench_option(argc, argv, "--sizes", "1m"), sizes, BENCH_MAX_LIST);
+    size_t ways[BENCH_MAX_LIST];
+    size_t wayCount = bench_parse_sizes(bench_option(argc, argv, "--ways", "2,4,8,16,32,64,128,256,512,1024"), ways,
+                                        BENCH_MAX_LIST);
+    // The fold is quadratic in k, past this many values times k it is skipped
+    size_t foldLimit = 0;
+    bench_parse_sizes(bench_option(argc, argv, "--fold-limit", "1g"), &foldLimit, 1);
+
+    printf("%11s %6s %-20s %10s %14s %16s\n", "size", "k", "method", "ms", "comparisons", "comparisons/n");
+    for (size_t i = 0; i < sizeCount; i++)
+    {
+        size_t count = sizes[i];
+        SortValueType *input = bench_alloc_values(count);
+        SortValueType *values = bench_alloc_values(count);
+        SortValueType *output = bench_alloc_values(count);
+        for (size_t w = 0; w < wayCount; w++)
+        {
+            size_t k = ways[w] < count ? ways[w] : count;
+            size_t *bounds = malloc((k + 1) * sizeof(size_t));
+            struct MergeSource *sources = malloc(k * sizeof(struct MergeSource));
+            if (bounds == NULL || sources == NULL)
+            {
+                fputs("Failed to allocate memory for shards\n", stderr);
+                return EXIT_FAILURE;
+            }
+            shard_bounds(bounds, count, k);
+            bench_fill_shuffled(input, count);
+            for (size_t s = 0; s < k; s++)
+            {
+                struct BenchRun run;
+                radix_sort(bench_sort_args(&run, input + bounds[s], bounds[s + 1] - bounds[s]));
+                sources[s].values = input + bounds[s];
+                sources[s].count = bounds[s + 1] - bounds[s];
+            }
+
+            const char *const methods[] = {"loser tree", "pairwise balanced", "pairwise fold"};
+            for (size_t m = 0; m < sizeof(methods) / sizeof(methods[0]); m++)
+            {
+                if (m == 2 && count / 2 * k > foldLimit)
+                    continue;
+                struct BenchRun run;
+                memcpy(values, input, count * sizeof(SortValueType));
+                struct SortFunctionArgs args = bench_sort_args(&run, values, count);
+                SortValueType *result = values;
+                uint64_t start = monotonic_nanoseconds();
+                switch (m)
+                {
+                case 0:
+                    kway_merge(sources, k, output, &run.sortStats);
+                    result = output;
+                    break;
+                case 1:
+                    pairwise_balanced(&args, bounds, k);
+                    break;
+                default:
+                    pairwise_sequential(&args, bounds, k);
+                    break;
+                }
+                uint64_t elapsed = monotonic_nanoseconds() - start;
+                if (!is_already_sorted(result, count, NULL))
+                {
+                    fprintf(stderr, "%s failed to merge %zu shards\n", methods[m], k);
+                    return EXIT_FAILURE;
+                }
+                printf("%11zu %6zu %-20s %10.3f %14zu %16.2f\n", count, k, methods[m],
+                       nanoseconds_to_milliseconds(elapsed), run.sortStats.comparisons,
+                       (double)run.sortStats.comparisons / (double)count);
+            }
+            free(sources);
+            free(bounds);
+        }
+        free(output);
+        free(values);
+        free(input);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,86 @@
+#include "bench.h"
+#include "sorts/distribution.h"
+#include "sorts/random.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Sorts that take quadratic time on most inputs, only timed up to --quadratic-limit values
+static bool is_quadratic(enum SortType sort)
+{
+    switch (sort)
+    {
+    case BubbleSort:
+    case SelectionSort:
+    case InsertionSort:
+    case CocktailShakerSort:
+    case OddEvenSort:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/*
+* Milliseconds for every sort on every input distribution, one table per size. Every sort gets a copy of the
+* same generated input, and skipped cells (bogo sort always, quadratic sorts past the limit) print as "-".
+*/
+int bench_matrix(int argc, char **argv)
+{
+    size_t sizes[BENCH_MAX_LIST];
+    size_t sizeCount = bench_parse_sizes(bench_option(argc, argv, "--sizes", "1k,64k"), sizes, BENCH_MAX_LIST);
+    enum Distribution distributions[NumDistributions];
+    size_t distributionCount =
+        bench_parse_distributions(bench_option(argc, argv, "--dist", "all"), distributions, NumDistributions);
+    size_t quadraticLimit = 0;
+    bench_parse_sizes(bench_option(argc, argv, "--quadratic-limit", "16k"), &quadraticLimit, 1);
+
+    for (size_t i = 0; i < sizeCount; i++)
+    {
+        size_t count = sizes[i];
+        SortValueType *inputs = bench_alloc_values(count * distributionCount);
+        SortValueType *values = bench_alloc_values(count);
+        for (size_t d = 0; d < distributionCount; d++)
+        {
+            distribution_generate(inputs + d * count, count, distributions[d], NULL,
+                                  random_next(random_thread_state()), 0);
+        }
+
+        printf("\n%zu values, ms\n%-20s", count, "sort");
+        for (size_t d = 0; d < distributionCount; d++)
+            printf(" %13s", distributionNames[distributions[d]]);
+        putchar('\n');
+        for (enum SortType sort = 0; sort < NumSorts; sort++)
+        {
+            printf("%-20s", sortNames[sort]);
+            for (size_t d = 0; d < distributionCount; d++)
+            {
+                if (sort == BogoSort || (is_quadratic(sort) && count > quadraticLimit))
+                {
+                    printf(" %13s", "-");
+                    continue;
+                }
+                struct BenchRun run;
+                memcpy(values, inputs + d * count, count * sizeof(SortValueType));
+                struct SortFunctionArgs args = bench_sort_args(&run, values, count);
+                uint64_t start = monotonic_nanoseconds();
+                sortFunctions[sort](args);
+                uint64_t elapsed = monotonic_nanoseconds() - start;
+                if (!is_already_sorted(values, count, NULL))
+                {
+                    fprintf(stderr, "\n%s failed to sort %zu %s values\n", sortNames[sort], count,
+                            distributionNames[distributions[d]]);
+                    return EXIT_FAILURE;
+                }
+                printf(" %13.3f", nanoseconds_to_milliseconds(elapsed));
+                bench_record("matrix", sortNames[sort], count, distributionNames[distributions[d]], elapsed,
+                             &run.sortStats, NULL);
+                fflush(stdout);
+            }
+            putchar('\n');
+        }
+        free(values);
+        free(inputs);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,82 @@
+#include "bench.h"
+#include "perf/perf_counters.h"
+#include "sorts/distribution.h"
+#include "sorts/random.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Sorts too slow to count on large inputs, the same set the matrix skips
+static bool perf_skip(enum SortType sort, size_t count, size_t quadraticLimit)
+{
+    if (sort == BogoSort)
+        return true;
+    bool quadratic = sort == BubbleSort || sort == SelectionSort || sort == InsertionSort ||
+                     sort == CocktailShakerSort || sort == OddEvenSort;
+    return quadratic && count > quadraticLimit;
+}
+
+/*
+* Hardware counters for every sort on each distribution: cycles, instructions and IPC, then L1D, LLC, branch and
+* dTLB misses per value. Columns perf can't open here, as in many VMs, print "-" and the software counters remain.
+*/
+int bench_perf(int argc, char **argv)
+{
+    size_t sizes[BENCH_MAX_LIST];
+    size_t sizeCount = bench_parse_sizes(bench_option(argc, argv, "--sizes", "1m"), sizes, BENCH_MAX_LIST);
+    enum Distribution distributions[NumDistributions];
+    size_t distributionCount =
+        bench_parse_distributions(bench_option(argc, argv, "--dist", "shuffled"), distributions, NumDistributions);
+    size_t quadraticLimit = 0;
+    bench_parse_sizes(bench_option(argc, argv, "--quadratic-limit", "16k"), &quadraticLimit, 1);
+
+    struct PerfCounters counters;
+    perf_counters_open(&counters);
+    if (!counters.hardware)
+        fputs("Hardware counters are unavailable, only software counters will be reported\n", stderr);
+    for (size_t i = 0; i < sizeCount; i++)
+    {
+        size_t count = sizes[i];
+        SortValueType *input = bench_alloc_values(count);
+        SortValueType *values = bench_alloc_values(count);
+        for (size_t d = 0; d < distributionCount; d++)
+        {
+            distribution_generate(input, count, distributions[d], NULL, random_next(random_thread_state()), 0);
+            printf("\n%s, %zu values, counts per value\n%-20s %10s", distributionNames[distributions[d]], count, "sort",
+                   "ms (cpu)");
+            for (int c = 0; c < PerfTaskClock; c++)
+                printf(" %13s", perfCounterNames[c]);
+            printf(" %6s %11s %10s\n", "IPC", perfCounterNames[PerfPageFaults], "Switches");
+            for (enum SortType sort = 0; sort < NumSorts; sort++)
+            {
+                if (perf_skip(sort, count, quadraticLimit))
+                    continue;
+                struct BenchRun run;
+                memcpy(values, input, count * sizeof(SortValueType));
+                struct SortFunctionArgs args = bench_sort_args(&run, values, count);
+                struct PerfSample sample;
+                uint64_t start = monotonic_nanoseconds();
+                perf_counters_start(&counters);
+                sortFunctions[sort](args);
+                perf_counters_stop(&counters, &sample);
+                bench_record("perf", sortNames[sort], count, distributionNames[distributions[d]],
+                             monotonic_nanoseconds() - start, &run.sortStats, &sample);
+                printf("%-20s %10.3f", sortNames[sort], nanoseconds_to_milliseconds(sample.values[PerfTaskClock]));
+                for (int c = 0; c < PerfTaskClock; c++)
+                {
+                    if (sample.available[c])
+                        printf(" %13.3f", (double)sample.values[c] / (double)count);
+                    else
+                        printf(" %13s", "-");
+                }
+                printf(" %6.2f %11llu %10llu\n", perf_sample_ipc(&sample),
+                       (unsigned long long)sample.values[PerfPageFaults],
+                       (unsigned long long)sample.values[PerfContextSwitches]);
+            }
+        }
+        free(values);
+        free(input);
+    }
+    perf_counters_close(&counters);
+    return EXIT_SUCCESS;
+}
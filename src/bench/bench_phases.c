@@ -0,0 +1,65 @@
+#include "bench.h"
+#include "sorts/odd_even_sort.h"
+#include "sorts/shear_sort.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef void (*ParallelSortFunction)(struct SortFunctionArgs args, size_t workerCount,
+                                     struct ParallelSortProfile *profile);
+
+/*
+* For each parallel sort, size and worker count: time spent doing compare-exchanges versus time spent waiting
+* at the end of phase barrier, both averaged per phase and per worker. When the barrier share approaches the
+* work share, splitting a phase across more threads stops paying off.
+*/
+int bench_phases(int argc, char **argv)
+{
+    size_t sizes[BENCH_MAX_LIST];
+    size_t sizeCount = bench_parse_sizes(bench_option(argc, argv, "--sizes", "256,1024,4096,16384"), sizes,
+                                         BENCH_MAX_LIST);
+    size_t workers[BENCH_MAX_LIST];
+    size_t workerCounts = bench_parse_sizes(bench_option(argc, argv, "--threads", "1,2,4,8"), workers,
+                                            BENCH_MAX_LIST);
+    const ParallelSortFunction sorts[] = {odd_even_sort_parallel, shear_sort_parallel};
+    const char *const names[] = {"Odd-Even Sort", "Shear Sort"};
+
+    printf("%-14s %9s %7s %8s %10s %13s %13s %8s %8s\n", "sort", "size", "threads", "phases", "wall ms",
+           "work us/phase", "wait us/phase", "wait %", "speedup");
+    for (size_t s = 0; s < sizeof(sorts) / sizeof(ParallelSortFunction); s++)
+    {
+        for (size_t i = 0; i < sizeCount; i++)
+        {
+            SortValueType *input = bench_alloc_values(sizes[i]);
+            SortValueType *values = bench_alloc_values(sizes[i]);
+            bench_fill_shuffled(input, sizes[i]);
+            uint64_t singleWorkerWall = 0;
+            for (size_t w = 0; w < workerCounts; w++)
+            {
+                for (size_t v = 0; v < sizes[i]; v++)
+                {
+                    values[v] = input[v];
+                }
+                struct BenchRun run;
+                struct ParallelSortProfile profile;
+                sorts[s](bench_sort_args(&run, values, sizes[i]), workers[w], &profile);
+                if (!is_already_sorted(values, sizes[i], NULL))
+                {
+                    fprintf(stderr, "%s failed to sort %zu values\n", names[s], sizes[i]);
+                    return EXIT_FAILURE;
+                }
+                if (w == 0)
+                    singleWorkerWall = profile.wallNanoseconds;
+                double perPhase = (double)(profile.phases * profile.workerCount);
+                double work = (double)profile.workNanoseconds / 1e3 / perPhase;
+                double wait = (double)profile.barrierNanoseconds / 1e3 / perPhase;
+                printf("%-14s %9zu %7zu %8zu %10.3f %13.3f %13.3f %7.1f%% %7.2fx\n", names[s], sizes[i],
+                       profile.workerCount, profile.phases, nanoseconds_to_milliseconds(profile.wallNanoseconds),
+                       work, wait, 100.0 * wait / (work + wait),
+                       (double)singleWorkerWall / (double)profile.wallNanoseconds);
+            }
+            free(values);
+            free(input);
+        }
+    }
+    return EXIT_SUCCESS;
+}
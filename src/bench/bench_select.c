@@ -0,0 +1,88 @@
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int compare_values(const void *a, const void *b)
+{
+    SortValueType x = *(const SortValueType *)a;
+    SortValueType y = *(const SortValueType *)b;
+    return (x > y) - (x < y);
+}
+
+static void libc_qsort(struct SortFunctionArgs args)
+{
+    qsort(args.values, args.count, sizeof(SortValueType), compare_values);
+}
+
+// Check that the first k values are the k smallest of the input
+static bool select_result_valid(SortValueType *values, const SortValueType *sortedInput, size_t k, SortValueType *scratch)
+{
+    memcpy(scratch, values, k * sizeof(SortValueType));
+    qsort(scratch, k, sizeof(SortValueType), compare_values);
+    return memcmp(scratch, sortedInput, k * sizeof(SortValueType)) == 0;
+}
+
+/*
+* Time each selection function against a full sort followed by taking the first k values, for every
+* combination of size and k. The full sorts are libc qsort plus the fastest O(n log n) sorts of the simulator.
+*/
+int bench_select(int argc, char **argv)
+{
+    size_t sizes[BENCH_MAX_LIST];
+    size_t sizeCount = bench_parse_sizes(bench_option(argc, argv, "--sizes", "64k,1m,4m"), sizes, BENCH_MAX_LIST);
+    size_t ks[BENCH_MAX_LIST];
+    size_t kCount = bench_parse_sizes(bench_option(argc, argv, "--k", "10,1k,64k"), ks, BENCH_MAX_LIST);
+    const SortFunction fullSorts[] = {libc_qsort, sortFunctions[Quicksort], sortFunctions[HeapSort]};
+    const char *const fullSortNames[] = {"qsort + prefix", "Quick Sort + prefix", "Heap Sort + prefix"};
+    const size_t totalFullSorts = sizeof(fullSorts) / sizeof(SortFunction);
+
+    printf("%-22s %9s %7s %10s %14s %9s\n", "algorithm", "size", "k", "ms", "comparisons", "vs qsort");
+    for (size_t i = 0; i < sizeCount; i++)
+    {
+        size_t count = sizes[i];
+        SortValueType *input = bench_alloc_values(count);
+        SortValueType *sortedInput = bench_alloc_values(count);
+        SortValueType *values = bench_alloc_values(count);
+        SortValueType *scratch = bench_alloc_values(count);
+        bench_fill_shuffled(input, count);
+        memcpy(sortedInput, input, count * sizeof(SortValueType));
+        qsort(sortedInput, count, sizeof(SortValueType), compare_values);
+
+        for (size_t j = 0; j < kCount; j++)
+        {
+            size_t k = ks[j];
+            if (k == 0 || k >= count)
+                continue;
+            uint64_t qsortTime = 1;
+            for (size_t a = 0; a < totalFullSorts + totalSelects; a++)
+            {
+                bool isSelect = a >= totalFullSorts;
+                const char *name = isSelect ? selectNames[a - totalFullSorts] : fullSortNames[a];
+                struct BenchRun run;
+                memcpy(values, input, count * sizeof(SortValueType));
+                struct SortFunctionArgs args = bench_sort_args(&run, values, count);
+                uint64_t start = monotonic_nanoseconds();
+                if (isSelect)
+                    selectFunctions[a - totalFullSorts](args, k);
+                else
+                    fullSorts[a](args);
+                uint64_t elapsed = monotonic_nanoseconds() - start;
+                if (!select_result_valid(values, sortedInput, k, scratch))
+                {
+                    fprintf(stderr, "%s returned the wrong %zu smallest of %zu values\n", name, k, count);
+                    return EXIT_FAILURE;
+                }
+                if (a == 0)
+                    qsortTime = elapsed;
+                printf("%-22s %9zu %7zu %10.3f %14zu %8.2fx\n", name, count, k, nanoseconds_to_milliseconds(elapsed),
+                       run.sortStats.comparisons, (double)qsortTime / (double)elapsed);
+            }
+        }
+        free(scratch);
+        free(values);
+        free(sortedInput);
+        free(input);
+    }
+    return EXIT_SUCCESS;
+}
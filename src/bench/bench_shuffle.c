@@ -0,0 +1,70 @@
+#include "bench.h"
+#include "sorts/random.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The shuffle as it was before the seeded generator, kept as the baseline
+static void libc_rand_shuffle(SortValueType *values, size_t count)
+{
+    for (size_t i = 0; i + 1 < count; i++)
+    {
+        size_t j = i + (size_t)rand() / (RAND_MAX / (count - i) + 1);
+        SortValueType t = values[j];
+        values[j] = values[i];
+        values[i] = t;
+    }
+}
+
+/*
+* Nanoseconds per element for a libc rand() shuffle, the seeded shuffle, drawing the bounded random numbers
+* alone and a memcpy of the array. Once the shuffle costs about what its random swaps cost in memory traffic,
+* the generator is no longer the bottleneck.
+*/
+int bench_shuffle(int argc, char **argv)
+{
+    size_t sizes[BENCH_MAX_LIST];
+    size_t sizeCount = bench_parse_sizes(bench_option(argc, argv, "--sizes", "64k,1m,16m,100m"), sizes,
+                                         BENCH_MAX_LIST);
+    printf("%-22s %11s %10s %10s\n", "method", "size", "ms", "ns/value");
+    for (size_t i = 0; i < sizeCount; i++)
+    {
+        size_t count = sizes[i];
+        SortValueType *values = bench_alloc_values(count);
+        SortValueType *copy = bench_alloc_values(count);
+        bench_fill_shuffled(values, count);
+        const char *const methods[] = {"libc rand() shuffle", "seeded shuffle", "bounded draws only", "memcpy"};
+        for (size_t m = 0; m < sizeof(methods) / sizeof(methods[0]); m++)
+        {
+            uint64_t sink = 0;
+            uint64_t start = monotonic_nanoseconds();
+            switch (m)
+            {
+            case 0:
+                libc_rand_shuffle(values, count);
+                break;
+            case 1:
+                shuffle(values, count, NULL);
+                break;
+            case 2: {
+                struct RandomState *random = random_thread_state();
+                for (size_t j = 0; j + 1 < count; j++)
+                {
+                    sink += random_bounded(random, count - j);
+                }
+                break;
+            }
+            default:
+                memcpy(copy, values, count * sizeof(SortValueType));
+                sink = copy[count / 2];
+                break;
+            }
+            uint64_t elapsed = monotonic_nanoseconds() - start;
+            printf("%-22s %11zu %10.3f %10.3f%s\n", methods[m], count, nanoseconds_to_milliseconds(elapsed),
+                   (double)elapsed / (double)count, sink == 1 ? " " : "");
+        }
+        free(copy);
+        free(values);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,359 @@
+#include "frame_export.h"
+#include "sorts/sorts.h"
+#include "sorts/op_ring.h"
+#include "soft_render.h"
+#include <raylib.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Font size of the line of counters drawn along the bottom of every frame
+#define FRAME_EXPORT_CAPTION_SIZE 20
+// Microseconds between looks at the ring while a streamed sort fills the next frame's share
+#define FRAME_EXPORT_POLL_MICROSECONDS 50
+
+enum FrameFormat {
+    FrameY4m,
+    FramePng,
+};
+
+// Encodes and writes one frame on a worker while the next ones are drawn
+struct FrameWriter {
+    const struct FrameExportOptions *options;
+    enum FrameFormat format;
+    // The Y4M stream, NULL for an image sequence
+    FILE *file;
+    // Y, U and V planes of the frame being converted
+    uint8_t *planes;
+    // Frame being written and its number, owned by the job until it has been waited for
+    Image image;
+    size_t frame;
+    // Render targets are read back bottom row first, the software renderer's frames are the right way up
+    bool flip;
+    bool failed;
+    struct Job job;
+};
+
+/*
+* Convert a frame of RGBA pixels to full range BT.601 Y'CbCr with chroma at a quarter resolution, which is what the
+* C420jpeg colour space of a Y4M stream holds. Chroma is taken from the average of each 2x2 block.
+*/
+static void frame_rgba_to_yuv420(const uint8_t *rgba, int width, int height, uint8_t *planes)
+{
+    uint8_t *lumaPlane = planes;
+    uint8_t *bluePlane = planes + (size_t)width * (size_t)height;
+    uint8_t *redPlane = bluePlane + (size_t)(width / 2) * (size_t)(height / 2);
+    for (int y = 0; y < height; y++)
+    {
+        const uint8_t *row = rgba + (size_t)y * (size_t)width * 4;
+        uint8_t *luma = lumaPlane + (size_t)y * (size_t)width;
+        for (int x = 0; x < width; x++)
+        {
+            int r = row[x * 4], g = row[x * 4 + 1], b = row[x * 4 + 2];
+            luma[x] = (uint8_t)((77 * r + 150 * g + 29 * b + 128) >> 8);
+        }
+    }
+    for (int y = 0; y < height / 2; y++)
+    {
+        const uint8_t *top = rgba + (size_t)(y * 2) * (size_t)width * 4;
+        const uint8_t *bottom = top + (size_t)width * 4;
+        for (int x = 0; x < width / 2; x++)
+        {
+            const uint8_t *a = top + x * 8, *c = bottom + x * 8;
+            int r = (a[0] + a[4] + c[0] + c[4] + 2) >> 2;
+            int g = (a[1] + a[5] + c[1] + c[5] + 2) >> 2;
+            int b = (a[2] + a[6] + c[2] + c[6] + 2) >> 2;
+            // Offset by 128 << 8 before shifting so the sums are never negative
+            int blue = (-43 * r - 85 * g + 128 * b + 32896) >> 8;
+            int red = (128 * r - 107 * g - 21 * b + 32896) >> 8;
+            bluePlane[(size_t)y * (size_t)(width / 2) + (size_t)x] = (uint8_t)(blue > 255 ? 255 : blue);
+            redPlane[(size_t)y * (size_t)(width / 2) + (size_t)x] = (uint8_t)(red > 255 ? 255 : red);
+        }
+    }
+}
+
+static int frame_writer_run(void *arg)
+{
+    struct FrameWriter *writer = (struct FrameWriter *)arg;
+    if (writer->flip)
+        ImageFlipVertical(&writer->image);
+    if (writer->format == FrameY4m)
+    {
+        int width = writer->options->width, height = writer->options->height;
+        size_t planeBytes = (size_t)width * (size_t)height * 3 / 2;
+        frame_rgba_to_yuv420((const uint8_t *)writer->image.data, width, height, writer->planes);
+        if (fputs("FRAME\n", writer->file) == EOF || fwrite(writer->planes, 1, planeBytes, writer->file) != planeBytes)
+            writer->failed = true;
+    }
+    else
+    {
+        char path[4096];
+        snprintf(path, sizeof(path), writer->options->path, (int)writer->frame);
+        writer->failed = !ExportImage(writer->image, path);
+    }
+    UnloadImage(writer->image);
+    return 0;
+}
+
+// Whether pattern is safe to hand snprintf with the frame number: one %d or %i conversion, with flags, a width
+// and a precision allowed, and any number of %% escapes
+static bool frame_pattern_valid(const char *pattern)
+{
+    int conversions = 0;
+    for (const char *c = pattern; *c != '\0'; c++)
+    {
+        if (*c != '%')
+            continue;
+        c++;
+        if (*c == '%')
+            continue;
+        while (*c == '0' || *c == '-' || *c == '+' || *c == ' ' || *c == '#')
+            c++;
+        while (*c >= '0' && *c <= '9')
+            c++;
+        if (*c == '.')
+        {
+            c++;
+            while (*c >= '0' && *c <= '9')
+                c++;
+        }
+        if (*c != 'd' && *c != 'i')
+            return false;
+        conversions++;
+    }
+    return conversions == 1;
+}
+
+static bool frame_writer_open(struct FrameWriter *writer, const struct FrameExportOptions *options)
+{
+    memset(writer, 0, sizeof(struct FrameWriter));
+    writer->options = options;
+    size_t length = strlen(options->path);
+    if (length > 4 && names_match(options->path + length - 4, ".y4m"))
+        writer->format = FrameY4m;
+    else if (frame_pattern_valid(options->path))
+        writer->format = FramePng;
+    else
+    {
+        fprintf(stderr, "Exported frames need a .y4m file or a pattern with one number such as frames/%%05d.png, "
+                        "not %s\n", options->path);
+        return false;
+    }
+    if (writer->format == FramePng)
+        return true;
+    writer->planes = malloc((size_t)options->width * (size_t)options->height * 3 / 2);
+    if (writer->planes == NULL)
+    {
+        fputs("Failed to allocate memory for frame export\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+    writer->file = fopen(options->path, "wb");
+    if (writer->file == NULL)
+    {
+        fprintf(stderr, "Failed to open %s for frames\n", options->path);
+        free(writer->planes);
+        return false;
+    }
+    fprintf(writer->file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg XYSCSS=420JPEG\n", options->width,
+            options->height, options->fps);
+    return true;
+}
+
+// Hand a frame to the writer once it is done with the one before, image is the writer's from here on
+static bool frame_writer_submit(struct Visualizer *visualizer, struct FrameWriter *writer, Image image, bool flip,
+                                size_t frame)
+{
+    job_queue_wait(visualizer->jobs, &writer->job);
+    if (writer->failed)
+    {
+        UnloadImage(image);
+        return false;
+    }
+    writer->image = image;
+    writer->flip = flip;
+    writer->frame = frame;
+    job_queue_submit(visualizer->jobs, &writer->job, frame_writer_run, writer);
+    return true;
+}
+
+static bool frame_writer_close(struct Visualizer *visualizer, struct FrameWriter *writer)
+{
+    job_queue_wait(visualizer->jobs, &writer->job);
+    bool written = !writer->failed;
+    if (writer->file != NULL && fclose(writer->file) != 0)
+        written = false;
+    free(writer->planes);
+    if (!written)
+        fprintf(stderr, "Failed to write frame %zu to %s\n", writer->frame, writer->options->path);
+    return written;
+}
+
+// Where frames are drawn, render targets read back a few frames later or a framebuffer on the CPU
+struct FrameSource {
+    bool software;
+    RenderTexture2D targets[FRAME_EXPORT_TARGETS];
+    struct SoftRenderer renderer;
+};
+
+static void frame_source_open(struct FrameSource *source, const struct FrameExportOptions *options)
+{
+    source->software = options->software;
+    if (source->software)
+    {
+        soft_renderer_init(&source->renderer);
+        soft_renderer_resize(&source->renderer, options->width, options->height);
+        return;
+    }
+    for (size_t t = 0; t < FRAME_EXPORT_TARGETS; t++)
+    {
+        source->targets[t] = LoadRenderTexture(options->width, options->height);
+    }
+}
+
+static void frame_source_close(struct FrameSource *source)
+{
+    if (source->software)
+    {
+        soft_renderer_free(&source->renderer);
+        return;
+    }
+    for (size_t t = 0; t < FRAME_EXPORT_TARGETS; t++)
+    {
+        UnloadRenderTexture(source->targets[t]);
+    }
+}
+
+// Frames drawn before a frame is read back, a software frame is already in memory once drawn
+static size_t frame_source_latency(const struct FrameSource *source)
+{
+    return source->software ? 0 : FRAME_EXPORT_TARGETS - 1;
+}
+
+static void frame_source_draw(struct Visualizer *visualizer, struct FrameSource *source, size_t frame)
+{
+    if (source->software)
+    {
+        visualizer_render(visualizer, &source->renderer);
+        return;
+    }
+    BeginTextureMode(source->targets[frame % FRAME_EXPORT_TARGETS]);
+    ClearBackground(BLACK);
+    visualizer_draw(visualizer);
+    // The counters trail the frame a little for a streamed sort, they are the sort's own and not the replay's
+    char caption[256];
+    snprintf(caption, sizeof(caption), "%s   %zu values   %zu comparisons   %zu swaps   %zu writes",
+             sortNames[visualizer->selectedSort], visualizer->count, visualizer->sortStats.comparisons,
+             visualizer->sortStats.swaps, visualizer->sortStats.arrayWrites);
+    DrawText(caption, 10, GetScreenHeight() - FRAME_EXPORT_CAPTION_SIZE - 12, FRAME_EXPORT_CAPTION_SIZE, RAYWHITE);
+    EndTextureMode();
+}
+
+static bool frame_source_submit(struct Visualizer *visualizer, struct FrameSource *source,
+                                struct FrameWriter *writer, size_t frame)
+{
+    if (!source->software)
+    {
+        Image image = LoadImageFromTexture(source->targets[frame % FRAME_EXPORT_TARGETS].texture);
+        return frame_writer_submit(visualizer, writer, image, true, frame);
+    }
+    // The framebuffer is drawn over by the next frame while the writer still has this one
+    size_t bytes = (size_t)source->renderer.width * (size_t)source->renderer.height * sizeof(uint32_t);
+    void *pixels = malloc(bytes);
+    if (pixels == NULL)
+    {
+        fputs("Failed to allocate memory for frame export\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+    memcpy(pixels, source->renderer.pixels, bytes);
+    Image image = {pixels, source->renderer.width, source->renderer.height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+    return frame_writer_submit(visualizer, writer, image, false, frame);
+}
+
+// Let the sort on by one frame's worth, or until it finishes
+static void frame_export_advance(struct Visualizer *visualizer, size_t opsPerFrame)
+{
+    if (!atomic_load(&visualizer->isSorting))
+        return;
+    if (visualizer->streaming)
+    {
+        // Waiting for a whole share keeps every frame the same step apart, however far the sort has run ahead
+        struct OpRing *ring = visualizer->opRing;
+        while (atomic_load(&ring->head) - atomic_load(&ring->tail) < opsPerFrame && atomic_load(&visualizer->isSorting))
+        {
+            sleep_microseconds(FRAME_EXPORT_POLL_MICROSECONDS);
+        }
+    }
+    else
+    {
+        sort_control_command(&visualizer->control, SortCommandStepPhase);
+        sort_control_wait_held(&visualizer->control, &visualizer->isSorting);
+    }
+}
+
+bool frame_export_run(struct Visualizer *visualizer, const struct FrameExportOptions *options)
+{
+    if (!options->software && (GetScreenWidth() != options->width || GetScreenHeight() != options->height))
+    {
+        fprintf(stderr, "The window couldn't be made %dx%d to draw frames in\n", options->width, options->height);
+        return false;
+    }
+    struct FrameWriter writer;
+    if (!frame_writer_open(&writer, options))
+        return false;
+    struct FrameSource source;
+    frame_source_open(&source, options);
+    size_t latency = frame_source_latency(&source);
+    uint64_t start = monotonic_nanoseconds();
+    // Nothing sleeps, frames are spaced by the accesses or phases between them instead of by time
+    visualizer->speed = 0.0f;
+    visualizer->timed = false;
+    visualizer->heatmapOverlay = false;
+    visualizer->frameOps = options->opsPerFrame;
+    visualizer->startPaused = true;
+    size_t drawn = 0;
+    bool written = true;
+    // The array as it was before the sort is the first frame
+    frame_source_draw(visualizer, &source, drawn++);
+    if (drawn > latency)
+        written = frame_source_submit(visualizer, &source, &writer, drawn - 1 - latency);
+    visualizer_start_sort(visualizer);
+    // A streamed sort is held back by the ring filling up, so it can run freely. Any other is let reach its first
+    // checkpoint before the first step, or a step sent while it is still on its way there could end at it
+    if (visualizer->streaming)
+        sort_control_command(&visualizer->control, SortCommandResume);
+    else
+        sort_control_wait_held(&visualizer->control, &visualizer->isSorting);
+    size_t holdFrames = (size_t)(options->holdSeconds * (float)options->fps + 0.5f);
+    size_t heldFrames = 0;
+    while (written && heldFrames < holdFrames)
+    {
+        frame_export_advance(visualizer, options->opsPerFrame);
+        // Frames of the finished array once the last of its accesses has been shown. A sort publishes all of them
+        // before it clears isSorting, and one still running has left a whole share in the ring
+        if (!atomic_load(&visualizer->isSorting) &&
+            (!visualizer->streaming ||
+             atomic_load(&visualizer->opRing->head) == atomic_load(&visualizer->opRing->tail)))
+            heldFrames++;
+        frame_source_draw(visualizer, &source, drawn++);
+        if (drawn > latency)
+            written = frame_source_submit(visualizer, &source, &writer, drawn - 1 - latency);
+    }
+    // Read back the frames still waiting in their targets
+    for (size_t frame = drawn > latency ? drawn - latency : 0; written && frame < drawn; frame++)
+    {
+        written = frame_source_submit(visualizer, &source, &writer, frame);
+    }
+    written = frame_writer_close(visualizer, &writer) && written;
+    frame_source_close(&source);
+    visualizer->frameOps = 0;
+    visualizer->startPaused = false;
+    if (written)
+    {
+        double seconds = (double)(monotonic_nanoseconds() - start) / 1e9;
+        printf("Exported %zu frames, %.1f seconds at %d fps, to %s in %.1f seconds\n", drawn,
+               (double)drawn / options->fps, options->fps, options->path, seconds);
+    }
+    return written;
+}
@@ -0,0 +1,41 @@
+#ifndef FRAME_EXPORT_H
+#define FRAME_EXPORT_H
+
+#include "visualizer.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+// Render targets drawn into in turn, each is read back this many frames minus one after it was drawn
+#define FRAME_EXPORT_TARGETS 3
+
+struct FrameExportOptions {
+    // A path ending in ".y4m" for one raw 4:2:0 video stream, or a printf pattern such as "frames/%05d.png" for a
+    // numbered image per frame
+    const char *path;
+    // Size of every frame, both even so the chroma planes of a Y4M stream cover it
+    int width;
+    int height;
+    // Frame rate written into the stream, and how many frames the end is held for
+    int fps;
+    // Accesses of a streamed sort replayed from one frame to the next, sorts drawn straight from the array move on
+    // by one phase a frame instead
+    size_t opsPerFrame;
+    // Seconds the sorted array is shown for after the last step
+    float holdSeconds;
+    // Draw frames with the software renderer instead of through GL, which needs no window. Frames drawn this way
+    // have no line of counters, there is no font to draw it with
+    bool software;
+};
+
+/*
+* Replay the visualizer's selected sort into offscreen render targets one frame at a time and write every frame out,
+* as fast as they can be drawn and encoded rather than at the pace of the delay slider. Frames are read back a few
+* frames after they were drawn, so the GPU has finished them by then, and are encoded and written on one of the
+* visualizer's workers while the next ones are drawn. The sort is only let on by the frame's share of accesses or a
+* phase at a time, so the same seed always makes the same video. Unless drawing in software, needs a window of the
+* frame size with a GL context, which may be hidden. The array to sort has to be generated already. Prints why and
+* returns false when a frame can't be written.
+*/
+bool frame_export_run(struct Visualizer *visualizer, const struct FrameExportOptions *options);
+
+#endif // !FRAME_EXPORT_H
@@ -0,0 +1,106 @@
+#include "async_io.h"
+#include "perf/trace.h"
+#include <stdlib.h>
+
+static int async_io_thread(void *arg)
+{
+    struct AsyncIo *io = (struct AsyncIo *)arg;
+    trace_thread_name("Async IO");
+    mtx_lock(&io->mutex);
+    for (;;)
+    {
+        while (io->head == NULL && !io->shutdown)
+        {
+            cnd_wait(&io->submitted, &io->mutex);
+        }
+        if (io->head == NULL)
+            break;
+        struct AsyncIoRequest *request = io->head;
+        io->head = request->next;
+        if (io->head == NULL)
+            io->tail = NULL;
+        mtx_unlock(&io->mutex);
+
+        if (request->kind == AsyncRead)
+        {
+            trace_begin_arg("read", "bytes", (int64_t)request->bytes);
+            request->transferred = fread(request->buffer, 1, request->bytes, request->file);
+            request->failed = ferror(request->file) != 0;
+            trace_end("read");
+        }
+        else
+        {
+            trace_begin_arg("write", "bytes", (int64_t)request->bytes);
+            request->transferred = fwrite(request->buffer, 1, request->bytes, request->file);
+            request->failed = request->transferred != request->bytes;
+            trace_end("write");
+        }
+
+        mtx_lock(&io->mutex);
+        request->pending = false;
+        cnd_broadcast(&io->completed);
+    }
+    mtx_unlock(&io->mutex);
+    return 0;
+}
+
+void async_io_init(struct AsyncIo *io)
+{
+    io->head = NULL;
+    io->tail = NULL;
+    io->shutdown = false;
+    if (mtx_init(&io->mutex, mtx_plain) != thrd_success || cnd_init(&io->submitted) != thrd_success ||
+        cnd_init(&io->completed) != thrd_success)
+    {
+        fputs("Failed to initialise I/O thread synchronisation\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+    if (thrd_create(&io->thread, async_io_thread, io) != thrd_success)
+    {
+        fputs("Error creating thread\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+}
+
+void async_io_free(struct AsyncIo *io)
+{
+    mtx_lock(&io->mutex);
+    io->shutdown = true;
+    cnd_signal(&io->submitted);
+    mtx_unlock(&io->mutex);
+    thrd_join(io->thread, NULL);
+    cnd_destroy(&io->completed);
+    cnd_destroy(&io->submitted);
+    mtx_destroy(&io->mutex);
+}
+
+void async_io_submit(struct AsyncIo *io, struct AsyncIoRequest *request, enum AsyncIoKind kind, FILE *file,
+                     void *buffer, size_t bytes)
+{
+    request->kind = kind;
+    request->file = file;
+    request->buffer = buffer;
+    request->bytes = bytes;
+    request->transferred = 0;
+    request->failed = false;
+    request->next = NULL;
+    mtx_lock(&io->mutex);
+    request->pending = true;
+    if (io->tail != NULL)
+        io->tail->next = request;
+    else
+        io->head = request;
+    io->tail = request;
+    cnd_signal(&io->submitted);
+    mtx_unlock(&io->mutex);
+}
+
+void async_io_wait(struct AsyncIo *io, struct AsyncIoRequest *request)
+{
+    mtx_lock(&io->mutex);
+    while (request->pending)
+    {
+        cnd_wait(&io->completed, &io->mutex);
+    }
+    mtx_unlock(&io->mutex);
+}
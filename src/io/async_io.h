@@ -0,0 +1,50 @@
+#ifndef ASYNC_IO_H
+#define ASYNC_IO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <threads.h>
+
+enum AsyncIoKind {
+    AsyncRead,
+    AsyncWrite,
+};
+
+// One read or write of a whole buffer, owned by the caller until async_io_wait returns
+struct AsyncIoRequest {
+    enum AsyncIoKind kind;
+    FILE *file;
+    void *buffer;
+    size_t bytes;
+    // Bytes actually transferred, fewer than asked for on a read means the end of the file was reached
+    size_t transferred;
+    bool failed;
+    bool pending;
+    struct AsyncIoRequest *next;
+};
+
+/*
+* A thread that performs reads and writes in the order they were submitted, so the caller can sort or merge one
+* buffer while the next one is being filled and the previous one written out. Requests on the same file run in
+* submission order, so a file can be streamed through several buffers without seeking.
+*/
+struct AsyncIo {
+    thrd_t thread;
+    mtx_t mutex;
+    cnd_t submitted;
+    cnd_t completed;
+    struct AsyncIoRequest *head;
+    struct AsyncIoRequest *tail;
+    bool shutdown;
+};
+
+void async_io_init(struct AsyncIo *io);
+// Finish every submitted request and stop the thread
+void async_io_free(struct AsyncIo *io);
+void async_io_submit(struct AsyncIo *io, struct AsyncIoRequest *request, enum AsyncIoKind kind, FILE *file,
+                     void *buffer, size_t bytes);
+// Block until request has been performed, returns at once for a request that was never submitted
+void async_io_wait(struct AsyncIo *io, struct AsyncIoRequest *request);
+
+#endif // !ASYNC_IO_H
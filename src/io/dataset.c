@@ -0,0 +1,194 @@
+#include "dataset.h"
+#include <stdio.h>
+#include <stdlib.h>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define DATASET_BIG_ENDIAN 1
+#else
+#define DATASET_BIG_ENDIAN 0
+#endif
+
+// Leading bytes faulted in ahead of a sort, enough to keep its first pass busy while readahead takes over. The whole
+// file would evict the page cache to fault in pages the sort won't reach for a long time
+#define DATASET_PREFETCH_BYTES ((size_t)64 << 20)
+
+// Everything up to mapping the file, shared by both platforms
+static bool dataset_check(const char *path, unsigned keyBits, unsigned long long byteCount)
+{
+    if (DATASET_BIG_ENDIAN)
+    {
+        fputs("Datasets are little-endian and can't be sorted in place on a big-endian machine\n", stderr);
+        return false;
+    }
+    if (keyBits != SORTSIM_KEY_BITS)
+    {
+        fprintf(stderr, "%s holds %u-bit keys but this build sorts %d-bit keys, reconfigure with -DSORTSIM_KEY_BITS=%u\n",
+                path, keyBits, SORTSIM_KEY_BITS, keyBits);
+        return false;
+    }
+    if (byteCount == 0 || byteCount % sizeof(SortValueType) != 0)
+    {
+        fprintf(stderr, "%s is %llu bytes, which is not a whole number of %u-bit keys\n", path, byteCount, keyBits);
+        return false;
+    }
+    if (byteCount > SIZE_MAX)
+    {
+        fprintf(stderr, "%s is too large to map in this address space\n", path);
+        return false;
+    }
+    return true;
+}
+
+#ifdef _WIN32
+
+bool dataset_open(struct Dataset *dataset, const char *path, unsigned keyBits, enum DatasetMode mode)
+{
+    HANDLE file = CreateFileA(path, mode == DatasetInPlace ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+                              FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        fprintf(stderr, "Failed to open %s\n", path);
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || !dataset_check(path, keyBits, (unsigned long long)size.QuadPart))
+    {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, NULL, mode == DatasetInPlace ? PAGE_READWRITE : PAGE_WRITECOPY, 0, 0,
+                                        NULL);
+    void *view = mapping == NULL ? NULL
+                                 : MapViewOfFile(mapping, mode == DatasetInPlace ? FILE_MAP_WRITE : FILE_MAP_COPY, 0,
+                                                 0, 0);
+    if (view == NULL)
+    {
+        fprintf(stderr, "Failed to map %s\n", path);
+        if (mapping != NULL)
+            CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    dataset->values = view;
+    dataset->byteCount = (size_t)size.QuadPart;
+    dataset->count = dataset->byteCount / sizeof(SortValueType);
+    dataset->file = file;
+    dataset->mapping = mapping;
+    return true;
+}
+
+void dataset_close(struct Dataset *dataset)
+{
+    FlushViewOfFile(dataset->values, 0);
+    UnmapViewOfFile(dataset->values);
+    CloseHandle(dataset->mapping);
+    CloseHandle(dataset->file);
+    dataset->values = NULL;
+    dataset->count = 0;
+}
+
+void dataset_advise(struct Dataset *dataset, enum SortType sort)
+{
+    // Windows has no access pattern hints for mapped files, prefetching is the closest thing
+    (void)sort;
+    size_t byteCount = dataset->byteCount < DATASET_PREFETCH_BYTES ? dataset->byteCount : DATASET_PREFETCH_BYTES;
+    WIN32_MEMORY_RANGE_ENTRY range = {dataset->values, byteCount};
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+
+#else
+
+bool dataset_open(struct Dataset *dataset, const char *path, unsigned keyBits, enum DatasetMode mode)
+{
+    int fd = open(path, mode == DatasetInPlace ? O_RDWR : O_RDONLY);
+    if (fd == -1)
+    {
+        perror(path);
+        return false;
+    }
+    struct stat status;
+    if (fstat(fd, &status) == -1 || !dataset_check(path, keyBits, (unsigned long long)status.st_size))
+    {
+        close(fd);
+        return false;
+    }
+    size_t byteCount = (size_t)status.st_size;
+    void *values = mmap(NULL, byteCount, PROT_READ | PROT_WRITE, mode == DatasetInPlace ? MAP_SHARED : MAP_PRIVATE,
+                        fd, 0);
+    if (values == MAP_FAILED)
+    {
+        perror(path);
+        close(fd);
+        return false;
+    }
+    dataset->values = values;
+    dataset->byteCount = byteCount;
+    dataset->count = byteCount / sizeof(SortValueType);
+    dataset->fd = fd;
+    return true;
+}
+
+void dataset_close(struct Dataset *dataset)
+{
+    munmap(dataset->values, dataset->byteCount);
+    close(dataset->fd);
+    dataset->values = NULL;
+    dataset->count = 0;
+}
+
+void dataset_advise(struct Dataset *dataset, enum SortType sort)
+{
+    int advice;
+    switch (sort)
+    {
+    // Scans from one end to the other, readahead pays off and pages behind the scan can go
+    case BubbleSort:
+    case SelectionSort:
+    case InsertionSort:
+    case CocktailShakerSort:
+    case MergeSort:
+    case OddEvenSort:
+    case CountingSort:
+    case RadixSort:
+    case NaturalMergeSort:
+    case KWayMergeSort:
+        advice = MADV_SEQUENTIAL;
+        break;
+    // Jumps around the whole array, readahead only pulls in pages that won't be touched
+    case HeapSort:
+    case BogoSort:
+    case ShearSort:
+        advice = MADV_RANDOM;
+        break;
+    // Partitions and gapped passes are sequential within shrinking ranges, the default readahead suits them
+    default:
+        advice = MADV_NORMAL;
+        break;
+    }
+    madvise(dataset->values, dataset->byteCount, advice);
+    // Every sort starts at the front, fault that much in now
+    size_t byteCount = dataset->byteCount < DATASET_PREFETCH_BYTES ? dataset->byteCount : DATASET_PREFETCH_BYTES;
+    madvise(dataset->values, byteCount, MADV_WILLNEED);
+}
+
+#endif
+
+SortValueType dataset_maximum(struct Dataset *dataset)
+{
+    SortValueType maximum = 0;
+    for (size_t i = 0; i < dataset->count; i++)
+    {
+        if (dataset->values[i] > maximum)
+            maximum = dataset->values[i];
+    }
+    return maximum;
+}
@@ -0,0 +1,41 @@
+#ifndef DATASET_H
+#define DATASET_H
+
+#include "sorts/sort_types.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+enum DatasetMode {
+    // Writes go straight to the file, sorting it in place
+    DatasetInPlace,
+    // Writes stay private to the process, the file is left untouched
+    DatasetCopyOnWrite,
+};
+
+// A raw little-endian file of keys mapped into memory, values can be passed to any sort function directly
+struct Dataset {
+    SortValueType *values;
+    size_t count;
+    size_t byteCount;
+#ifdef _WIN32
+    void *file;
+    void *mapping;
+#else
+    int fd;
+#endif
+};
+
+/*
+* Map the file at path holding keys of keyBits bits. The key width must match SortValueType, since the values are
+* sorted where they lie rather than converted into a copy. Prints why and returns false when the file can't be used.
+*/
+bool dataset_open(struct Dataset *dataset, const char *path, unsigned keyBits, enum DatasetMode mode);
+// Unmap the file and close it, in place writes stay in the file
+void dataset_close(struct Dataset *dataset);
+// Tell the kernel how the sort about to run walks the array so readahead and page reclaim suit it. Only the mapped
+// array is paged, merge, natural merge, k-way merge and radix sort allocate scratch as large as it in memory
+void dataset_advise(struct Dataset *dataset, enum SortType sort);
+// Largest key in the file, read in one sequential pass
+SortValueType dataset_maximum(struct Dataset *dataset);
+
+#endif // !DATASET_H
@@ -0,0 +1,440 @@
+#include "external_sort.h"
+#include "async_io.h"
+#include "perf/trace.h"
+#include "sorts/loser_tree.h"
+#include "sorts/radix_sort.h"
+#include "sorts/random.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Smallest read buffer per run while merging, below it the disk spends its time seeking between runs
+#define EXTERNAL_SORT_MIN_BUFFER ((size_t)1 << 20)
+
+// Paths of sorted runs on disk
+struct RunList {
+    char **paths;
+    size_t count;
+    size_t capacity;
+};
+
+struct ExternalSort {
+    const struct ExternalSortOptions *options;
+    struct SortStats *sortStats;
+    _Atomic bool *cancelSort;
+    struct ExternalSortProgress *progress;
+    // Reads and writes have a thread each, so a run is written out while the next chunk is read in
+    struct AsyncIo reads;
+    struct AsyncIo writes;
+    // Random part of every run name, so sorts sharing a temp directory don't collide
+    unsigned long long tag;
+    size_t runsCreated;
+};
+
+// A run being merged, read through two buffers so one fills while the other is consumed
+struct RunReader {
+    FILE *file;
+    SortValueType *buffers[2];
+    struct AsyncIoRequest requests[2];
+    size_t current;
+    size_t position;
+    size_t available;
+    bool failed;
+};
+
+static bool file_size(FILE *file, uint64_t *size)
+{
+#ifdef _WIN32
+    if (_fseeki64(file, 0, SEEK_END) != 0)
+        return false;
+    long long end = _ftelli64(file);
+    if (end < 0 || _fseeki64(file, 0, SEEK_SET) != 0)
+        return false;
+#else
+    if (fseeko(file, 0, SEEK_END) != 0)
+        return false;
+    off_t end = ftello(file);
+    if (end < 0 || fseeko(file, 0, SEEK_SET) != 0)
+        return false;
+#endif
+    *size = (uint64_t)end;
+    return true;
+}
+
+static void *external_sort_alloc(size_t bytes)
+{
+    void *memory = malloc(bytes);
+    if (memory == NULL)
+    {
+        fputs("Failed to allocate memory for external sort\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+    return memory;
+}
+
+// Name a new run in the temp directory and add it to runs
+static const char *run_list_push(struct ExternalSort *sort, struct RunList *runs)
+{
+    if (runs->count == runs->capacity)
+    {
+        runs->capacity = runs->capacity ? runs->capacity * 2 : 16;
+        runs->paths = realloc(runs->paths, runs->capacity * sizeof(char *));
+        if (runs->paths == NULL)
+        {
+            fputs("Failed to allocate memory for external sort\n", stderr);
+            exit(EXIT_FAILURE);
+        }
+    }
+    const char *directory = sort->options->tempDirectory ? sort->options->tempDirectory : ".";
+    int length = snprintf(NULL, 0, "%s/sortsim-%016llx-%zu.run", directory, sort->tag, sort->runsCreated);
+    char *path = external_sort_alloc((size_t)length + 1);
+    snprintf(path, (size_t)length + 1, "%s/sortsim-%016llx-%zu.run", directory, sort->tag, sort->runsCreated++);
+    runs->paths[runs->count++] = path;
+    return path;
+}
+
+// Delete every run file and forget them
+static void run_list_clear(struct RunList *runs)
+{
+    for (size_t i = 0; i < runs->count; i++)
+    {
+        remove(runs->paths[i]);
+        free(runs->paths[i]);
+    }
+    free(runs->paths);
+    runs->paths = NULL;
+    runs->count = 0;
+    runs->capacity = 0;
+}
+
+static bool external_sort_cancelled(struct ExternalSort *sort)
+{
+    if (atomic_load(sort->cancelSort))
+    {
+        fputs("External sort cancelled\n", stderr);
+        return true;
+    }
+    return false;
+}
+
+/*
+* Split the input into chunks of a quarter of the memory budget. Three chunk buffers rotate so the next chunk is
+* read and the previous run written while the current chunk is sorted, the last quarter is the scratch of radix
+* sort. Every run is radix sorted rather than auto sorted, its scratch is one chunk whatever the keys, where the
+* run table of natural merge sort or the counting table could take several.
+*/
+static bool generate_runs(struct ExternalSort *sort, FILE *input, uint64_t totalBytes, struct RunList *runs)
+{
+    size_t chunkValues = sort->options->memoryBudget / 4 / sizeof(SortValueType);
+    if (chunkValues == 0)
+        chunkValues = 1;
+    const size_t chunkBytes = chunkValues * sizeof(SortValueType);
+    SortValueType *buffers[3];
+    for (size_t i = 0; i < 3; i++)
+    {
+        buffers[i] = external_sort_alloc(chunkBytes);
+    }
+    struct AsyncIoRequest reads[3];
+    struct AsyncIoRequest writes[3];
+    memset(reads, 0, sizeof(reads));
+    memset(writes, 0, sizeof(writes));
+    FILE *files[3] = {NULL, NULL, NULL};
+    atomic_store(&sort->progress->phase, ExternalSortRunGeneration);
+    atomic_store(&sort->progress->bytesTotal, totalBytes);
+    atomic_store(&sort->progress->bytesDone, 0);
+
+    bool ok = true;
+    float speed = 0.0f;
+    async_io_submit(&sort->reads, &reads[0], AsyncRead, input, buffers[0], chunkBytes);
+    for (size_t i = 0; ok; i++)
+    {
+        size_t current = i % 3;
+        size_t next = (i + 1) % 3;
+        async_io_wait(&sort->reads, &reads[current]);
+        size_t count = reads[current].transferred / sizeof(SortValueType);
+        if (reads[current].failed)
+        {
+            fputs("Failed to read external sort input\n", stderr);
+            ok = false;
+            break;
+        }
+        if (count == 0)
+            break;
+        // The next buffer last held the run from two chunks ago, its write has to land before it is refilled
+        async_io_wait(&sort->writes, &writes[next]);
+        if (files[next] != NULL)
+        {
+            ok = !writes[next].failed && fclose(files[next]) == 0;
+            files[next] = NULL;
+            if (!ok)
+            {
+                fputs("Failed to write a sorted run\n", stderr);
+                break;
+            }
+        }
+        bool more = count == chunkValues;
+        if (more)
+            async_io_submit(&sort->reads, &reads[next], AsyncRead, input, buffers[next], chunkBytes);
+
+        struct SortFunctionArgs args = {sort->sortStats, buffers[current], count, sort->cancelSort, &speed, NULL};
+        trace_begin_arg("sort run", "values", (int64_t)count);
+        radix_sort(args);
+        trace_end("sort run");
+        if (external_sort_cancelled(sort))
+        {
+            // Let the read just submitted finish before its buffer is freed
+            if (more)
+                async_io_wait(&sort->reads, &reads[next]);
+            ok = false;
+            break;
+        }
+
+        const char *path = run_list_push(sort, runs);
+        files[current] = fopen(path, "wb");
+        if (files[current] == NULL)
+        {
+            perror(path);
+            if (more)
+                async_io_wait(&sort->reads, &reads[next]);
+            ok = false;
+            break;
+        }
+        async_io_submit(&sort->writes, &writes[current], AsyncWrite, files[current], buffers[current],
+                        count * sizeof(SortValueType));
+        atomic_store(&sort->progress->runs, runs->count);
+        atomic_store(&sort->progress->generatedRuns, runs->count);
+        atomic_fetch_add(&sort->progress->bytesDone, (uint64_t)(count * sizeof(SortValueType)));
+        if (!more)
+            break;
+    }
+    for (size_t i = 0; i < 3; i++)
+    {
+        async_io_wait(&sort->writes, &writes[i]);
+        if (files[i] != NULL)
+        {
+            if (writes[i].failed || fclose(files[i]) != 0)
+            {
+                fputs("Failed to write a sorted run\n", stderr);
+                ok = false;
+            }
+        }
+        free(buffers[i]);
+    }
+    return ok;
+}
+
+static bool run_reader_open(struct ExternalSort *sort, struct RunReader *reader, const char *path,
+                            SortValueType *memory, size_t bufferValues)
+{
+    memset(reader, 0, sizeof(*reader));
+    reader->file = fopen(path, "rb");
+    if (reader->file == NULL)
+    {
+        perror(path);
+        return false;
+    }
+    reader->buffers[0] = memory;
+    reader->buffers[1] = memory + bufferValues;
+    const size_t bufferBytes = bufferValues * sizeof(SortValueType);
+    async_io_submit(&sort->reads, &reader->requests[0], AsyncRead, reader->file, reader->buffers[0], bufferBytes);
+    async_io_submit(&sort->reads, &reader->requests[1], AsyncRead, reader->file, reader->buffers[1], bufferBytes);
+    async_io_wait(&sort->reads, &reader->requests[0]);
+    reader->available = reader->requests[0].transferred / sizeof(SortValueType);
+    return !reader->requests[0].failed;
+}
+
+// Move past the current key, swapping buffers when it was the last one. Returns false once the run is exhausted
+static bool run_reader_advance(struct ExternalSort *sort, struct RunReader *reader, size_t bufferValues)
+{
+    if (++reader->position < reader->available)
+        return true;
+    // A short read means the end of the file was reached, the other buffer's read came back empty
+    if (reader->available < bufferValues)
+        return false;
+    size_t drained = reader->current;
+    reader->current ^= 1;
+    async_io_wait(&sort->reads, &reader->requests[reader->current]);
+    async_io_submit(&sort->reads, &reader->requests[drained], AsyncRead, reader->file, reader->buffers[drained],
+                    bufferValues * sizeof(SortValueType));
+    reader->position = 0;
+    reader->available = reader->requests[reader->current].transferred / sizeof(SortValueType);
+    reader->failed = reader->requests[reader->current].failed;
+    return reader->available > 0 && !reader->failed;
+}
+
+static void run_reader_close(struct ExternalSort *sort, struct RunReader *reader)
+{
+    if (reader->file == NULL)
+        return;
+    async_io_wait(&sort->reads, &reader->requests[0]);
+    async_io_wait(&sort->reads, &reader->requests[1]);
+    fclose(reader->file);
+    reader->file = NULL;
+}
+
+// Merge k runs into outputPath through a loser tree, the output is double buffered like the runs
+static bool merge_runs(struct ExternalSort *sort, char **paths, size_t k, const char *outputPath)
+{
+    size_t bufferValues = sort->options->memoryBudget / ((2 * k + 2) * sizeof(SortValueType));
+    if (bufferValues < 1024)
+        bufferValues = 1024;
+    const size_t bufferBytes = bufferValues * sizeof(SortValueType);
+    SortValueType *memory = external_sort_alloc((2 * k + 2) * bufferBytes);
+    struct RunReader *readers = external_sort_alloc((k > 0 ? k : 1) * sizeof(struct RunReader));
+    struct LoserTree tree;
+    loser_tree_init(&tree, k, sort->sortStats);
+    trace_begin_arg("merge runs", "runs", (int64_t)k);
+
+    bool ok = true;
+    for (size_t i = 0; i < k; i++)
+    {
+        readers[i].file = NULL;
+    }
+    for (size_t i = 0; i < k && ok; i++)
+    {
+        ok = run_reader_open(sort, &readers[i], paths[i], memory + 2 * i * bufferValues, bufferValues);
+        tree.exhausted[i] = !ok || readers[i].available == 0;
+        if (!tree.exhausted[i])
+            tree.keys[i] = readers[i].buffers[0][0];
+    }
+    loser_tree_build(&tree);
+
+    FILE *output = ok ? fopen(outputPath, "wb") : NULL;
+    if (ok && output == NULL)
+    {
+        perror(outputPath);
+        ok = false;
+    }
+    SortValueType *outputs[2] = {memory + 2 * k * bufferValues, memory + (2 * k + 1) * bufferValues};
+    struct AsyncIoRequest writes[2];
+    memset(writes, 0, sizeof(writes));
+    size_t current = 0;
+    size_t fill = 0;
+    while (ok && !loser_tree_empty(&tree))
+    {
+        size_t winner = loser_tree_winner(&tree);
+        outputs[current][fill++] = tree.keys[winner];
+        struct RunReader *reader = &readers[winner];
+        if (run_reader_advance(sort, reader, bufferValues))
+            tree.keys[winner] = reader->buffers[reader->current][reader->position];
+        else
+            tree.exhausted[winner] = true;
+        loser_tree_replay(&tree, winner);
+        if (fill == bufferValues)
+        {
+            async_io_submit(&sort->writes, &writes[current], AsyncWrite, output, outputs[current], bufferBytes);
+            current ^= 1;
+            async_io_wait(&sort->writes, &writes[current]);
+            atomic_fetch_add(&sort->progress->bytesDone, (uint64_t)bufferBytes);
+            fill = 0;
+            if (writes[current].failed)
+            {
+                fprintf(stderr, "Failed to write %s\n", outputPath);
+                ok = false;
+            }
+            else if (external_sort_cancelled(sort))
+            {
+                ok = false;
+            }
+        }
+    }
+    if (ok && fill > 0)
+    {
+        async_io_submit(&sort->writes, &writes[current], AsyncWrite, output, outputs[current],
+                        fill * sizeof(SortValueType));
+        atomic_fetch_add(&sort->progress->bytesDone, (uint64_t)(fill * sizeof(SortValueType)));
+    }
+    async_io_wait(&sort->writes, &writes[0]);
+    async_io_wait(&sort->writes, &writes[1]);
+    if (output != NULL && (writes[0].failed || writes[1].failed || fclose(output) != 0) && ok)
+    {
+        fprintf(stderr, "Failed to write %s\n", outputPath);
+        ok = false;
+    }
+    for (size_t i = 0; i < k; i++)
+    {
+        if (readers[i].failed && ok)
+        {
+            fprintf(stderr, "Failed to read %s\n", paths[i]);
+            ok = false;
+        }
+        run_reader_close(sort, &readers[i]);
+    }
+    trace_end("merge runs");
+    loser_tree_free(&tree);
+    free(readers);
+    free(memory);
+    return ok;
+}
+
+bool external_sort(const struct ExternalSortOptions *options, struct SortStats *sortStats, _Atomic bool *cancelSort,
+                   struct ExternalSortProgress *progress)
+{
+    struct ExternalSortProgress unused;
+    struct ExternalSort sort = {options, sortStats, cancelSort, progress ? progress : &unused, {0}, {0}, 0, 0};
+    sort.tag = (unsigned long long)random_next(random_thread_state());
+    atomic_store(&sort.progress->pass, 0);
+    atomic_store(&sort.progress->runs, 0);
+    atomic_store(&sort.progress->generatedRuns, 0);
+
+    FILE *input = fopen(options->inputPath, "rb");
+    if (input == NULL)
+    {
+        perror(options->inputPath);
+        atomic_store(&sort.progress->phase, ExternalSortFailed);
+        return false;
+    }
+    uint64_t totalBytes;
+    if (!file_size(input, &totalBytes) || totalBytes % sizeof(SortValueType) != 0)
+    {
+        fprintf(stderr, "%s is not a whole number of %d-bit keys\n", options->inputPath, SORTSIM_KEY_BITS);
+        fclose(input);
+        atomic_store(&sort.progress->phase, ExternalSortFailed);
+        return false;
+    }
+
+    async_io_init(&sort.reads);
+    async_io_init(&sort.writes);
+    struct RunList runs = {NULL, 0, 0};
+    bool ok = generate_runs(&sort, input, totalBytes, &runs);
+    // The output may replace the input, which is only safe now that every chunk is in a run
+    fclose(input);
+
+    // Each run merged needs two buffers of at least EXTERNAL_SORT_MIN_BUFFER, plus two for the output
+    size_t fanIn = options->memoryBudget / (2 * EXTERNAL_SORT_MIN_BUFFER);
+    fanIn = fanIn > 3 ? fanIn - 1 : 2;
+    if (fanIn > EXTERNAL_SORT_MAX_FAN_IN)
+        fanIn = EXTERNAL_SORT_MAX_FAN_IN;
+    atomic_store(&sort.progress->phase, ExternalSortMerging);
+    for (size_t pass = 1; ok; pass++)
+    {
+        atomic_store(&sort.progress->pass, pass);
+        atomic_store(&sort.progress->runs, runs.count);
+        atomic_store(&sort.progress->bytesTotal, totalBytes);
+        atomic_store(&sort.progress->bytesDone, 0);
+        if (runs.count <= fanIn)
+        {
+            ok = merge_runs(&sort, runs.paths, runs.count, options->outputPath);
+            break;
+        }
+        // Too many runs to merge at once, merge groups of them into longer runs and go again
+        struct RunList merged = {NULL, 0, 0};
+        for (size_t group = 0; group < runs.count && ok; group += fanIn)
+        {
+            size_t k = runs.count - group < fanIn ? runs.count - group : fanIn;
+            const char *path = run_list_push(&sort, &merged);
+            ok = merge_runs(&sort, runs.paths + group, k, path);
+            for (size_t i = group; i < group + k; i++)
+            {
+                remove(runs.paths[i]);
+            }
+        }
+        run_list_clear(&runs);
+        runs = merged;
+    }
+    run_list_clear(&runs);
+    async_io_free(&sort.reads);
+    async_io_free(&sort.writes);
+    atomic_store(&sort.progress->phase, ok ? ExternalSortDone : ExternalSortFailed);
+    return ok;
+}
@@ -0,0 +1,55 @@
+#ifndef EXTERNAL_SORT_H
+#define EXTERNAL_SORT_H
+
+#include "sorts/sort_types.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Files with more runs than this are merged in several passes
+#define EXTERNAL_SORT_MAX_FAN_IN 1024
+
+enum ExternalSortPhase {
+    ExternalSortIdle,
+    ExternalSortRunGeneration,
+    ExternalSortMerging,
+    ExternalSortDone,
+    ExternalSortFailed,
+};
+
+// Written by the sorting thread and read by whoever shows progress, such as the visualizer
+struct ExternalSortProgress {
+    _Atomic int phase;
+    // Bytes the current phase or merge pass has to get through and how many it has so far
+    _Atomic uint64_t bytesTotal;
+    _Atomic uint64_t bytesDone;
+    // Runs written during run generation, runs being merged afterwards
+    _Atomic size_t runs;
+    // Runs the input was split into
+    _Atomic size_t generatedRuns;
+    // Merge pass, counting from 1
+    _Atomic size_t pass;
+};
+
+struct ExternalSortOptions {
+    // Raw little-endian keys as wide as SortValueType
+    const char *inputPath;
+    // Where the sorted keys are written, may be the input path once all runs are written
+    const char *outputPath;
+    // Directory the sorted runs are written to, NULL for the current directory
+    const char *tempDirectory;
+    // Bytes of buffers and sort scratch to use, a quarter of it is the size of every sorted run
+    size_t memoryBudget;
+};
+
+/*
+* Sort a file that doesn't have to fit in memory. Chunks of the input are radix sorted and written out as runs
+* while the next chunk is read and the previous one written, then the runs are merged through a loser tree with
+* double buffered reads and writes. Prints why and returns false on failure or when cancelled, temporary runs
+* are removed either way. progress may be NULL.
+*/
+bool external_sort(const struct ExternalSortOptions *options, struct SortStats *sortStats, _Atomic bool *cancelSort,
+                   struct ExternalSortProgress *progress);
+
+#endif // !EXTERNAL_SORT_H
@@ -0,0 +1,74 @@
+#include "merge_files.h"
+#include "dataset.h"
+#include "sorts/kway_merge.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define MERGE_FILES_BLOCK ((size_t)1 << 20)
+
+bool merge_files(const char *const *paths, size_t k, const char *outputPath, struct SortStats *sortStats)
+{
+    struct Dataset *datasets = malloc((k > 0 ? k : 1) * sizeof(struct Dataset));
+    struct MergeSource *sources = malloc((k > 0 ? k : 1) * sizeof(struct MergeSource));
+    SortValueType *block = malloc(MERGE_FILES_BLOCK * sizeof(SortValueType));
+    if (datasets == NULL || sources == NULL || block == NULL)
+    {
+        fputs("Failed to allocate memory for merging files\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+    size_t opened = 0;
+    bool ok = true;
+    for (; opened < k && ok; opened++)
+    {
+        ok = dataset_open(&datasets[opened], paths[opened], SORTSIM_KEY_BITS, DatasetCopyOnWrite);
+        if (!ok)
+            break;
+        // Every input is read front to back exactly once
+        dataset_advise(&datasets[opened], MergeSort);
+        sources[opened].values = datasets[opened].values;
+        sources[opened].count = datasets[opened].count;
+    }
+    FILE *output = ok ? fopen(outputPath, "wb") : NULL;
+    if (ok && output == NULL)
+    {
+        perror(outputPath);
+        ok = false;
+    }
+    if (ok)
+    {
+        struct KWayMerger merger;
+        kway_merger_init(&merger, sources, k, sortStats);
+        size_t fill = 0;
+        while (ok && kway_merger_next(&merger, &block[fill]))
+        {
+            if (++fill == MERGE_FILES_BLOCK)
+            {
+                ok = fwrite(block, sizeof(SortValueType), fill, output) == fill;
+                fill = 0;
+            }
+        }
+        if (ok && fill > 0)
+            ok = fwrite(block, sizeof(SortValueType), fill, output) == fill;
+        if (sortStats)
+        {
+            for (size_t i = 0; i < k; i++)
+            {
+                sortStats->arrayWrites += merger.positions[i];
+            }
+        }
+        kway_merger_free(&merger);
+        if (fclose(output) != 0 || !ok)
+        {
+            fprintf(stderr, "Failed to write %s\n", outputPath);
+            ok = false;
+        }
+    }
+    for (size_t i = 0; i < opened; i++)
+    {
+        dataset_close(&datasets[i]);
+    }
+    free(block);
+    free(sources);
+    free(datasets);
+    return ok;
+}
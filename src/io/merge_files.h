@@ -0,0 +1,12 @@
+#ifndef MERGE_FILES_H
+#define MERGE_FILES_H
+
+#include "sorts/sort_types.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+// Merge k sorted key files into outputPath. The inputs are mapped and merged through a KWayMerger, the output is
+// written in large blocks. Prints why and returns false on failure
+bool merge_files(const char *const *paths, size_t k, const char *outputPath, struct SortStats *sortStats);
+
+#endif // !MERGE_FILES_H
@@ -0,0 +1,267 @@
+#include "results.h"
+#include "build_info.h"
+#include "parallel/thread_pool.h"
+#include "perf/perf_counters.h"
+#include "sorts/sorts.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#endif
+#if !defined(_WIN32)
+#include <sys/utsname.h>
+#endif
+
+// Column names of the counters, in enum PerfCounter order
+static const char *const perfColumns[] = {"cycles",        "instructions", "l1d_misses",
+                                          "llc_misses",    "branch_misses", "dtlb_misses",
+                                          "task_clock_ns", "page_faults",  "context_switches"};
+
+// The CPU's brand string, from cpuid on x86 and /proc/cpuinfo elsewhere
+static void cpu_model(char *model, size_t size)
+{
+    snprintf(model, size, "unknown");
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int registers[4];
+    __cpuid(registers, (int)0x80000000);
+    if ((unsigned)registers[0] >= 0x80000004u)
+    {
+        char brand[49] = {0};
+        for (int leaf = 0; leaf < 3; leaf++)
+        {
+            __cpuid(registers, (int)(0x80000002u + (unsigned)leaf));
+            memcpy(brand + leaf * 16, registers, 16);
+        }
+        snprintf(model, size, "%s", brand);
+    }
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    unsigned registers[4];
+    if (__get_cpuid(0x80000000u, &registers[0], &registers[1], &registers[2], &registers[3]) &&
+        registers[0] >= 0x80000004u)
+    {
+        char brand[49] = {0};
+        for (unsigned leaf = 0; leaf < 3; leaf++)
+        {
+            __get_cpuid(0x80000002u + leaf, &registers[0], &registers[1], &registers[2], &registers[3]);
+            memcpy(brand + leaf * 16, registers, 16);
+        }
+        snprintf(model, size, "%s", brand);
+    }
+#elif defined(__linux__)
+    FILE *cpuinfo = fopen("/proc/cpuinfo", "r");
+    if (cpuinfo == NULL)
+        return;
+    char line[256];
+    while (fgets(line, sizeof(line), cpuinfo) != NULL)
+    {
+        char *colon = strchr(line, ':');
+        if (colon != NULL && (strncmp(line, "model name", 10) == 0 || strncmp(line, "Model", 5) == 0))
+        {
+            snprintf(model, size, "%s", colon + 1);
+            break;
+        }
+    }
+    fclose(cpuinfo);
+#endif
+    // Brand strings are padded with spaces on either side
+    size_t start = strspn(model, " \t");
+    memmove(model, model + start, strlen(model + start) + 1);
+    size_t length = strlen(model);
+    while (length > 0 && (model[length - 1] == ' ' || model[length - 1] == '\n'))
+    {
+        model[--length] = '\0';
+    }
+}
+
+static void operating_system(char *name, size_t size)
+{
+#if defined(_WIN32)
+    snprintf(name, size, "Windows");
+#else
+    struct utsname system;
+    if (uname(&system) == 0)
+        snprintf(name, size, "%s %s %s", system.sysname, system.release, system.machine);
+    else
+        snprintf(name, size, "unknown");
+#endif
+}
+
+static void json_string(FILE *file, const char *text)
+{
+    fputc('"', file);
+    for (; *text != '\0'; text++)
+    {
+        unsigned char c = (unsigned char)*text;
+        if (c == '"' || c == '\\')
+            fprintf(file, "\\%c", c);
+        else if (c < 0x20)
+            fprintf(file, "\\u%04x", c);
+        else
+            fputc(c, file);
+    }
+    fputc('"', file);
+}
+
+// Quote a field only when it holds a separator, quote or line break, doubling any quotes inside
+static void csv_string(FILE *file, const char *text)
+{
+    if (strpbrk(text, ",\"\r\n") == NULL)
+    {
+        fputs(text, file);
+        return;
+    }
+    fputc('"', file);
+    for (; *text != '\0'; text++)
+    {
+        if (*text == '"')
+            fputc('"', file);
+        fputc(*text, file);
+    }
+    fputc('"', file);
+}
+
+static bool results_write_manifest(const struct ResultsLog *log, const char *path, const char *program)
+{
+    char manifestPath[4096];
+    snprintf(manifestPath, sizeof(manifestPath), "%s.manifest.jsonl", path);
+    FILE *manifest = fopen(manifestPath, "a");
+    if (manifest == NULL)
+    {
+        perror(manifestPath);
+        return false;
+    }
+    char model[128];
+    char system[256];
+    char started[32];
+    time_t now = time(NULL);
+    cpu_model(model, sizeof(model));
+    operating_system(system, sizeof(system));
+    strftime(started, sizeof(started), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+    fputs("{\"session\":", manifest);
+    json_string(manifest, log->session);
+    fputs(",\"program\":", manifest);
+    json_string(manifest, program);
+    fputs(",\"started\":", manifest);
+    json_string(manifest, started);
+    fputs(",\"compiler\":", manifest);
+    json_string(manifest, SORTSIM_C_COMPILER);
+    fputs(",\"build_type\":", manifest);
+    json_string(manifest, SORTSIM_BUILD_TYPE);
+    fputs(",\"c_flags\":", manifest);
+    json_string(manifest, SORTSIM_C_FLAGS);
+    fputs(",\"optimization\":", manifest);
+    json_string(manifest, SORTSIM_OPTIMIZATION);
+    fprintf(manifest, ",\"key_bits\":%d,\"cpu_model\":", SORTSIM_KEY_BITS);
+    json_string(manifest, model);
+    // Kernels bound when the log was opened, the detected level or the one forced with --isa
+    fputs(",\"isa\":", manifest);
+    json_string(manifest, cpuLevelNames[cpu_dispatch_level()]);
+    fprintf(manifest, ",\"logical_cpus\":%zu,\"os\":", hardware_thread_count());
+    json_string(manifest, system);
+    fputs("}\n", manifest);
+    if (fclose(manifest) != 0)
+    {
+        perror(manifestPath);
+        return false;
+    }
+    return true;
+}
+
+bool results_open(struct ResultsLog *log, const char *path, const char *program)
+{
+    size_t length = strlen(path);
+    log->format = length >= 4 && strcmp(path + length - 4, ".csv") == 0 ? ResultsCsv : ResultsJsonLines;
+    // Start time plus the low bits of the monotonic clock, unique enough to tell sessions sharing a file apart
+    snprintf(log->session, sizeof(log->session), "%llx-%04x", (unsigned long long)time(NULL),
+             (unsigned)(monotonic_nanoseconds() & 0xffff));
+    log->file = fopen(path, "a");
+    if (log->file == NULL)
+    {
+        perror(path);
+        return false;
+    }
+    if (!results_write_manifest(log, path, program))
+    {
+        fclose(log->file);
+        log->file = NULL;
+        return false;
+    }
+    // A new CSV file starts with its header, appending to an existing one continues under the header it has
+    fseek(log->file, 0, SEEK_END);
+    if (log->format == ResultsCsv && ftell(log->file) == 0)
+    {
+        fputs("session,source,algorithm,size,distribution,seed,key_bits,threads,wall_ms,swaps,comparisons,"
+              "array_accesses,array_writes",
+              log->file);
+        for (int i = 0; i < NumPerfCounters; i++)
+        {
+            fprintf(log->file, ",%s", perfColumns[i]);
+        }
+        fputc('\n', log->file);
+        fflush(log->file);
+    }
+    return true;
+}
+
+void results_close(struct ResultsLog *log)
+{
+    if (log->file != NULL)
+        fclose(log->file);
+    log->file = NULL;
+}
+
+void results_write(struct ResultsLog *log, const struct RunRecord *record)
+{
+    FILE *file = log->file;
+    const struct SortStats *stats = &record->sortStats;
+    double wallMilliseconds = (double)record->wallNanoseconds / 1e6;
+    if (log->format == ResultsCsv)
+    {
+        fprintf(file, "%s,", log->session);
+        csv_string(file, record->source);
+        fputc(',', file);
+        csv_string(file, record->algorithm);
+        fprintf(file, ",%zu,", record->count);
+        csv_string(file, record->distribution);
+        fprintf(file, ",%llu,%d,%zu,%.6f,%zu,%zu,%zu,%zu", (unsigned long long)record->seed, SORTSIM_KEY_BITS,
+                stats->threads, wallMilliseconds, stats->swaps, stats->comparisons, stats->arrayAccesses,
+                stats->arrayWrites);
+        // Counters that weren't measured are left empty
+        for (int i = 0; i < NumPerfCounters; i++)
+        {
+            if (record->perf != NULL && record->perf->available[i])
+                fprintf(file, ",%llu", (unsigned long long)record->perf->values[i]);
+            else
+                fputc(',', file);
+        }
+    }
+    else
+    {
+        fputs("{\"session\":", file);
+        json_string(file, log->session);
+        fputs(",\"source\":", file);
+        json_string(file, record->source);
+        fputs(",\"algorithm\":", file);
+        json_string(file, record->algorithm);
+        fprintf(file, ",\"size\":%zu,\"distribution\":", record->count);
+        json_string(file, record->distribution);
+        fprintf(file,
+                ",\"seed\":%llu,\"key_bits\":%d,\"threads\":%zu,\"wall_ms\":%.6f,\"swaps\":%zu,\"comparisons\":%zu,"
+                "\"array_accesses\":%zu,\"array_writes\":%zu",
+                (unsigned long long)record->seed, SORTSIM_KEY_BITS, stats->threads, wallMilliseconds, stats->swaps,
+                stats->comparisons, stats->arrayAccesses, stats->arrayWrites);
+        for (int i = 0; i < NumPerfCounters; i++)
+        {
+            if (record->perf != NULL && record->perf->available[i])
+                fprintf(file, ",\"%s\":%llu", perfColumns[i], (unsigned long long)record->perf->values[i]);
+            else
+                fprintf(file, ",\"%s\":null", perfColumns[i]);
+        }
+        fputc('}', file);
+    }
+    fputc('\n', file);
+    fflush(file);
+}
@@ -0,0 +1,46 @@
+#ifndef RESULTS_H
+#define RESULTS_H
+
+#include "sorts/sort_types.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+enum ResultsFormat {
+    ResultsCsv,
+    ResultsJsonLines,
+};
+
+// One finished sort, with everything needed to compare it against runs on other machines
+struct RunRecord {
+    // What produced the run, "gui" or the bench suite
+    const char *source;
+    const char *algorithm;
+    size_t count;
+    // Input distribution, or the path of a loaded file
+    const char *distribution;
+    uint64_t seed;
+    uint64_t wallNanoseconds;
+    struct SortStats sortStats;
+    // Counters of the run, NULL when they weren't measured
+    const struct PerfSample *perf;
+};
+
+struct ResultsLog {
+    FILE *file;
+    enum ResultsFormat format;
+    // Ties every record to the manifest line describing the build and machine that produced it
+    char session[40];
+};
+
+/*
+* Append runs to path, as CSV when it ends in ".csv" and as JSON lines otherwise. A manifest with the compiler,
+* flags, key width and CPU of this session is appended to path with ".manifest.jsonl" added, and every record names
+* its session. program is recorded in the manifest. Prints why and returns false when a file can't be opened.
+*/
+bool results_open(struct ResultsLog *log, const char *path, const char *program);
+void results_close(struct ResultsLog *log);
+// Append one record and flush it, so a crash loses nothing already finished
+void results_write(struct ResultsLog *log, const struct RunRecord *record);
+
+#endif // !RESULTS_H
@@ -1,34 +1,314 @@
 ﻿#include <raylib.h>
+#include <stdio.h>
+#include <string.h>
 #include <time.h>
 #define RAYGUI_IMPLEMENTATION
 #include <raygui.h>
 #include <style_cyber.h>
 #include "visualizer.h"
+#include "frame_export.h"
+#include "race.h"
+#include "sorts/random.h"
+#include "sorts/sorts.h"
+#include "sorts/cpu_dispatch.h"
+#include "sorts/distribution.h"
+#include "sorts/op_ring.h"
+#include "io/external_sort.h"
+#include "io/results.h"
+#include "parallel/job_queue.h"
+#include "perf/trace.h"
 
-int main()
+int main(int argc, char **argv)
 {
-    srand((unsigned int)time(NULL));
+    uint64_t seed = (uint64_t)time(NULL);
+    const char *loadPath = NULL;
+    const char *tracePath = NULL;
+    const char *resultsPath = NULL;
+    const char *raceNames = NULL;
+    const char *durationText = NULL;
+    const char *sortName = NULL;
+    const char *modeName = NULL;
+    const char *distributionName = NULL;
+    const char *rendererName = NULL;
+    const char *soundName = NULL;
+    const char *isaName = NULL;
+    size_t count = DEFAULT_VISUALIZER_SIZE;
+    struct FrameExportOptions exportOptions = {NULL, 1280, 720, 60, OP_RING_BATCH, 1.0f, false};
+    unsigned keyBits = SORTSIM_KEY_BITS;
+    struct ExternalSortOptions external = {NULL, NULL, NULL, (size_t)1024 << 20};
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (strcmp(argv[i], "--seed") == 0)
+            seed = strtoull(argv[i + 1], NULL, 0);
+        else if (strcmp(argv[i], "--load") == 0)
+            loadPath = argv[i + 1];
+        else if (strcmp(argv[i], "--key-bits") == 0)
+            keyBits = (unsigned)strtoul(argv[i + 1], NULL, 10);
+        else if (strcmp(argv[i], "--external") == 0)
+            external.inputPath = argv[i + 1];
+        else if (strcmp(argv[i], "--output") == 0)
+            external.outputPath = argv[i + 1];
+        else if (strcmp(argv[i], "--temp") == 0)
+            external.tempDirectory = argv[i + 1];
+        else if (strcmp(argv[i], "--memory-mb") == 0)
+            external.memoryBudget = (size_t)strtoull(argv[i + 1], NULL, 10) << 20;
+        else if (strcmp(argv[i], "--trace") == 0)
+            tracePath = argv[i + 1];
+        else if (strcmp(argv[i], "--results") == 0)
+            resultsPath = argv[i + 1];
+        else if (strcmp(argv[i], "--race") == 0)
+            raceNames = argv[i + 1];
+        else if (strcmp(argv[i], "--duration") == 0)
+            durationText = argv[i + 1];
+        else if (strcmp(argv[i], "--sort") == 0)
+            sortName = argv[i + 1];
+        else if (strcmp(argv[i], "--mode") == 0)
+            modeName = argv[i + 1];
+        else if (strcmp(argv[i], "--distribution") == 0)
+            distributionName = argv[i + 1];
+        else if (strcmp(argv[i], "--count") == 0)
+            count = (size_t)strtoull(argv[i + 1], NULL, 10);
+        else if (strcmp(argv[i], "--renderer") == 0)
+            rendererName = argv[i + 1];
+        else if (strcmp(argv[i], "--sound") == 0)
+            soundName = argv[i + 1];
+        else if (strcmp(argv[i], "--isa") == 0)
+            isaName = argv[i + 1];
+        else if (strcmp(argv[i], "--export") == 0)
+            exportOptions.path = argv[i + 1];
+        else if (strcmp(argv[i], "--export-size") == 0)
+        {
+            if (sscanf(argv[i + 1], "%dx%d", &exportOptions.width, &exportOptions.height) != 2)
+                exportOptions.width = 0;
+        }
+        else if (strcmp(argv[i], "--fps") == 0)
+            exportOptions.fps = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--ops-per-frame") == 0)
+            exportOptions.opsPerFrame = (size_t)strtoull(argv[i + 1], NULL, 10);
+    }
+    // Everything recorded is written out as Chrome trace JSON when the window closes
+    if (tracePath != NULL)
+    {
+        trace_enable();
+        trace_thread_name("Main");
+    }
+    random_set_global_seed(seed);
+    random_seed_thread(RandomStreamMain);
+    printf("Seed: %llu\n", (unsigned long long)seed);
+    // Kernels run built for the widest instruction set the CPU has, unless held to a lower one. I cycles through
+    // them in the window
+    cpu_dispatch_init();
+    if (isaName != NULL && !cpu_dispatch_force(isaName))
+        return EXIT_FAILURE;
+    printf("Kernels: %s\n", cpuLevelNames[cpu_dispatch_level()]);
     struct Visualizer visualizer;
     visualizer_init(&visualizer);
-    visualizer_resize(&visualizer, DEFAULT_VISUALIZER_SIZE);
-    // Raylib configuration
-    SetConfigFlags(FLAG_WINDOW_RESIZABLE);
-    InitWindow(1280, 720, "Sorting Simulator");
-    SetTargetFPS(60);
-    GuiLoadStyleCyber();
-    InitAudioDevice();
+    // Streamed accesses index the array with 32 bits, and every value has to fit a key
+    size_t maximumCount = (SortValueType)-1 < UINT32_MAX ? (SortValueType)-1 : UINT32_MAX;
+    if (count < 2 || count > maximumCount)
+    {
+        fprintf(stderr, "--count needs 2 to %zu values\n", maximumCount);
+        return EXIT_FAILURE;
+    }
+    visualizer_resize(&visualizer, count);
+    if (sortName != NULL && (visualizer.selectedSort = sort_from_name(sortName)) == NumSorts)
+    {
+        fprintf(stderr, "Unknown sort: %s\n", sortName);
+        return EXIT_FAILURE;
+    }
+    if (modeName != NULL && (visualizer.mode = visualizer_mode_from_name(modeName)) == NumModes)
+    {
+        fprintf(stderr, "Unknown mode: %s\n", modeName);
+        return EXIT_FAILURE;
+    }
+    if (distributionName != NULL &&
+        (visualizer.distribution = distribution_from_name(distributionName)) == NumDistributions)
+    {
+        fprintf(stderr, "Unknown distribution: %s\n", distributionName);
+        return EXIT_FAILURE;
+    }
+    // Sorting a loaded file rewrites it in place, the size slider goes back to a generated array
+    if (loadPath != NULL && !visualizer_load(&visualizer, loadPath, keyBits))
+        return EXIT_FAILURE;
+    // Every finished sort is appended as a CSV row or JSON line, next to a manifest of this build and machine
+    struct ResultsLog results;
+    if (resultsPath != NULL)
+    {
+        if (!results_open(&results, resultsPath, "SortSim"))
+            return EXIT_FAILURE;
+        visualizer.results = &results;
+    }
+    // Comma separated sorts to race, which opens in race mode with only those ticked
+    if (raceNames != NULL)
+    {
+        char names[512];
+        snprintf(names, sizeof(names), "%s", raceNames);
+        memset(visualizer.raceEntries, 0, sizeof(visualizer.raceEntries));
+        for (char *name = strtok(names, ","); name != NULL; name = strtok(NULL, ","))
+        {
+            enum SortType sort = sort_from_name(name);
+            if (sort == NumSorts)
+            {
+                fprintf(stderr, "Unknown sort to race: %s\n", name);
+                return EXIT_FAILURE;
+            }
+            visualizer.raceEntries[sort] = true;
+        }
+        size_t entries = race_entry_count(&visualizer);
+        if (entries < RACE_MIN_PANES || entries > RACE_MAX_PANES)
+        {
+            fprintf(stderr, "--race needs %d to %d different sorts\n", RACE_MIN_PANES, RACE_MAX_PANES);
+            return EXIT_FAILURE;
+        }
+        visualizer.raceMode = visualizer.dataset == NULL;
+    }
+    // Seconds every sort is spread over, which opens with timed runs on
+    if (durationText != NULL)
+    {
+        visualizer.targetSeconds = strtof(durationText, NULL);
+        if (!(visualizer.targetSeconds >= MIN_TARGET_SECONDS && visualizer.targetSeconds <= MAX_TARGET_SECONDS))
+        {
+            fprintf(stderr, "--duration needs %.0f to %.0f seconds\n", MIN_TARGET_SECONDS, MAX_TARGET_SECONDS);
+            return EXIT_FAILURE;
+        }
+        visualizer.timed = true;
+    }
+    // The array is drawn by raylib on the GPU unless asked to draw it on the CPU, see soft_render.h
+    if (rendererName != NULL)
+    {
+        if (strcmp(rendererName, "cpu") != 0 && strcmp(rendererName, "gpu") != 0)
+        {
+            fputs("--renderer needs cpu or gpu\n", stderr);
+            return EXIT_FAILURE;
+        }
+        visualizer.softwareRender = strcmp(rendererName, "cpu") == 0;
+        exportOptions.software = visualizer.softwareRender;
+    }
+    // Compares and writes are heard unless turned off, M toggles it in the window
+    if (soundName != NULL)
+    {
+        if (strcmp(soundName, "on") != 0 && strcmp(soundName, "off") != 0)
+        {
+            fputs("--sound needs on or off\n", stderr);
+            return EXIT_FAILURE;
+        }
+        visualizer.sound = strcmp(soundName, "on") == 0;
+    }
+    if (external.inputPath != NULL && external.outputPath == NULL)
+    {
+        fputs("--external needs an --output path for the sorted file\n", stderr);
+        return EXIT_FAILURE;
+    }
+    // Renders the selected sort to a video or numbered images as fast as it can and exits, without showing a window
+    if (exportOptions.path != NULL)
+    {
+        if (external.inputPath != NULL)
+        {
+            fputs("--export can't be combined with --external\n", stderr);
+            return EXIT_FAILURE;
+        }
+        if (exportOptions.width < 2 || exportOptions.height < 2 || exportOptions.width % 2 != 0 ||
+            exportOptions.height % 2 != 0)
+        {
+            fputs("--export-size needs an even width and height such as 1280x720\n", stderr);
+            return EXIT_FAILURE;
+        }
+        if (exportOptions.fps < 1 || exportOptions.fps > 240)
+        {
+            fputs("--fps needs 1 to 240 frames a second\n", stderr);
+            return EXIT_FAILURE;
+        }
+        if (exportOptions.opsPerFrame < 1 || exportOptions.opsPerFrame > OP_RING_CAPACITY)
+        {
+            fprintf(stderr, "--ops-per-frame needs 1 to %d accesses\n", OP_RING_CAPACITY);
+            return EXIT_FAILURE;
+        }
+        visualizer.raceMode = false;
+        // A loaded file is sorted as it is
+        if (visualizer.dataset == NULL)
+            visualizer_generate(&visualizer);
+    }
+    // Sorts run on these workers, one for every pane of a race, started here and joined once the window closes
+    struct JobQueue sortJobs;
+    job_queue_init(&sortJobs, RACE_MAX_PANES);
+    visualizer.jobs = &sortJobs;
+    if (external.inputPath != NULL)
+        visualizer_start_external_sort(&visualizer, &external);
+    int status = EXIT_SUCCESS;
+    bool windowOpen = true;
+    if (exportOptions.path != NULL)
+    {
+        // Frames are drawn offscreen, the window is only there for its GL context. Without one they are drawn on the
+        // CPU instead
+        if (!exportOptions.software)
+        {
+            SetConfigFlags(FLAG_WINDOW_HIDDEN);
+            InitWindow(exportOptions.width, exportOptions.height, "Sorting Simulator");
+            if (!IsWindowReady())
+            {
+                fputs("No window with a GL context could be opened, drawing frames on the CPU\n", stderr);
+                exportOptions.software = true;
+            }
+        }
+        windowOpen = IsWindowReady();
+        if (!frame_export_run(&visualizer, &exportOptions))
+            status = EXIT_FAILURE;
+    }
+    else
+    {
+        // Raylib configuration
+        SetConfigFlags(FLAG_WINDOW_RESIZABLE);
+        InitWindow(1280, 720, "Sorting Simulator");
+        SetTargetFPS(60);
+        GuiLoadStyleCyber();
+        InitAudioDevice();
+        visualizer_load_audio(&visualizer);
+    }
     // Mainloop
-    while (!WindowShouldClose())
+    bool waitingForEvents = false;
+    while (exportOptions.path == NULL && !WindowShouldClose())
     {
+        trace_begin("frame");
         BeginDrawing();
         ClearBackground(BLACK);
+        trace_begin("draw");
         visualizer_draw(&visualizer);
+        trace_end("draw");
+        trace_begin("gui");
         visualizer_draw_gui(&visualizer);
+        trace_end("gui");
+        // An idle window only redraws on input, nothing else changes what it shows. Sorts are only started from the
+        // GUI, which is checked after it so the frame that starts one doesn't sit waiting for the next event
+        bool animating = visualizer_animating(&visualizer);
+        if (animating == waitingForEvents)
+        {
+            if (animating)
+                DisableEventWaiting();
+            else
+                EnableEventWaiting();
+            waitingForEvents = !animating;
+        }
+        // Swapping buffers waits for the frame's slot, and for input while idle, long spans here are time the UI thread
+        // sat idle
+        trace_begin("present");
         EndDrawing();
+        trace_end("present");
+        trace_end("frame");
     }
     // Cleanup
-    CloseWindow();
-    CloseAudioDevice();
+    visualizer_unload(&visualizer);
+    if (windowOpen)
+        CloseWindow();
+    if (exportOptions.path == NULL)
+        CloseAudioDevice();
     visualizer_free(&visualizer);
-    return EXIT_SUCCESS;
+    job_queue_free(&sortJobs);
+    if (resultsPath != NULL)
+        results_close(&results);
+    if (tracePath != NULL)
+    {
+        trace_write(tracePath);
+        trace_shutdown();
+    }
+    return status;
 }
\ No newline at end of file
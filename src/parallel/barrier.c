@@ -0,0 +1,76 @@
+#include "barrier.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BARRIER_SPIN_COUNT 2048
+#define BARRIER_YIELD_COUNT 16
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define CPU_RELAX() _mm_pause()
+#elif defined(__x86_64__) || defined(__i386__)
+#define CPU_RELAX() __builtin_ia32_pause()
+#else
+#define CPU_RELAX() ((void)0)
+#endif
+
+void barrier_init(struct Barrier *barrier, size_t threshold, BarrierCompletion completion, void *completionContext)
+{
+    if (mtx_init(&barrier->mutex, mtx_plain) != thrd_success || cnd_init(&barrier->released) != thrd_success)
+    {
+        fputs("Failed to initialise barrier\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+    barrier->threshold = threshold;
+    atomic_init(&barrier->arrived, 0);
+    atomic_init(&barrier->generation, 0);
+    atomic_init(&barrier->sleepers, 0);
+    barrier->completion = completion;
+    barrier->completionContext = completionContext;
+}
+
+void barrier_destroy(struct Barrier *barrier)
+{
+    cnd_destroy(&barrier->released);
+    mtx_destroy(&barrier->mutex);
+}
+
+bool barrier_wait(struct Barrier *barrier)
+{
+    size_t generation = atomic_load(&barrier->generation);
+    if (atomic_fetch_add(&barrier->arrived, 1) + 1 == barrier->threshold)
+    {
+        // Last to arrive, every other thread is parked until the generation changes
+        if (barrier->completion)
+            barrier->completion(barrier->completionContext);
+        atomic_store(&barrier->arrived, 0);
+        atomic_store(&barrier->generation, generation + 1);
+        if (atomic_load(&barrier->sleepers) > 0)
+        {
+            mtx_lock(&barrier->mutex);
+            cnd_broadcast(&barrier->released);
+            mtx_unlock(&barrier->mutex);
+        }
+        return true;
+    }
+
+    for (size_t i = 0; i < BARRIER_SPIN_COUNT + BARRIER_YIELD_COUNT; i++)
+    {
+        if (atomic_load_explicit(&barrier->generation, memory_order_acquire) != generation)
+            return false;
+        if (i < BARRIER_SPIN_COUNT)
+            CPU_RELAX();
+        else
+            thrd_yield();
+    }
+
+    mtx_lock(&barrier->mutex);
+    atomic_fetch_add(&barrier->sleepers, 1);
+    while (atomic_load(&barrier->generation) == generation)
+    {
+        cnd_wait(&barrier->released, &barrier->mutex);
+    }
+    atomic_fetch_sub(&barrier->sleepers, 1);
+    mtx_unlock(&barrier->mutex);
+    return false;
+}
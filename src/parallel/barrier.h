@@ -0,0 +1,32 @@
+#ifndef BARRIER_H
+#define BARRIER_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <threads.h>
+
+// Called by the last thread to arrive at a barrier, before any thread is released
+typedef void (*BarrierCompletion)(void *context);
+
+/*
+* Reusable barrier for a fixed number of threads. Waiting threads spin briefly on the generation counter
+* before falling back to a condition variable, as the phases we synchronise are usually very short.
+*/
+struct Barrier {
+    mtx_t mutex;
+    cnd_t released;
+    size_t threshold;
+    _Atomic size_t arrived;
+    _Atomic size_t generation;
+    _Atomic size_t sleepers;
+    BarrierCompletion completion;
+    void *completionContext;
+};
+
+void barrier_init(struct Barrier *barrier, size_t threshold, BarrierCompletion completion, void *completionContext);
+void barrier_destroy(struct Barrier *barrier);
+// Block until `threshold` threads have called this. Returns true on exactly one thread, the one that ran completion
+bool barrier_wait(struct Barrier *barrier);
+
+#endif // !BARRIER_H
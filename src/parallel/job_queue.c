@@ -0,0 +1,106 @@
+#include "job_queue.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static int job_queue_worker(void *arg)
+{
+    struct JobQueue *queue = (struct JobQueue *)arg;
+    mtx_lock(&queue->mutex);
+    for (;;)
+    {
+        while (queue->head == NULL && !queue->shutdown)
+        {
+            cnd_wait(&queue->submitted, &queue->mutex);
+        }
+        if (queue->head == NULL)
+            break;
+        struct Job *job = queue->head;
+        queue->head = job->next;
+        if (queue->head == NULL)
+            queue->tail = NULL;
+        mtx_unlock(&queue->mutex);
+
+        int result = job->run(job->arg);
+
+        mtx_lock(&queue->mutex);
+        job->result = result;
+        job->pending = false;
+        cnd_broadcast(&queue->completed);
+    }
+    mtx_unlock(&queue->mutex);
+    return 0;
+}
+
+void job_queue_init(struct JobQueue *queue, size_t workerCount)
+{
+    queue->head = NULL;
+    queue->tail = NULL;
+    queue->shutdown = false;
+    queue->workerCount = workerCount > 0 ? workerCount : 1;
+    queue->threads = malloc(queue->workerCount * sizeof(thrd_t));
+    if (queue->threads == NULL)
+    {
+        fputs("Failed to allocate memory for job queue\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+    if (mtx_init(&queue->mutex, mtx_plain) != thrd_success || cnd_init(&queue->submitted) != thrd_success ||
+        cnd_init(&queue->completed) != thrd_success)
+    {
+        fputs("Failed to initialise job queue synchronisation\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < queue->workerCount; i++)
+    {
+        if (thrd_create(&queue->threads[i], job_queue_worker, queue) != thrd_success)
+        {
+            fputs("Error creating thread\n", stderr);
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+void job_queue_free(struct JobQueue *queue)
+{
+    mtx_lock(&queue->mutex);
+    queue->shutdown = true;
+    cnd_broadcast(&queue->submitted);
+    mtx_unlock(&queue->mutex);
+    for (size_t i = 0; i < queue->workerCount; i++)
+    {
+        thrd_join(queue->threads[i], NULL);
+    }
+    free(queue->threads);
+    queue->threads = NULL;
+    cnd_destroy(&queue->completed);
+    cnd_destroy(&queue->submitted);
+    mtx_destroy(&queue->mutex);
+}
+
+void job_queue_submit(struct JobQueue *queue, struct Job *job, JobFunction run, void *arg)
+{
+    job->run = run;
+    job->arg = arg;
+    job->result = 0;
+    job->next = NULL;
+    mtx_lock(&queue->mutex);
+    job->pending = true;
+    if (queue->tail != NULL)
+        queue->tail->next = job;
+    else
+        queue->head = job;
+    queue->tail = job;
+    cnd_signal(&queue->submitted);
+    mtx_unlock(&queue->mutex);
+}
+
+int job_queue_wait(struct JobQueue *queue, struct Job *job)
+{
+    mtx_lock(&queue->mutex);
+    while (job->pending)
+    {
+        cnd_wait(&queue->completed, &queue->mutex);
+    }
+    int result = job->result;
+    mtx_unlock(&queue->mutex);
+    return result;
+}
@@ -0,0 +1,43 @@
+#ifndef JOB_QUEUE_H
+#define JOB_QUEUE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <threads.h>
+
+typedef int (*JobFunction)(void *arg);
+
+// A call to run on a queue worker, owned by the caller until job_queue_wait returns. Zero it before first use
+struct Job {
+    JobFunction run;
+    void *arg;
+    // What run returned, valid once the job is no longer pending
+    int result;
+    bool pending;
+    struct Job *next;
+};
+
+/*
+* Long lived worker threads that run submitted jobs in submission order, started once instead of creating a thread
+* for every run. Jobs are handed back through job_queue_wait, and freeing the queue finishes everything already
+* submitted before joining the workers, so nothing is left running or leaked at shutdown.
+*/
+struct JobQueue {
+    thrd_t *threads;
+    size_t workerCount;
+    mtx_t mutex;
+    cnd_t submitted;
+    cnd_t completed;
+    struct Job *head;
+    struct Job *tail;
+    bool shutdown;
+};
+
+void job_queue_init(struct JobQueue *queue, size_t workerCount);
+// Finish every submitted job and stop the workers
+void job_queue_free(struct JobQueue *queue);
+void job_queue_submit(struct JobQueue *queue, struct Job *job, JobFunction run, void *arg);
+// Block until job has run and return its result, returns at once for a job that is not pending
+int job_queue_wait(struct JobQueue *queue, struct Job *job);
+
+#endif // !JOB_QUEUE_H
@@ -0,0 +1,140 @@
+#include "thread_pool.h"
+#include "perf/trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+struct WorkerStart {
+    struct ThreadPool *pool;
+    size_t workerIndex;
+};
+
+size_t hardware_thread_count(void)
+{
+#if defined(_WIN32)
+    SYSTEM_INFO systemInfo;
+    GetSystemInfo(&systemInfo);
+    return systemInfo.dwNumberOfProcessors > 0 ? (size_t)systemInfo.dwNumberOfProcessors : 1;
+#elif defined(__unix__) || defined(__APPLE__)
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    return processors > 0 ? (size_t)processors : 1;
+#else
+    return 1;
+#endif
+}
+
+static int thread_pool_worker(void *arg)
+{
+    struct WorkerStart *start = (struct WorkerStart *)arg;
+    struct ThreadPool *pool = start->pool;
+    size_t workerIndex = start->workerIndex;
+    free(start);
+    char name[32];
+    snprintf(name, sizeof(name), "Pool Worker %zu", workerIndex);
+    trace_thread_name(name);
+
+    size_t seenGeneration = 0;
+    mtx_lock(&pool->mutex);
+    for (;;)
+    {
+        while (!pool->shutdown && pool->generation == seenGeneration)
+        {
+            cnd_wait(&pool->taskReady, &pool->mutex);
+        }
+        if (pool->shutdown)
+            break;
+        seenGeneration = pool->generation;
+        ThreadPoolTask task = pool->task;
+        void *context = pool->context;
+        mtx_unlock(&pool->mutex);
+
+        task(context, workerIndex, pool->workerCount);
+
+        mtx_lock(&pool->mutex);
+        if (--pool->running == 0)
+            cnd_signal(&pool->taskDone);
+    }
+    mtx_unlock(&pool->mutex);
+    return 0;
+}
+
+void thread_pool_init(struct ThreadPool *pool, size_t workerCount)
+{
+    if (workerCount < 1)
+        workerCount = 1;
+    pool->workerCount = workerCount;
+    pool->task = NULL;
+    pool->context = NULL;
+    pool->generation = 0;
+    pool->running = 0;
+    pool->shutdown = false;
+    if (mtx_init(&pool->mutex, mtx_plain) != thrd_success || cnd_init(&pool->taskReady) != thrd_success ||
+        cnd_init(&pool->taskDone) != thrd_success)
+    {
+        fputs("Failed to initialise thread pool\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+    pool->threads = malloc((workerCount - 1) * sizeof(thrd_t) + 1);
+    if (pool->threads == NULL)
+    {
+        fputs("Failed to allocate memory for thread pool\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 1; i < workerCount; i++)
+    {
+        struct WorkerStart *start = malloc(sizeof(struct WorkerStart));
+        if (start == NULL)
+        {
+            fputs("Failed to allocate memory for thread pool\n", stderr);
+            exit(EXIT_FAILURE);
+        }
+        start->pool = pool;
+        start->workerIndex = i;
+        if (thrd_create(&pool->threads[i - 1], thread_pool_worker, start) != thrd_success)
+        {
+            fputs("Error creating thread\n", stderr);
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+void thread_pool_free(struct ThreadPool *pool)
+{
+    mtx_lock(&pool->mutex);
+    pool->shutdown = true;
+    cnd_broadcast(&pool->taskReady);
+    mtx_unlock(&pool->mutex);
+    for (size_t i = 1; i < pool->workerCount; i++)
+    {
+        thrd_join(pool->threads[i - 1], NULL);
+    }
+    free(pool->threads);
+    pool->threads = NULL;
+    cnd_destroy(&pool->taskDone);
+    cnd_destroy(&pool->taskReady);
+    mtx_destroy(&pool->mutex);
+}
+
+void thread_pool_run(struct ThreadPool *pool, ThreadPoolTask task, void *context)
+{
+    mtx_lock(&pool->mutex);
+    pool->task = task;
+    pool->context = context;
+    pool->running = pool->workerCount - 1;
+    pool->generation++;
+    cnd_broadcast(&pool->taskReady);
+    mtx_unlock(&pool->mutex);
+
+    task(context, 0, pool->workerCount);
+
+    mtx_lock(&pool->mutex);
+    while (pool->running > 0)
+    {
+        cnd_wait(&pool->taskDone, &pool->mutex);
+    }
+    mtx_unlock(&pool->mutex);
+}
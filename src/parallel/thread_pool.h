@@ -0,0 +1,36 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <threads.h>
+
+// Work run by every thread of the pool, workerIndex is in [0, workerCount)
+typedef void (*ThreadPoolTask)(void *context, size_t workerIndex, size_t workerCount);
+
+/*
+* Fixed size pool for data parallel work. The thread calling thread_pool_run takes part as worker 0, so a pool
+* of N workers owns N - 1 threads.
+*/
+struct ThreadPool {
+    thrd_t *threads;
+    size_t workerCount;
+    mtx_t mutex;
+    cnd_t taskReady;
+    cnd_t taskDone;
+    ThreadPoolTask task;
+    void *context;
+    size_t generation;
+    size_t running;
+    bool shutdown;
+};
+
+// Number of hardware threads available to this process, never less than one
+size_t hardware_thread_count(void);
+
+void thread_pool_init(struct ThreadPool *pool, size_t workerCount);
+void thread_pool_free(struct ThreadPool *pool);
+// Run task on every worker and return once all of them have finished
+void thread_pool_run(struct ThreadPool *pool, ThreadPoolTask task, void *context);
+
+#endif // !THREAD_POOL_H
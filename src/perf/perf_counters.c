@@ -0,0 +1,187 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE // RUSAGE_THREAD
+#endif
+#include "perf_counters.h"
+#include <string.h>
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+const char *const perfCounterNames[] = {"Cycles",      "Instructions",   "L1D Misses",    "LLC Misses",
+                                        "Branch Misses", "dTLB Misses", "Task Clock ns", "Page Faults",
+                                        "Context Switches"};
+
+// CPU time of the calling thread in nanoseconds
+static uint64_t thread_clock_nanoseconds(void)
+{
+#if defined(_WIN32)
+    FILETIME creation, exited, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &creation, &exited, &kernel, &user))
+        return 0;
+    uint64_t ticks = ((uint64_t)kernel.dwHighDateTime << 32 | kernel.dwLowDateTime) +
+                     ((uint64_t)user.dwHighDateTime << 32 | user.dwLowDateTime);
+    return ticks * 100;
+#else
+    struct timespec time;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return (uint64_t)time.tv_sec * 1000000000ull + (uint64_t)time.tv_nsec;
+#endif
+}
+
+static void thread_usage(uint64_t *pageFaults, uint64_t *contextSwitches)
+{
+#if defined(_WIN32)
+    *pageFaults = 0;
+    *contextSwitches = 0;
+#else
+    struct rusage usage;
+#if defined(__linux__)
+    getrusage(RUSAGE_THREAD, &usage);
+#else
+    getrusage(RUSAGE_SELF, &usage);
+#endif
+    *pageFaults = (uint64_t)(usage.ru_minflt + usage.ru_majflt);
+    *contextSwitches = (uint64_t)(usage.ru_nvcsw + usage.ru_nivcsw);
+#endif
+}
+
+#if defined(__linux__)
+static int perf_event_open_counter(uint32_t type, uint64_t config)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+#define PERF_CACHE_READ_MISS(cache)                                                                                    \
+    ((cache) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+#endif
+
+void perf_counters_open(struct PerfCounters *counters)
+{
+    for (int i = 0; i < NumPerfCounters; i++)
+    {
+        counters->fds[i] = -1;
+    }
+    counters->hardware = false;
+#if defined(__linux__)
+    const struct {
+        uint32_t type;
+        uint64_t config;
+    } events[NumPerfCounters] = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HW_CACHE, PERF_CACHE_READ_MISS(PERF_COUNT_HW_CACHE_L1D)},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        {PERF_TYPE_HW_CACHE, PERF_CACHE_READ_MISS(PERF_COUNT_HW_CACHE_DTLB)},
+        {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+        {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+        {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+    };
+    for (int i = 0; i < NumPerfCounters; i++)
+    {
+        counters->fds[i] = perf_event_open_counter(events[i].type, events[i].config);
+        if (counters->fds[i] != -1 && i < PerfTaskClock)
+            counters->hardware = true;
+    }
+#endif
+}
+
+void perf_counters_close(struct PerfCounters *counters)
+{
+    for (int i = 0; i < NumPerfCounters; i++)
+    {
+#if defined(__linux__)
+        if (counters->fds[i] != -1)
+            close(counters->fds[i]);
+#endif
+        counters->fds[i] = -1;
+    }
+}
+
+void perf_counters_start(struct PerfCounters *counters)
+{
+    counters->startClock = thread_clock_nanoseconds();
+    thread_usage(&counters->startPageFaults, &counters->startContextSwitches);
+#if defined(__linux__)
+    for (int i = 0; i < NumPerfCounters; i++)
+    {
+        if (counters->fds[i] != -1)
+        {
+            ioctl(counters->fds[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(counters->fds[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#endif
+}
+
+void perf_counters_stop(struct PerfCounters *counters, struct PerfSample *sample)
+{
+    memset(sample, 0, sizeof(*sample));
+#if defined(__linux__)
+    for (int i = 0; i < NumPerfCounters; i++)
+    {
+        if (counters->fds[i] != -1)
+            ioctl(counters->fds[i], PERF_EVENT_IOC_DISABLE, 0);
+    }
+    for (int i = 0; i < NumPerfCounters; i++)
+    {
+        uint64_t reading[3];
+        if (counters->fds[i] == -1 || read(counters->fds[i], reading, sizeof(reading)) != (ssize_t)sizeof(reading))
+            continue;
+        // A counter that never got scheduled measured nothing, one that shared the PMU is scaled up
+        if (reading[2] == 0)
+            continue;
+        sample->values[i] = reading[2] == reading[1]
+                                ? reading[0]
+                                : (uint64_t)((double)reading[0] * (double)reading[1] / (double)reading[2]);
+        sample->available[i] = true;
+    }
+#endif
+    // Fallbacks for the software counters perf couldn't provide
+    uint64_t pageFaults, contextSwitches;
+    thread_usage(&pageFaults, &contextSwitches);
+    if (!sample->available[PerfTaskClock])
+    {
+        sample->values[PerfTaskClock] = thread_clock_nanoseconds() - counters->startClock;
+        sample->available[PerfTaskClock] = true;
+    }
+#if !defined(_WIN32)
+    if (!sample->available[PerfPageFaults])
+    {
+        sample->values[PerfPageFaults] = pageFaults - counters->startPageFaults;
+        sample->available[PerfPageFaults] = true;
+    }
+    if (!sample->available[PerfContextSwitches])
+    {
+        sample->values[PerfContextSwitches] = contextSwitches - counters->startContextSwitches;
+        sample->available[PerfContextSwitches] = true;
+    }
+#endif
+}
+
+double perf_sample_ipc(const struct PerfSample *sample)
+{
+    if (!sample->available[PerfCycles] || !sample->available[PerfInstructions] || sample->values[PerfCycles] == 0)
+        return 0.0;
+    return (double)sample->values[PerfInstructions] / (double)sample->values[PerfCycles];
+}
@@ -0,0 +1,49 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+enum PerfCounter {
+    PerfCycles,
+    PerfInstructions,
+    PerfL1dMisses,
+    PerfLlcMisses,
+    PerfBranchMisses,
+    PerfDtlbMisses,
+    // Software counters, kept when the hardware ones can't be opened, such as in many VMs
+    PerfTaskClock,
+    PerfPageFaults,
+    PerfContextSwitches,
+    NumPerfCounters,
+};
+
+extern const char *const perfCounterNames[];
+
+// Counts over one run, a counter that could not be measured is left unavailable rather than zero
+struct PerfSample {
+    uint64_t values[NumPerfCounters];
+    bool available[NumPerfCounters];
+};
+
+/*
+* Counters for the calling thread and threads it starts afterwards. On Linux these are perf_event_open events
+* restricted to user space so they work with the default perf_event_paranoid, multiplexed counts are scaled up to
+* the whole run. Anything perf can't provide falls back to the thread CPU clock and getrusage.
+*/
+struct PerfCounters {
+    int fds[NumPerfCounters];
+    bool hardware;
+    uint64_t startClock;
+    uint64_t startPageFaults;
+    uint64_t startContextSwitches;
+};
+
+void perf_counters_open(struct PerfCounters *counters);
+void perf_counters_close(struct PerfCounters *counters);
+void perf_counters_start(struct PerfCounters *counters);
+void perf_counters_stop(struct PerfCounters *counters, struct PerfSample *sample);
+// Instructions per cycle, or 0 when either is unavailable
+double perf_sample_ipc(const struct PerfSample *sample);
+
+#endif // !PERF_COUNTERS_H
@@ -0,0 +1,216 @@
+#include "trace.h"
+#include "sorts/sorts.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <threads.h>
+
+struct TraceEvent {
+    const char *name;
+    const char *argName;
+    int64_t argValue;
+    uint64_t timestamp;
+    char phase;
+};
+
+// Written by its own thread only, the count is published with release so the writer sees whole events
+struct TraceRing {
+    struct TraceEvent *events;
+    _Atomic uint64_t written;
+    // Whether a live thread records into the ring, cleared when it exits so another thread can take the ring over
+    _Atomic bool owned;
+    unsigned tid;
+    char name[32];
+};
+
+_Atomic bool traceEnabled = false;
+static uint64_t traceStart;
+static struct TraceRing *_Atomic rings[TRACE_MAX_THREADS];
+static _Atomic size_t ringCount = 0;
+static thread_local struct TraceRing *threadRing = NULL;
+static thread_local bool threadRingMissing = false;
+// Holds the calling thread's ring so its destructor hands the ring back when the thread exits
+static tss_t ringOwner;
+static once_flag ringOwnerOnce = ONCE_FLAG_INIT;
+
+static void trace_release_ring(void *ring)
+{
+    atomic_store(&((struct TraceRing *)ring)->owned, false);
+}
+
+static void trace_create_ring_owner(void)
+{
+    if (tss_create(&ringOwner, trace_release_ring) != thrd_success)
+    {
+        fputs("Failed to create trace ring key\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+}
+
+void trace_enable(void)
+{
+    call_once(&ringOwnerOnce, trace_create_ring_owner);
+    traceStart = monotonic_nanoseconds();
+    atomic_store(&traceEnabled, true);
+}
+
+static struct TraceRing *trace_claim_ring(struct TraceRing *ring)
+{
+    threadRing = ring;
+    tss_set(ringOwner, ring);
+    return ring;
+}
+
+/*
+* Parallel sorts start new pool threads for every run, so rings are recycled: a thread takes over the ring of one
+* that has exited before making a new one. The events recorded before stay in the ring until overwritten, under the
+* same row of the trace, which is renamed after the thread now recording.
+*/
+static struct TraceRing *trace_thread_ring(void)
+{
+    if (threadRing != NULL || threadRingMissing)
+        return threadRing;
+    size_t count = atomic_load(&ringCount);
+    for (size_t t = 0; t < count && t < TRACE_MAX_THREADS; t++)
+    {
+        struct TraceRing *ring = atomic_load(&rings[t]);
+        bool owned = false;
+        if (ring != NULL && atomic_compare_exchange_strong(&ring->owned, &owned, true))
+        {
+            snprintf(ring->name, sizeof(ring->name), "Thread %u", ring->tid);
+            return trace_claim_ring(ring);
+        }
+    }
+    size_t index = atomic_fetch_add(&ringCount, 1);
+    if (index >= TRACE_MAX_THREADS)
+    {
+        threadRingMissing = true;
+        return NULL;
+    }
+    struct TraceRing *ring = malloc(sizeof(struct TraceRing));
+    struct TraceEvent *events = malloc(TRACE_RING_EVENTS * sizeof(struct TraceEvent));
+    if (ring == NULL || events == NULL)
+    {
+        fputs("Failed to allocate memory for trace events\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+    ring->events = events;
+    atomic_init(&ring->written, 0);
+    atomic_init(&ring->owned, true);
+    ring->tid = (unsigned)index + 1;
+    snprintf(ring->name, sizeof(ring->name), "Thread %u", ring->tid);
+    atomic_store(&rings[index], ring);
+    return trace_claim_ring(ring);
+}
+
+void trace_thread_name(const char *name)
+{
+    if (!atomic_load_explicit(&traceEnabled, memory_order_relaxed))
+        return;
+    struct TraceRing *ring = trace_thread_ring();
+    if (ring == NULL)
+        return;
+    // The name ends up inside a JSON string
+    size_t i = 0;
+    for (; name[i] != '\0' && i + 1 < sizeof(ring->name); i++)
+    {
+        ring->name[i] = name[i] == '"' || name[i] == '\\' || (unsigned char)name[i] < 0x20 ? '_' : name[i];
+    }
+    ring->name[i] = '\0';
+}
+
+void trace_record(const char *name, char phase, const char *argName, int64_t argValue)
+{
+    struct TraceRing *ring = trace_thread_ring();
+    if (ring == NULL)
+        return;
+    uint64_t index = atomic_load_explicit(&ring->written, memory_order_relaxed);
+    struct TraceEvent *event = &ring->events[index % TRACE_RING_EVENTS];
+    event->name = name;
+    event->argName = argName;
+    event->argValue = argValue;
+    event->timestamp = monotonic_nanoseconds();
+    event->phase = phase;
+    atomic_store_explicit(&ring->written, index + 1, memory_order_release);
+}
+
+static double trace_microseconds(uint64_t timestamp)
+{
+    return timestamp > traceStart ? (double)(timestamp - traceStart) / 1000.0 : 0.0;
+}
+
+bool trace_write(const char *path)
+{
+    FILE *file = fopen(path, "w");
+    if (file == NULL)
+    {
+        perror(path);
+        return false;
+    }
+    uint64_t now = monotonic_nanoseconds();
+    size_t threads = atomic_load(&ringCount);
+    if (threads > TRACE_MAX_THREADS)
+        threads = TRACE_MAX_THREADS;
+    fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n", file);
+    fputs("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"SortSim\"}}", file);
+    for (size_t t = 0; t < threads; t++)
+    {
+        // A thread that is still setting its ring up has nothing recorded yet
+        struct TraceRing *ring = atomic_load(&rings[t]);
+        if (ring == NULL)
+            continue;
+        fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                ring->tid, ring->name);
+        uint64_t written = atomic_load_explicit(&ring->written, memory_order_acquire);
+        uint64_t first = written > TRACE_RING_EVENTS ? written - TRACE_RING_EVENTS : 0;
+        size_t depth = 0;
+        for (uint64_t i = first; i < written; i++)
+        {
+            const struct TraceEvent *event = &ring->events[i % TRACE_RING_EVENTS];
+            // Spans whose begin was overwritten are dropped rather than closing an unrelated span
+            if (event->phase == 'E')
+            {
+                if (depth == 0)
+                    continue;
+                depth--;
+            }
+            else
+            {
+                depth++;
+            }
+            fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%u", event->name,
+                    event->phase, trace_microseconds(event->timestamp), ring->tid);
+            if (event->argName != NULL)
+                fprintf(file, ",\"args\":{\"%s\":%lld}", event->argName, (long long)event->argValue);
+            fputc('}', file);
+        }
+        // Spans still open, such as a sort that is running, end when the trace was written
+        for (; depth > 0; depth--)
+        {
+            fprintf(file, ",\n{\"ph\":\"E\",\"ts\":%.3f,\"pid\":1,\"tid\":%u}", trace_microseconds(now), ring->tid);
+        }
+    }
+    fputs("\n]}\n", file);
+    if (fclose(file) != 0)
+    {
+        perror(path);
+        return false;
+    }
+    return true;
+}
+
+void trace_shutdown(void)
+{
+    atomic_store(&traceEnabled, false);
+    size_t threads = atomic_exchange(&ringCount, 0);
+    if (threads > TRACE_MAX_THREADS)
+        threads = TRACE_MAX_THREADS;
+    for (size_t t = 0; t < threads; t++)
+    {
+        struct TraceRing *ring = atomic_exchange(&rings[t], NULL);
+        if (ring != NULL)
+        {
+            free(ring->events);
+            free(ring);
+        }
+    }
+}
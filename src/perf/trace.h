@@ -0,0 +1,52 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Events kept per thread, older ones are overwritten once a thread has recorded more
+#define TRACE_RING_EVENTS 65536
+// Rings kept at once. The ring of a thread that exits goes to the next thread started, threads started while this
+// many others are alive record nothing
+#define TRACE_MAX_THREADS 256
+
+/*
+* Begin and end events of named spans, recorded into a ring per thread and written out as Chrome trace JSON that
+* Perfetto (ui.perfetto.dev) and chrome://tracing open. Recording is off until trace_enable, and while it is off
+* every trace call is a single relaxed load. Names must be string literals, only their pointers are stored.
+*/
+extern _Atomic bool traceEnabled;
+
+void trace_enable(void);
+// Name the calling thread in the trace, copied so it may be temporary
+void trace_thread_name(const char *name);
+void trace_record(const char *name, char phase, const char *argName, int64_t argValue);
+// Write every recorded event to path. Meant for when the traced threads are idle, a thread recording while its
+// ring is written may have its oldest events torn. Prints why and returns false on failure
+bool trace_write(const char *path);
+// Free every ring, recording stays off afterwards. Only once the other threads that recorded have exited
+void trace_shutdown(void);
+
+static inline void trace_begin(const char *name)
+{
+    if (atomic_load_explicit(&traceEnabled, memory_order_relaxed))
+        trace_record(name, 'B', NULL, 0);
+}
+
+// Begin a span that shows value under argName when selected, such as the gap of a shell sort pass
+static inline void trace_begin_arg(const char *name, const char *argName, int64_t value)
+{
+    if (atomic_load_explicit(&traceEnabled, memory_order_relaxed))
+        trace_record(name, 'B', argName, value);
+}
+
+// End the innermost open span of the calling thread, name should match its begin
+static inline void trace_end(const char *name)
+{
+    if (atomic_load_explicit(&traceEnabled, memory_order_relaxed))
+        trace_record(name, 'E', NULL, 0);
+}
+
+#endif // !TRACE_H
@@ -0,0 +1,150 @@
+#include "race.h"
+#include "sorts/sorts.h"
+#include "sorts/random.h"
+#include "sorts/distribution.h"
+#include "io/results.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+size_t race_entry_count(const struct Visualizer *visualizer)
+{
+    size_t entries = 0;
+    for (size_t s = 0; s < NumSorts; s++)
+    {
+        entries += visualizer->raceEntries[s];
+    }
+    return entries;
+}
+
+// Append every pane of a finished race to the results log, from the last pane's worker once the others are done
+static void race_record(struct Race *race)
+{
+    struct Visualizer *visualizer = race->visualizer;
+    for (size_t i = 0; i < race->paneCount; i++)
+    {
+        struct RacePane *pane = &race->panes[i];
+        struct RunRecord record;
+        record.source = "race";
+        record.algorithm = sortNames[pane->sort];
+        record.count = visualizer->count;
+        record.distribution = distributionNames[visualizer->distribution];
+        record.seed = random_global_seed();
+        record.wallNanoseconds = pane->wallNanoseconds;
+        record.sortStats = pane->sortStats;
+        record.perf = NULL;
+        results_write(visualizer->results, &record);
+    }
+}
+
+static int race_pane_run(void *arg)
+{
+    struct RacePane *pane = (struct RacePane *)arg;
+    struct Race *race = pane->race;
+    struct Visualizer *visualizer = race->visualizer;
+    char threadName[32];
+    snprintf(threadName, sizeof(threadName), "Race Pane %zu", (size_t)(pane - race->panes) + 1);
+    trace_thread_name(threadName);
+    // Every pane draws the same numbers, so two panes running the same randomised sort stay in step
+    random_seed_thread(RandomStreamSort);
+    struct SortFunctionArgs args = {&pane->sortStats, pane->values, visualizer->count, &visualizer->cancelSort,
+                                    &visualizer->speed, &pane->control};
+    trace_begin(sortNames[pane->sort]);
+    sortFunctions[pane->sort](args);
+    trace_end(sortNames[pane->sort]);
+    // Time spent paused doesn't count, every pane is paused together but reaches its checkpoint at its own time
+    pane->wallNanoseconds = monotonic_nanoseconds() - race->startNanoseconds - pane->control.pausedNanoseconds;
+    if (!atomic_load(&visualizer->cancelSort))
+        atomic_store(&pane->place, atomic_fetch_add(&race->finished, 1) + 1);
+    // The last pane out records the race and hands the visualizer back
+    if (atomic_fetch_sub(&race->running, 1) == 1)
+    {
+        if (atomic_load(&visualizer->cancelSort))
+            atomic_store(&visualizer->cancelSort, false);
+        else if (visualizer->results != NULL)
+            race_record(race);
+        atomic_store(&visualizer->isSorting, false);
+    }
+    return 0;
+}
+
+void race_start(struct Visualizer *visualizer)
+{
+    if (race_entry_count(visualizer) < RACE_MIN_PANES ||
+        is_already_sorted(visualizer->values, visualizer->count, NULL))
+        return;
+    struct Race *race = visualizer->race;
+    if (race == NULL)
+    {
+        race = calloc(1, sizeof(struct Race));
+        if (race == NULL)
+        {
+            fputs("Failed to allocate memory for race\n", stderr);
+            exit(EXIT_FAILURE);
+        }
+        race->visualizer = visualizer;
+        for (size_t i = 0; i < RACE_MAX_PANES; i++)
+        {
+            sort_control_init(&race->panes[i].control);
+        }
+        visualizer->race = race;
+    }
+    // The last race or sort has cleared isSorting, but its workers may still be on their way out
+    for (size_t i = 0; i < RACE_MAX_PANES; i++)
+    {
+        job_queue_wait(visualizer->jobs, &race->panes[i].job);
+    }
+    job_queue_wait(visualizer->jobs, &visualizer->sortJob);
+    race->maximum = visualizer->maximum;
+    race->paneCount = 0;
+    for (size_t s = 0; s < NumSorts && race->paneCount < RACE_MAX_PANES; s++)
+    {
+        if (!visualizer->raceEntries[s])
+            continue;
+        struct RacePane *pane = &race->panes[race->paneCount++];
+        // Panes keep their copy between races, the race is freed along with the array it was sized for
+        if (pane->values == NULL)
+        {
+            pane->values = malloc(visualizer->count * sizeof(SortValueType));
+            if (pane->values == NULL)
+            {
+                fputs("Failed to allocate memory for race\n", stderr);
+                exit(EXIT_FAILURE);
+            }
+        }
+        memcpy(pane->values, visualizer->values, visualizer->count * sizeof(SortValueType));
+        pane->race = race;
+        pane->sort = (enum SortType)s;
+        sort_stats_reset(&pane->sortStats);
+        pane->sortStats.heatmap = NULL;
+        pane->sortStats.pacer = &pane->pacer;
+        pane->sortStats.ops = NULL;
+        pane->sortStats.tones = NULL;
+        pane->wallNanoseconds = 0;
+        atomic_store(&pane->place, 0);
+    }
+    atomic_store(&race->finished, 0);
+    atomic_store(&race->running, race->paneCount);
+    atomic_store(&visualizer->isSorting, true);
+    atomic_store(&visualizer->cancelSort, false);
+    race->startNanoseconds = monotonic_nanoseconds();
+    for (size_t i = 0; i < race->paneCount; i++)
+    {
+        struct RacePane *pane = &race->panes[i];
+        op_pacer_start(&pane->pacer, &visualizer->speed, true);
+        sort_control_start(&pane->control, false);
+        job_queue_submit(visualizer->jobs, &pane->job, race_pane_run, pane);
+    }
+}
+
+void race_free(struct Race *race)
+{
+    for (size_t i = 0; i < RACE_MAX_PANES; i++)
+    {
+        job_queue_wait(race->visualizer->jobs, &race->panes[i].job);
+        free(race->panes[i].values);
+        race->panes[i].values = NULL;
+        sort_control_free(&race->panes[i].control);
+    }
+    race->paneCount = 0;
+}
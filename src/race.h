@@ -0,0 +1,56 @@
+#ifndef RACE_H
+#define RACE_H
+
+#include "visualizer.h"
+#include "parallel/job_queue.h"
+#include "sorts/pacer.h"
+#include "sorts/sort_control.h"
+#include <stdatomic.h>
+#include <stdint.h>
+
+#define RACE_MIN_PANES 2
+#define RACE_MAX_PANES 9
+
+struct Race;
+
+// One sort of a race, working on a copy of the shared input
+struct RacePane {
+    struct Race *race;
+    enum SortType sort;
+    SortValueType *values;
+    struct SortStats sortStats;
+    struct OpPacer pacer;
+    struct SortControl control;
+    struct Job job;
+    // Time from the start of the race until the pane finished, written before it takes its place
+    uint64_t wallNanoseconds;
+    // Finishing position counting from 1, 0 while it runs and for every pane of a cancelled race
+    _Atomic size_t place;
+};
+
+/*
+* Several sorts racing on copies of the same input, every one on a worker of its own and drawn in a pane of its
+* own. All panes are paced by operation count off the same delay slider, so the winner is the sort that needed the
+* fewest comparisons and writes rather than the one with the shortest delays between its steps. The visualizer's
+* isSorting and cancelSort cover the whole race, the last pane to finish clears them.
+*/
+struct Race {
+    struct Visualizer *visualizer;
+    struct RacePane panes[RACE_MAX_PANES];
+    // Panes drawn in place of the array, 0 once the array has been refilled since the last race
+    size_t paneCount;
+    SortValueType maximum;
+    uint64_t startNanoseconds;
+    _Atomic size_t finished;
+    _Atomic size_t running;
+};
+
+// Number of sorts ticked in the visualizer's race entries
+size_t race_entry_count(const struct Visualizer *visualizer);
+// Copy the array to a pane for every ticked sort and start them all on the visualizer's job queue. Needs between
+// RACE_MIN_PANES and RACE_MAX_PANES entries and no sort running
+void race_start(struct Visualizer *visualizer);
+// Wait for the panes to stop, which they do quickly once cancelSort is set and they are woken, then release them
+void race_free(struct Race *race);
+
+#endif // !RACE_H
@@ -0,0 +1,131 @@
+#include "soft_render.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+void soft_renderer_init(struct SoftRenderer *renderer)
+{
+    renderer->pixels = NULL;
+    renderer->width = 0;
+    renderer->height = 0;
+    size_t threads = hardware_thread_count();
+    renderer->bandCount = threads < SOFT_RENDER_MAX_BANDS ? threads : SOFT_RENDER_MAX_BANDS;
+    thread_pool_init(&renderer->pool, renderer->bandCount);
+    renderer->clearColor = 0;
+    renderer->draw = NULL;
+    renderer->context = NULL;
+    renderer->scratch = NULL;
+    renderer->scratchBytes = 0;
+}
+
+void soft_renderer_free(struct SoftRenderer *renderer)
+{
+    thread_pool_free(&renderer->pool);
+    free(renderer->pixels);
+    renderer->pixels = NULL;
+    renderer->width = 0;
+    renderer->height = 0;
+    free(renderer->scratch);
+    renderer->scratch = NULL;
+    renderer->scratchBytes = 0;
+}
+
+void soft_renderer_resize(struct SoftRenderer *renderer, int width, int height)
+{
+    if (width == renderer->width && height == renderer->height)
+        return;
+    free(renderer->pixels);
+    renderer->pixels = malloc((size_t)width * (size_t)height * sizeof(uint32_t));
+    if (renderer->pixels == NULL)
+    {
+        fputs("Failed to allocate memory for framebuffer\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+    renderer->width = width;
+    renderer->height = height;
+}
+
+void *soft_renderer_scratch(struct SoftRenderer *renderer, size_t bytes)
+{
+    if (bytes <= renderer->scratchBytes)
+        return renderer->scratch;
+    free(renderer->scratch);
+    renderer->scratch = malloc(bytes);
+    if (renderer->scratch == NULL)
+    {
+        fputs("Failed to allocate memory for framebuffer\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+    renderer->scratchBytes = bytes;
+    return renderer->scratch;
+}
+
+static void soft_renderer_task(void *context, size_t workerIndex, size_t workerCount)
+{
+    struct SoftRenderer *renderer = (struct SoftRenderer *)context;
+    struct SoftBand band;
+    band.pixels = renderer->pixels;
+    band.width = renderer->width;
+    band.height = renderer->height;
+    band.top = (int)((size_t)renderer->height * workerIndex / workerCount);
+    band.bottom = (int)((size_t)renderer->height * (workerIndex + 1) / workerCount);
+    for (int y = band.top; y < band.bottom; y++)
+    {
+        soft_fill_span(band.pixels + (size_t)y * (size_t)band.width, 0, band.width, renderer->clearColor);
+    }
+    renderer->draw(renderer->context, &band);
+}
+
+void soft_renderer_draw(struct SoftRenderer *renderer, uint32_t color, SoftBandFunction draw, void *context)
+{
+    renderer->clearColor = color;
+    renderer->draw = draw;
+    renderer->context = context;
+    thread_pool_run(&renderer->pool, soft_renderer_task, renderer);
+}
+
+void soft_fill_rect(const struct SoftBand *band, int x, int y, int width, int height, uint32_t color)
+{
+    int x0 = x > 0 ? x : 0;
+    int x1 = x + width < band->width ? x + width : band->width;
+    int y0 = y > band->top ? y : band->top;
+    int y1 = y + height < band->bottom ? y + height : band->bottom;
+    for (int row = y0; row < y1 && x0 < x1; row++)
+    {
+        soft_fill_span(band->pixels + (size_t)row * (size_t)band->width, x0, x1, color);
+    }
+}
+
+void soft_outline_rect(const struct SoftBand *band, int x, int y, int width, int height, uint32_t color)
+{
+    soft_fill_rect(band, x, y, width, 1, color);
+    soft_fill_rect(band, x, y + height - 1, width, 1, color);
+    soft_fill_rect(band, x, y + 1, 1, height - 2, color);
+    soft_fill_rect(band, x + width - 1, y + 1, 1, height - 2, color);
+}
+
+void soft_fill_circle(const struct SoftBand *band, float centerX, float centerY, float radius, uint32_t color)
+{
+    int y0 = (int)floorf(centerY - radius);
+    int y1 = (int)ceilf(centerY + radius);
+    if (y0 < band->top)
+        y0 = band->top;
+    if (y1 > band->bottom)
+        y1 = band->bottom;
+    for (int row = y0; row < y1; row++)
+    {
+        float dy = (float)row + 0.5f - centerY;
+        float squared = radius * radius - dy * dy;
+        if (squared < 0.0f)
+            continue;
+        float half = sqrtf(squared);
+        int x0 = (int)ceilf(centerX - half - 0.5f);
+        int x1 = (int)floorf(centerX + half - 0.5f) + 1;
+        if (x0 < 0)
+            x0 = 0;
+        if (x1 > band->width)
+            x1 = band->width;
+        if (x0 < x1)
+            soft_fill_span(band->pixels + (size_t)row * (size_t)band->width, x0, x1, color);
+    }
+}
@@ -0,0 +1,101 @@
+#ifndef SOFT_RENDER_H
+#define SOFT_RENDER_H
+
+#include "parallel/thread_pool.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+// Most bands a frame is split into, more only adds threads that each touch a sliver of it
+#define SOFT_RENDER_MAX_BANDS 16
+
+// Pixel of the given colour as laid out in memory, R, G, B then A, so the framebuffer uploads and saves as RGBA8
+static inline uint32_t soft_pixel(uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+{
+    uint8_t bytes[4] = {r, g, b, a};
+    uint32_t pixel;
+    memcpy(&pixel, bytes, sizeof(pixel));
+    return pixel;
+}
+
+// Rows [top, bottom) of a frame, the only ones a band's primitives write to
+struct SoftBand {
+    uint32_t *pixels;
+    int width;
+    int height;
+    int top;
+    int bottom;
+};
+
+typedef void (*SoftBandFunction)(void *context, const struct SoftBand *band);
+
+/*
+* Draws frames on the CPU into a framebuffer of 32 bit pixels, for machines without a GPU and for arrays too large
+* to draw one primitive call at a time. A frame is split into horizontal bands drawn in parallel, every band goes
+* over all of the frame's primitives but only writes its own rows, so the threads never write the same pixel and
+* nothing needs sorting into bins first.
+*/
+struct SoftRenderer {
+    uint32_t *pixels;
+    int width;
+    int height;
+    size_t bandCount;
+    struct ThreadPool pool;
+    // Frame being drawn, for the pool's workers
+    uint32_t clearColor;
+    SoftBandFunction draw;
+    void *context;
+    // Working memory for whoever draws the frames, kept between them
+    void *scratch;
+    size_t scratchBytes;
+};
+
+void soft_renderer_init(struct SoftRenderer *renderer);
+void soft_renderer_free(struct SoftRenderer *renderer);
+// Size the framebuffer for frames of width by height, what it holds afterwards is undefined
+void soft_renderer_resize(struct SoftRenderer *renderer, int width, int height);
+// Scratch memory of at least bytes, which keeps its contents only until the next call
+void *soft_renderer_scratch(struct SoftRenderer *renderer, size_t bytes);
+// Clear the framebuffer to colour and call draw once for every band, in parallel. Returns once all are drawn
+void soft_renderer_draw(struct SoftRenderer *renderer, uint32_t color, SoftBandFunction draw, void *context);
+
+// Fill pixels [x0, x1) of a row, which the caller has already clipped to the frame
+static inline void soft_fill_span(uint32_t *row, int x0, int x1, uint32_t color)
+{
+    int x = x0;
+#if defined(__SSE2__) || defined(_M_X64)
+    // Up to an aligned address, then four pixels a store and sixteen a loop
+    for (; x < x1 && ((uintptr_t)(row + x) & 15) != 0; x++)
+    {
+        row[x] = color;
+    }
+    __m128i fill = _mm_set1_epi32((int)color);
+    for (; x + 16 <= x1; x += 16)
+    {
+        _mm_store_si128((__m128i *)(row + x), fill);
+        _mm_store_si128((__m128i *)(row + x + 4), fill);
+        _mm_store_si128((__m128i *)(row + x + 8), fill);
+        _mm_store_si128((__m128i *)(row + x + 12), fill);
+    }
+    for (; x + 4 <= x1; x += 4)
+    {
+        _mm_store_si128((__m128i *)(row + x), fill);
+    }
+#endif
+    for (; x < x1; x++)
+    {
+        row[x] = color;
+    }
+}
+
+// Primitives clipped to the band, matching where raylib's shapes of the same arguments land
+void soft_fill_rect(const struct SoftBand *band, int x, int y, int width, int height, uint32_t color);
+// One pixel wide outline inside the rectangle
+void soft_outline_rect(const struct SoftBand *band, int x, int y, int width, int height, uint32_t color);
+// Every pixel whose centre lies within radius of the centre
+void soft_fill_circle(const struct SoftBand *band, float centerX, float centerY, float radius, uint32_t color);
+
+#endif // !SOFT_RENDER_H
@@ -0,0 +1,141 @@
+#include "auto_sort.h"
+#include "counting_sort.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Values per sampled block, and the probe reads one block in every AUTO_SORT_BLOCK
+#define AUTO_SORT_BLOCK 64
+#define AUTO_SORT_DUPLICATE_SAMPLE 1024
+#define AUTO_SORT_INSERTION_MAX 32
+#define AUTO_SORT_RADIX_MIN 4096
+
+static int compare_values(const void *a, const void *b)
+{
+    SortValueType x = *(const SortValueType *)a;
+    SortValueType y = *(const SortValueType *)b;
+    return (x > y) - (x < y);
+}
+
+static void auto_sort_choose(struct AutoSortDecision *decision, size_t count)
+{
+    size_t pairs = decision->sampledPairs;
+    size_t ascents = pairs - decision->descents - decision->equals;
+    size_t range = key_range(decision->minimum, decision->maximum);
+    char *reason = decision->reason;
+    const size_t reasonSize = sizeof(decision->reason);
+    if (count <= AUTO_SORT_INSERTION_MAX)
+    {
+        decision->sort = InsertionSort;
+        snprintf(reason, reasonSize, "%zu values is small enough for insertion sort", count);
+    }
+    else if (decision->descents == 0)
+    {
+        decision->sort = NaturalMergeSort;
+        snprintf(reason, reasonSize, "no descents in %zu sampled pairs, expect a single run", pairs);
+    }
+    else if (ascents * 64 < pairs)
+    {
+        decision->sort = NaturalMergeSort;
+        snprintf(reason, reasonSize, "%zu of %zu sampled pairs descend, runs will be reversed in place",
+                 decision->descents, pairs);
+    }
+    else if ((range <= count || (decision->duplicateRatio >= 0.5f && range <= count * 16)) &&
+             counting_sort_fits(range, count))
+    {
+        decision->sort = CountingSort;
+        if (range <= count)
+            snprintf(reason, reasonSize, "key range %zu is no larger than the array, counting table fits", range);
+        else
+            snprintf(reason, reasonSize, "key range %zu with %.0f%% duplicates fits a counting table", range,
+                     (double)decision->duplicateRatio * 100.0);
+    }
+    else if (decision->descents * 16 < pairs)
+    {
+        decision->sort = NaturalMergeSort;
+        snprintf(reason, reasonSize, "about %zu ascending runs, merging them is O(n log runs)",
+                 decision->estimatedRuns);
+    }
+    else if (count >= AUTO_SORT_RADIX_MIN)
+    {
+        decision->sort = RadixSort;
+        snprintf(reason, reasonSize, "random order over %zu values, radix sort makes %zu linear passes", count,
+                 sizeof(SortValueType));
+    }
+    else
+    {
+        decision->sort = IntroSort;
+        snprintf(reason, reasonSize, "random order over %zu values, too few for radix passes to pay off", count);
+    }
+}
+
+void auto_sort_probe(const SortValueType *values, size_t count, struct AutoSortDecision *decision)
+{
+    memset(decision, 0, sizeof(*decision));
+    if (count == 0)
+    {
+        auto_sort_choose(decision, count);
+        return;
+    }
+    // Small arrays are scanned completely, larger ones one block in every AUTO_SORT_BLOCK
+    size_t blocks = count / (AUTO_SORT_BLOCK * AUTO_SORT_BLOCK);
+    size_t stride = AUTO_SORT_BLOCK * AUTO_SORT_BLOCK;
+    if (blocks == 0)
+    {
+        blocks = (count + AUTO_SORT_BLOCK - 1) / AUTO_SORT_BLOCK;
+        stride = AUTO_SORT_BLOCK;
+    }
+    SortValueType sample[AUTO_SORT_DUPLICATE_SAMPLE];
+    size_t sampleSize = 0;
+    size_t sampleEvery = (blocks * AUTO_SORT_BLOCK + AUTO_SORT_DUPLICATE_SAMPLE - 1) / AUTO_SORT_DUPLICATE_SAMPLE;
+    size_t sampled = 0;
+    decision->minimum = values[0];
+    decision->maximum = values[0];
+    for (size_t b = 0; b < blocks; b++)
+    {
+        size_t start = b * stride;
+        // One value past the block so that neighbouring blocks of a full scan share their boundary pair
+        size_t length = count - start < AUTO_SORT_BLOCK + 1 ? count - start : AUTO_SORT_BLOCK + 1;
+        struct OrderScan scan = scan_order(values + start, length);
+        decision->descents += scan.descents;
+        decision->equals += scan.equals;
+        decision->sampledPairs += length - 1;
+        size_t blockLength = length < AUTO_SORT_BLOCK ? length : AUTO_SORT_BLOCK;
+        for (size_t i = start; i < start + blockLength; i++)
+        {
+            if (values[i] < decision->minimum)
+                decision->minimum = values[i];
+            if (values[i] > decision->maximum)
+                decision->maximum = values[i];
+            if (sampled++ % sampleEvery == 0 && sampleSize < AUTO_SORT_DUPLICATE_SAMPLE)
+                sample[sampleSize++] = values[i];
+        }
+    }
+    // Duplicates only matter when the key range is too wide for a counting table on its own
+    size_t range = key_range(decision->minimum, decision->maximum);
+    if (range > count && range <= count * 16)
+    {
+        size_t duplicates = 0;
+        qsort(sample, sampleSize, sizeof(SortValueType), compare_values);
+        for (size_t i = 1; i < sampleSize; i++)
+        {
+            duplicates += sample[i] == sample[i - 1];
+        }
+        decision->duplicateRatio = sampleSize > 1 ? (float)duplicates / (float)(sampleSize - 1) : 0.0f;
+    }
+    decision->estimatedRuns =
+        decision->sampledPairs > 0 ? 1 + decision->descents * (count - 1) / decision->sampledPairs : 1;
+    auto_sort_choose(decision, count);
+}
+
+void auto_sort_dispatch(struct SortFunctionArgs args, const struct AutoSortDecision *decision)
+{
+    sortFunctions[decision->sort](args);
+}
+
+void auto_sort(struct SortFunctionArgs args)
+{
+    struct AutoSortDecision decision;
+    auto_sort_probe(args.values, args.count, &decision);
+    auto_sort_dispatch(args, &decision);
+}
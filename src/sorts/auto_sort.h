@@ -0,0 +1,13 @@
+#ifndef AUTO_SORT_H
+#define AUTO_SORT_H
+
+#include "sorts.h"
+
+// Probe and run the chosen sort, callers that show the decision probe and dispatch themselves
+void auto_sort(struct SortFunctionArgs args);
+// Sample roughly count / 64 values for presortedness, duplicates and key range and pick a sort for them
+void auto_sort_probe(const SortValueType *values, size_t count, struct AutoSortDecision *decision);
+// Run the sort picked by auto_sort_probe
+void auto_sort_dispatch(struct SortFunctionArgs args, const struct AutoSortDecision *decision);
+
+#endif // !AUTO_SORT_H
@@ -1,6 +1,6 @@
 #include "bogo_sort.h"
 
-#define BOGO_SORT_SLEEP sleep_microseconds((uint64_t)(*args.speed * 1000.0f));
+#define BOGO_SORT_SLEEP sort_delay(&args, 1000.0f);
 
 void bogo_sort(struct SortFunctionArgs args)
 {
@@ -11,7 +11,7 @@ void bogo_sort(struct SortFunctionArgs args)
     {
         shuffle(values, count, sortStats);
         BOGO_SORT_SLEEP
-        if (atomic_load(args.cancelSort))
+        if (sort_phase_end(&args))
             return;
     }
 }
\ No newline at end of file
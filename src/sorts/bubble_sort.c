@@ -1,6 +1,6 @@
 #include "bubble_sort.h"
 
-#define BUBBLE_SORT_SLEEP sleep_microseconds((uint64_t)(*args.speed * 1000.0f));
+#define BUBBLE_SORT_SLEEP sort_delay(&args, 1000.0f);
 
 void bubble_sort(struct SortFunctionArgs args)
 {
@@ -8,11 +8,15 @@ void bubble_sort(struct SortFunctionArgs args)
     struct SortStats *sortStats = args.sortStats;
     SortValueType *values = args.values;
     size_t count = args.count;
+    if (count < 2)
+        return;
     for (size_t i = 0; i < count - 1 && swapped; i++)
     {
         swapped = false;
         for (size_t j = 0; j < count - i - 1; j++)
         {
+            track_read(sortStats, &values[j]);
+            track_read(sortStats, &values[j + 1]);
             if (values[j] > values[j + 1])
             {
                 swap(sortStats, &values[j + 1], &values[j]);
@@ -20,8 +24,10 @@ void bubble_sort(struct SortFunctionArgs args)
             }
             sortStats->comparisons++;
             BUBBLE_SORT_SLEEP
-            if (atomic_load(args.cancelSort))
+            if (sort_checkpoint(&args))
                 return;
         }
+        if (sort_phase_end(&args))
+            return;
     }
 }
\ No newline at end of file
@@ -2,10 +2,12 @@
 
 void cocktail_shaker_sort(struct SortFunctionArgs args)
 {
-#define COCKTAIL_SHAKER_SORT_SLEEP sleep_microseconds((uint64_t)(*args.speed * 1000.0f));
+#define COCKTAIL_SHAKER_SORT_SLEEP sort_delay(&args, 1000.0f);
     struct SortStats *sortStats = args.sortStats;
     SortValueType *values = args.values;
     size_t count = args.count;
+    if (count < 2)
+        return;
     size_t left = 0;
     size_t right = count - 1;
     bool swapped = true;
@@ -15,32 +17,40 @@ void cocktail_shaker_sort(struct SortFunctionArgs args)
         // Move the largest element to the end
         for (size_t i = left; i < right; ++i)
         {
+            track_read(sortStats, &values[i]);
+            track_read(sortStats, &values[i + 1]);
             if (values[i] > values[i + 1])
             {
                 swap(sortStats, &values[i], &values[i + 1]);
                 COCKTAIL_SHAKER_SORT_SLEEP
-                if (atomic_load(args.cancelSort))
+                if (sort_checkpoint(&args))
                     return;
                 swapped = true;
             }
             sortStats->comparisons++;
         }
         right--;
+        if (sort_phase_end(&args))
+            return;
 
         // Move the smallest element to the beginning
         for (size_t i = right; i > left; --i)
         {
+            track_read(sortStats, &values[i]);
+            track_read(sortStats, &values[i - 1]);
             if (values[i] < values[i - 1])
             {
                 swap(sortStats, &values[i], &values[i - 1]);
                 COCKTAIL_SHAKER_SORT_SLEEP
-                if (atomic_load(args.cancelSort))
+                if (sort_checkpoint(&args))
                     return;
                 swapped = true;
             }
             sortStats->comparisons++;
         }
         left++;
+        if (sort_phase_end(&args))
+            return;
     }
 #undef COCKTAIL_SHAKER_SORT_SLEEP
 }
\ No newline at end of file
@@ -0,0 +1,90 @@
+#include "counting_sort.h"
+#include "radix_sort.h"
+#include <stdlib.h>
+
+#define COUNTING_SORT_SLEEP sort_delay(&args, 5000.0f);
+// Widest key range given a counting table regardless of the array size, every 16-bit range fits
+#define COUNTING_SORT_MIN_TABLE 65536
+// Largest counting table in bytes, as a multiple of the bytes of the array it sorts
+#define COUNTING_SORT_TABLE_RATIO 2
+
+bool counting_sort_fits(size_t range, size_t count)
+{
+    if (range <= COUNTING_SORT_MIN_TABLE)
+        return true;
+    // The range alone is never multiplied, 64-bit keys can span close to SIZE_MAX
+    return range <= count * sizeof(SortValueType) * COUNTING_SORT_TABLE_RATIO / sizeof(size_t);
+}
+
+// Write every key still counted from key on, starting at values[k]. A cancelled sort still has to put back the keys
+// only its table holds, they are written without pacing or tracking
+static void counting_sort_finish(SortValueType *values, size_t k, const size_t *counts, size_t key, size_t range,
+                                 SortValueType minimum)
+{
+    for (; key < range; key++)
+    {
+        for (size_t n = counts[key]; n > 0; n--)
+        {
+            values[k++] = (SortValueType)(minimum + key);
+        }
+    }
+}
+
+void counting_sort(struct SortFunctionArgs args)
+{
+    struct SortStats *sortStats = args.sortStats;
+    SortValueType *values = args.values;
+    size_t count = args.count;
+    if (count < 2)
+        return;
+    SortValueType minimum = values[0];
+    SortValueType maximum = values[0];
+    for (size_t i = 1; i < count; i++)
+    {
+        if (values[i] < minimum)
+            minimum = values[i];
+        if (values[i] > maximum)
+            maximum = values[i];
+    }
+    sortStats->arrayAccesses += count;
+    size_t range = key_range(minimum, maximum);
+    // Wide 32 and 64-bit keys would need a table far larger than the array, radix sort them instead, and so when
+    // even the table that fits can't be had
+    size_t *counts = counting_sort_fits(range, count) ? calloc(range, sizeof(size_t)) : NULL;
+    if (counts == NULL)
+    {
+        radix_sort(args);
+        return;
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        track_read(sortStats, &values[i]);
+        counts[values[i] - minimum]++;
+    }
+    sortStats->arrayAccesses += count;
+    size_t k = 0;
+    for (size_t key = 0; key < range; key++)
+    {
+        for (size_t n = counts[key]; n > 0; n--)
+        {
+            values[k] = (SortValueType)(minimum + key);
+            track_write(sortStats, &values[k++]);
+            sortStats->arrayWrites++;
+            COUNTING_SORT_SLEEP
+            if (sort_checkpoint(&args))
+            {
+                counts[key] = n - 1;
+                counting_sort_finish(values, k, counts, key, range, minimum);
+                free(counts);
+                return;
+            }
+        }
+        if (counts[key] > 0 && sort_phase_end(&args))
+        {
+            counting_sort_finish(values, k, counts, key + 1, range, minimum);
+            free(counts);
+            return;
+        }
+    }
+    free(counts);
+}
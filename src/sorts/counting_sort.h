@@ -0,0 +1,10 @@
+#ifndef COUNTING_SORT_H
+#define COUNTING_SORT_H
+
+#include "sorts.h"
+
+void counting_sort(struct SortFunctionArgs args);
+// Whether a counting table for range keys is small enough next to an array of count values
+bool counting_sort_fits(size_t range, size_t count);
+
+#endif // !COUNTING_SORT_H
@@ -0,0 +1,177 @@
+#include "cpu_dispatch.h"
+#include "sorts.h"
+#include <stdio.h>
+
+// Kernels are cloned per instruction set with target attributes, which only GCC and Clang on x86 have. Everywhere
+// else the scalar build is the only level
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define CPU_DISPATCH_X86
+#define KERNEL_BODY static inline __attribute__((always_inline))
+#else
+#define KERNEL_BODY static inline
+#endif
+
+// Pairs the order scan counts in key wide counters before adding them up, few enough that 16-bit ones can't wrap
+#define ORDER_SCAN_CHUNK 32768
+// Pairs the sortedness check compares between looking for an early exit
+#define SORTED_SCAN_BLOCK 64
+
+const char *const cpuLevelNames[] = {"scalar", "sse4.2", "avx2", "avx512"};
+
+// The bodies are inlined into one function per level, each compiled for the instruction set of its level
+
+KERNEL_BODY struct OrderScan scan_order_body(const SortValueType *values, size_t count)
+{
+    struct OrderScan scan = {0, 0};
+    for (size_t start = 0; start + 1 < count; start += ORDER_SCAN_CHUNK)
+    {
+        size_t end = start + ORDER_SCAN_CHUNK < count - 1 ? start + ORDER_SCAN_CHUNK : count - 1;
+        // Counters as wide as the keys keep the compares and the sums in the same vector lanes
+        SortValueType descents = 0;
+        SortValueType equals = 0;
+        for (size_t i = start; i < end; i++)
+        {
+            descents = (SortValueType)(descents + (values[i] > values[i + 1]));
+            equals = (SortValueType)(equals + (values[i] == values[i + 1]));
+        }
+        scan.descents += descents;
+        scan.equals += equals;
+    }
+    return scan;
+}
+
+KERNEL_BODY size_t ordered_prefix_body(const SortValueType *values, size_t count)
+{
+    // Fixed size blocks keep the inner loop free of an early exit so it vectorizes, only a block with a descent in
+    // it is walked pair by pair
+    for (size_t start = 0; start + 1 < count; start += SORTED_SCAN_BLOCK)
+    {
+        size_t end = start + SORTED_SCAN_BLOCK < count - 1 ? start + SORTED_SCAN_BLOCK : count - 1;
+        SortValueType descents = 0;
+        for (size_t i = start; i < end; i++)
+        {
+            descents |= (SortValueType)(values[i] > values[i + 1]);
+        }
+        if (descents != 0)
+        {
+            size_t i = start;
+            while (values[i] <= values[i + 1])
+            {
+                i++;
+            }
+            return i;
+        }
+    }
+    return count > 0 ? count - 1 : 0;
+}
+
+KERNEL_BODY void radix_histograms_body(const SortValueType *values, size_t count,
+                                       size_t (*histograms)[RADIX_BUCKETS])
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        SortValueType value = values[i];
+        for (size_t pass = 0; pass < RADIX_PASSES; pass++)
+        {
+            histograms[pass][(value >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1)]++;
+        }
+    }
+}
+
+#define DEFINE_SORT_KERNELS(suffix, attributes)                                                                    \
+    attributes static struct OrderScan scan_order_##suffix(const SortValueType *values, size_t count)             \
+    {                                                                                                              \
+        return scan_order_body(values, count);                                                                     \
+    }                                                                                                              \
+    attributes static size_t ordered_prefix_##suffix(const SortValueType *values, size_t count)                    \
+    {                                                                                                              \
+        return ordered_prefix_body(values, count);                                                                 \
+    }                                                                                                              \
+    attributes static void radix_histograms_##suffix(const SortValueType *values, size_t count,                   \
+                                                     size_t (*histograms)[RADIX_BUCKETS])                          \
+    {                                                                                                              \
+        radix_histograms_body(values, count, histograms);                                                          \
+    }
+
+DEFINE_SORT_KERNELS(scalar, )
+#ifdef CPU_DISPATCH_X86
+DEFINE_SORT_KERNELS(sse42, __attribute__((target("sse4.2"))))
+DEFINE_SORT_KERNELS(avx2, __attribute__((target("avx2"))))
+DEFINE_SORT_KERNELS(avx512, __attribute__((target("avx512f,avx512bw"))))
+#endif
+
+static const struct SortKernels kernelTables[NumCpuLevels] = {
+    {CpuLevelScalar, scan_order_scalar, ordered_prefix_scalar, radix_histograms_scalar},
+#ifdef CPU_DISPATCH_X86
+    {CpuLevelSse42, scan_order_sse42, ordered_prefix_sse42, radix_histograms_sse42},
+    {CpuLevelAvx2, scan_order_avx2, ordered_prefix_avx2, radix_histograms_avx2},
+    {CpuLevelAvx512, scan_order_avx512, ordered_prefix_avx512, radix_histograms_avx512},
+#endif
+};
+
+_Atomic(const struct SortKernels *) sortKernels = &kernelTables[CpuLevelScalar];
+
+static enum CpuLevel detectedLevel = CpuLevelScalar;
+
+void cpu_dispatch_init(void)
+{
+#ifdef CPU_DISPATCH_X86
+    // The checks cover the OS saving the wider registers too, not only the CPU having them
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+        detectedLevel = CpuLevelAvx512;
+    else if (__builtin_cpu_supports("avx2"))
+        detectedLevel = CpuLevelAvx2;
+    else if (__builtin_cpu_supports("sse4.2"))
+        detectedLevel = CpuLevelSse42;
+    else
+        detectedLevel = CpuLevelScalar;
+#endif
+    cpu_dispatch_set_level(detectedLevel);
+}
+
+enum CpuLevel cpu_detected_level(void)
+{
+    return detectedLevel;
+}
+
+enum CpuLevel cpu_dispatch_set_level(enum CpuLevel level)
+{
+    if (level > detectedLevel)
+        level = detectedLevel;
+    atomic_store_explicit(&sortKernels, &kernelTables[level], memory_order_relaxed);
+    return level;
+}
+
+enum CpuLevel cpu_dispatch_level(void)
+{
+    return sort_kernels()->level;
+}
+
+enum CpuLevel cpu_level_from_name(const char *name)
+{
+    for (int level = 0; level < NumCpuLevels; level++)
+    {
+        if (names_match(name, cpuLevelNames[level]))
+            return (enum CpuLevel)level;
+    }
+    return NumCpuLevels;
+}
+
+bool cpu_dispatch_force(const char *name)
+{
+    enum CpuLevel level = cpu_level_from_name(name);
+    if (level == NumCpuLevels)
+    {
+        fprintf(stderr, "Unknown instruction set: %s, --isa takes scalar, sse4.2, avx2 or avx512\n", name);
+        return false;
+    }
+    if (level > detectedLevel)
+    {
+        fprintf(stderr, "--isa %s isn't supported here, this CPU and build run up to %s\n", cpuLevelNames[level],
+                cpuLevelNames[detectedLevel]);
+        return false;
+    }
+    cpu_dispatch_set_level(level);
+    return true;
+}
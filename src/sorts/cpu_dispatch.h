@@ -0,0 +1,73 @@
+#ifndef CPU_DISPATCH_H
+#define CPU_DISPATCH_H
+
+#include "sort_types.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Radix sort digits, one histogram of RADIX_BUCKETS counts per pass
+#define RADIX_BITS 8
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+#define RADIX_PASSES ((sizeof(SortValueType) * 8 + RADIX_BITS - 1) / RADIX_BITS)
+
+// Instruction set tiers kernels are built for, each a superset of the one before
+enum CpuLevel {
+    // Whatever the build targets, SSE2 on x86-64
+    CpuLevelScalar,
+    CpuLevelSse42,
+    CpuLevelAvx2,
+    // AVX-512 F and BW, the byte and word compares 16-bit keys need
+    CpuLevelAvx512,
+    NumCpuLevels,
+};
+
+// Counts of adjacent pairs that are out of order and equal
+struct OrderScan {
+    size_t descents;
+    size_t equals;
+};
+
+/*
+* One build of every kernel family for a CPU level. The families are the inner loops that are worth vectorizing:
+* the order scan of auto sort's sampling, the sortedness check and the histograms of radix sort. Every level
+* compiles the same portable loops for its own instruction set, so the results never depend on the level, only
+* the speed does.
+*/
+struct SortKernels {
+    enum CpuLevel level;
+    struct OrderScan (*scanOrder)(const SortValueType *values, size_t count);
+    // Pairs in order before the first descent, count - 1 when there is none
+    size_t (*orderedPrefix)(const SortValueType *values, size_t count);
+    // Add every value's digit of each pass to histograms[pass], RADIX_PASSES histograms of RADIX_BUCKETS counts
+    void (*radixHistograms)(const SortValueType *values, size_t count, size_t (*histograms)[RADIX_BUCKETS]);
+};
+
+// Kernels every sort calls through, the scalar ones until cpu_dispatch_init binds the best the CPU runs
+extern _Atomic(const struct SortKernels *) sortKernels;
+
+// Short name of each level, as --isa takes it
+extern const char *const cpuLevelNames[];
+
+// Detect the instruction sets of the CPU and bind the kernels of the highest level it supports. Call once at
+// startup, before any sort runs
+void cpu_dispatch_init(void);
+// Highest level both the CPU and this build support
+enum CpuLevel cpu_detected_level(void);
+// Bind the kernels of level, or of the detected level when the CPU lacks it. Returns the level bound. A sort
+// running on another thread picks the new kernels up from its next call into them
+enum CpuLevel cpu_dispatch_set_level(enum CpuLevel level);
+// Level whose kernels are bound
+enum CpuLevel cpu_dispatch_level(void);
+// Look a level up by its name, ignoring case, dashes and underscores. Returns NumCpuLevels when there is none
+enum CpuLevel cpu_level_from_name(const char *name);
+// Bind the kernels of the level named as --isa takes it. Prints why and returns false when there is no such level
+// or the CPU lacks it
+bool cpu_dispatch_force(const char *name);
+
+static inline const struct SortKernels *sort_kernels(void)
+{
+    return atomic_load_explicit(&sortKernels, memory_order_relaxed);
+}
+
+#endif // !CPU_DISPATCH_H
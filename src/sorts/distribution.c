@@ -0,0 +1,272 @@
+#include "distribution.h"
+#include "radix_sort.h"
+#include "random.h"
+#include "parallel/thread_pool.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define DISTRIBUTION_CHUNK 65536
+#define DISTRIBUTION_MIN_VALUES_PER_WORKER (1 << 20)
+
+const char *const distributionNames[] = {"Shuffled",   "Random",     "Sorted",    "Reversed",
+                                         "Nearly Sorted", "Sawtooth", "Organ Pipe", "Few Unique",
+                                         "All Equal",  "Zipf",       "Gaussian",  "Sorted Runs"};
+
+struct DistributionJob {
+    SortValueType *values;
+    size_t count;
+    enum Distribution distribution;
+    const struct DistributionParams *params;
+    uint64_t seed;
+    size_t maxValue;
+    // Bounds of the area under the hat function DistributionZipf draws from, and its squeeze, see zipf_init
+    double zipfAreaFirst;
+    double zipfAreaLast;
+    double zipfSqueeze;
+};
+
+// Key for position out of length positions, spread evenly over [1, maxValue]
+static SortValueType scale_position(size_t position, size_t length, size_t maxValue)
+{
+#ifdef __SIZEOF_INT128__
+    // Billions of 64-bit keys overflow the product in 64 bits
+    __extension__ typedef unsigned __int128 Product;
+    return (SortValueType)(1 + (Product)position * maxValue / length);
+#else
+    if (maxValue == 0 || position <= SIZE_MAX / maxValue)
+        return (SortValueType)(1 + position * maxValue / length);
+    return (SortValueType)(1 + (size_t)((double)position / (double)length * (double)maxValue));
+#endif
+}
+
+// log1p(x) / x and expm1(x) / x, by their series close to 0 where the quotients lose their precision
+static double zipf_log1p_ratio(double x)
+{
+    return fabs(x) > 1e-8 ? log1p(x) / x : 1.0 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x));
+}
+
+static double zipf_expm1_ratio(double x)
+{
+    return fabs(x) > 1e-8 ? expm1(x) / x : 1.0 + x * 0.5 * (1.0 + x / 3.0 * (1.0 + 0.25 * x));
+}
+
+// Hat function 1 / x^exponent the ranks are drawn under, its integral and the inverse of that integral
+static double zipf_hat(double x, double exponent)
+{
+    return exp(-exponent * log(x));
+}
+
+static double zipf_hat_area(double x, double exponent)
+{
+    double logX = log(x);
+    return zipf_expm1_ratio((1.0 - exponent) * logX) * logX;
+}
+
+static double zipf_hat_area_inverse(double area, double exponent)
+{
+    double t = area * (1.0 - exponent);
+    if (t < -1.0)
+        t = -1.0;
+    return exp(zipf_log1p_ratio(t) * area);
+}
+
+/*
+* Rejection-inversion sampling (Hörmann and Derflinger), which draws ranks from [1, maxValue] without a table of
+* their probabilities, so any key width costs the same. A uniform point under the continuous hat is inverted to a
+* rank, which is kept unless it falls outside the rank's share of the area. Almost every draw is kept.
+*/
+static void zipf_init(struct DistributionJob *job)
+{
+    double exponent = job->params->zipfExponent;
+    job->zipfAreaFirst = zipf_hat_area(1.5, exponent) - 1.0;
+    job->zipfAreaLast = zipf_hat_area((double)job->maxValue + 0.5, exponent);
+    job->zipfSqueeze = 2.0 - zipf_hat_area_inverse(zipf_hat_area(2.5, exponent) - zipf_hat(2.0, exponent), exponent);
+}
+
+static SortValueType zipf_value(const struct DistributionJob *job, struct RandomState *random)
+{
+    double exponent = job->params->zipfExponent;
+    for (;;)
+    {
+        double area = job->zipfAreaLast + random_double(random) * (job->zipfAreaFirst - job->zipfAreaLast);
+        double x = zipf_hat_area_inverse(area, exponent);
+        double rank = floor(x + 0.5);
+        if (rank < 1.0)
+            rank = 1.0;
+        else if (rank > (double)job->maxValue)
+            rank = (double)job->maxValue;
+        if (rank - x <= job->zipfSqueeze ||
+            area >= zipf_hat_area(rank + 0.5, exponent) - zipf_hat(rank, exponent))
+        {
+            // maxValue past 2^53 rounds up as a double, the largest rank can't be converted back from it
+            return (SortValueType)(rank < (double)job->maxValue ? (size_t)rank : job->maxValue);
+        }
+    }
+}
+
+static SortValueType gaussian_value(const struct DistributionJob *job, struct RandomState *random)
+{
+    const double pi = 3.14159265358979323846;
+    double u1 = 1.0 - random_double(random);
+    double u2 = random_double(random);
+    double normal = sqrt(-2.0 * log(u1)) * cos(2.0 * pi * u2);
+    double value = (double)(job->maxValue + 1) / 2.0 + normal * (double)job->maxValue / 8.0;
+    if (value < 1.0)
+        value = 1.0;
+    if (value > (double)job->maxValue)
+        value = (double)job->maxValue;
+    return (SortValueType)value;
+}
+
+static void generate_chunk(const struct DistributionJob *job, size_t begin, size_t end, struct RandomState *random)
+{
+    SortValueType *values = job->values;
+    size_t count = job->count;
+    size_t maxValue = job->maxValue;
+    const struct DistributionParams *params = job->params;
+    for (size_t i = begin; i < end; i++)
+    {
+        switch (job->distribution)
+        {
+        case DistributionShuffled:
+            values[i] = (SortValueType)(i % maxValue + 1);
+            break;
+        case DistributionRandom:
+        case DistributionSortedRuns:
+            values[i] = (SortValueType)(1 + random_bounded(random, maxValue));
+            break;
+        case DistributionSorted:
+        case DistributionNearlySorted:
+            values[i] = scale_position(i, count, maxValue);
+            break;
+        case DistributionReversed:
+            values[i] = scale_position(count - 1 - i, count, maxValue);
+            break;
+        case DistributionSawtooth: {
+            size_t tooth = (count + params->teeth - 1) / params->teeth;
+            values[i] = scale_position(i % tooth, tooth, maxValue);
+            break;
+        }
+        case DistributionOrganPipe: {
+            // Even positions on the way up, odd ones on the way down
+            size_t position = i < (count + 1) / 2 ? i * 2 : (count - 1 - i) * 2 + 1;
+            values[i] = scale_position(position, count, maxValue);
+            break;
+        }
+        case DistributionFewUnique:
+            values[i] = scale_position((size_t)random_bounded(random, params->distinct), params->distinct, maxValue);
+            break;
+        case DistributionAllEqual:
+            values[i] = (SortValueType)((maxValue + 1) / 2);
+            break;
+        case DistributionZipf:
+            values[i] = zipf_value(job, random);
+            break;
+        case DistributionGaussian:
+            values[i] = gaussian_value(job, random);
+            break;
+        default:
+            fputs("Error: Distribution is somehow invalid, tell a programmer!\n", stderr);
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+static void generate_worker(void *context, size_t workerIndex, size_t workerCount)
+{
+    const struct DistributionJob *job = (const struct DistributionJob *)context;
+    size_t chunks = (job->count + DISTRIBUTION_CHUNK - 1) / DISTRIBUTION_CHUNK;
+    for (size_t chunk = workerIndex; chunk < chunks; chunk += workerCount)
+    {
+        struct RandomState random;
+        random_seed(&random, job->seed, RandomStreamChunks + chunk);
+        size_t begin = chunk * DISTRIBUTION_CHUNK;
+        size_t end = begin + DISTRIBUTION_CHUNK < job->count ? begin + DISTRIBUTION_CHUNK : job->count;
+        generate_chunk(job, begin, end, &random);
+    }
+}
+
+static void sort_runs_worker(void *context, size_t workerIndex, size_t workerCount)
+{
+    const struct DistributionJob *job = (const struct DistributionJob *)context;
+    size_t runs = job->params->runs;
+    for (size_t run = workerIndex; run < runs; run += workerCount)
+    {
+        size_t begin = job->count * run / runs;
+        size_t end = job->count * (run + 1) / runs;
+        struct SortStats sortStats = {0, 0, 0, 0, 1, NULL, NULL, NULL, NULL};
+        _Atomic bool cancelSort = false;
+        float speed = 0.0f;
+        struct SortFunctionArgs args = {&sortStats, job->values + begin, end - begin, &cancelSort, &speed, NULL};
+        radix_sort(args);
+    }
+}
+
+struct DistributionParams distribution_default_params(size_t count)
+{
+    struct DistributionParams params;
+    params.swaps = count / 64 > 0 ? count / 64 : 1;
+    params.teeth = 8;
+    params.distinct = 8;
+    params.zipfExponent = 1.1;
+    params.runs = 8;
+    return params;
+}
+
+enum Distribution distribution_from_name(const char *name)
+{
+    for (size_t d = 0; d < NumDistributions; d++)
+    {
+        if (names_match(name, distributionNames[d]))
+            return (enum Distribution)d;
+    }
+    return NumDistributions;
+}
+
+void distribution_generate(SortValueType *values, size_t count, enum Distribution distribution,
+                           const struct DistributionParams *params, uint64_t seed, size_t workerCount)
+{
+    if (count == 0)
+        return;
+    struct DistributionParams defaults = distribution_default_params(count);
+    if (params == NULL)
+        params = &defaults;
+    const size_t largest = (SortValueType)~(SortValueType)0;
+    struct DistributionJob job = {values,  count, distribution, params, seed, count < largest ? count : largest,
+                                  0.0,     0.0,   0.0};
+    if (distribution == DistributionZipf)
+        zipf_init(&job);
+    if (workerCount == 0)
+    {
+        workerCount = count / DISTRIBUTION_MIN_VALUES_PER_WORKER;
+        if (workerCount > hardware_thread_count())
+            workerCount = hardware_thread_count();
+    }
+
+    struct ThreadPool pool;
+    thread_pool_init(&pool, workerCount);
+    thread_pool_run(&pool, generate_worker, &job);
+    if (distribution == DistributionSortedRuns)
+        thread_pool_run(&pool, sort_runs_worker, &job);
+    thread_pool_free(&pool);
+
+    // The remaining steps are inherently sequential but touch little, or are a shuffle
+    struct RandomState random;
+    random_seed(&random, seed, RandomStreamGenerator);
+    if (distribution == DistributionShuffled)
+    {
+        shuffle_with_random(values, count, NULL, &random);
+    }
+    else if (distribution == DistributionNearlySorted)
+    {
+        for (size_t s = 0; s < params->swaps; s++)
+        {
+            size_t i = (size_t)random_bounded(&random, count);
+            size_t j = (size_t)random_bounded(&random, count);
+            SortValueType t = values[i];
+            values[i] = values[j];
+            values[j] = t;
+        }
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef DISTRIBUTION_H
+#define DISTRIBUTION_H
+
+#include "sorts.h"
+
+// Shape parameters, see distribution_default_params for what each one does
+struct DistributionParams {
+    // Random swaps applied to sorted input for DistributionNearlySorted
+    size_t swaps;
+    // Number of ascending ramps for DistributionSawtooth
+    size_t teeth;
+    // Number of distinct values for DistributionFewUnique
+    size_t distinct;
+    // Skew of DistributionZipf, probability of rank r is proportional to 1 / r^exponent
+    double zipfExponent;
+    // Number of sorted runs appended together for DistributionSortedRuns
+    size_t runs;
+};
+
+extern const char *const distributionNames[];
+
+// Parameters scaled to count
+struct DistributionParams distribution_default_params(size_t count);
+// Look a distribution up by its name, ignoring case. Returns NumDistributions when there is none
+enum Distribution distribution_from_name(const char *name);
+/*
+* Fill values with keys in [1, min(count, largest SortValueType)] following distribution. Work is split into
+* fixed chunks, each with a random stream derived from seed and its index, so the result only depends on the
+* seed and never on workerCount (0 picks one from the size).
+*/
+void distribution_generate(SortValueType *values, size_t count, enum Distribution distribution,
+                           const struct DistributionParams *params, uint64_t seed, size_t workerCount);
+
+#endif // !DISTRIBUTION_H
@@ -1,13 +1,18 @@
 #include "heap_sort.h"
 
-#define HEAP_SORT_SLEEP sleep_microseconds((uint64_t)(*args->speed * 50000.0f));
+#define HEAP_SORT_SLEEP sort_delay(args, 50000.0f);
 
-static void heapify(struct SortFunctionArgs* args, SortValueType root, int n) {
-    if (atomic_load(args->cancelSort))
+static void heapify(struct SortFunctionArgs* args, size_t root, size_t n) {
+    if (sort_checkpoint(args))
         return;
-    int largest = root; // Initialize largest as root
-    int l = 2 * root + 1; // left = 2*i + 1
-    int r = 2 * root + 2; // right = 2*i + 2
+    size_t largest = root; // Initialize largest as root
+    size_t l = 2 * root + 1; // left = 2*i + 1
+    size_t r = 2 * root + 2; // right = 2*i + 2
+
+    if (l < n)
+        track_read(args->sortStats, &args->values[l]);
+    if (r < n)
+        track_read(args->sortStats, &args->values[r]);
 
     // If left child is larger than root
     if (l < n && args->values[l] > args->values[largest])
@@ -28,28 +33,33 @@ static void heapify(struct SortFunctionArgs* args, SortValueType root, int n) {
 }
 
 static void impl_heap_sort(struct SortFunctionArgs* args) {
-    int n = args->count;
+    size_t n = args->count;
+    if (n < 2)
+        return;
 
     // Build max heap
-    for (int i = n / 2 - 1; i >= 0; i--) {
-        heapify(args, i, n); 
-        if (atomic_load(args->cancelSort))
-                return;
+    trace_begin("heap build");
+    for (size_t i = n / 2; i-- > 0;) {
+        heapify(args, i, n);
+        if (sort_checkpoint(args))
+                break;
     }
+    trace_end("heap build");
+    if (sort_phase_end(args))
+        return;
 
     // One by one extract an element from heap
-    for (int i = n - 1; i > 0; i--) {
+    trace_begin("heap extract");
+    for (size_t i = n - 1; i > 0 && !sort_checkpoint(args); i--) {
         // Move current root to end
         swap(args->sortStats, &args->values[0], &args->values[i]);
-        if (atomic_load(args->cancelSort))
-                return;
         HEAP_SORT_SLEEP
 
-        // Heapify again
+        // Heapify again, traced only as part of the extract phase since there is one per element
         heapify(args, 0, i);
-        if (atomic_load(args->cancelSort))
-            return;
+        sort_phase_end(args);
     }
+    trace_end("heap extract");
 }
 
 void heap_sort(struct SortFunctionArgs args) {
@@ -0,0 +1,142 @@
+#include "heatmap.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Counters per cache line, shards are padded to a whole number of lines
+#define HEATMAP_LINE_COUNTERS (64 / sizeof(uint32_t))
+// Recent activity below this many accesses fades out instead of being scaled up to full heat
+#define HEATMAP_MIN_PEAK 4.0f
+
+thread_local unsigned heatmapShard = 0;
+thread_local unsigned heatmapShardRun = 0;
+// Runs are numbered from 1, so a thread that never tracked anything has a stale run of 0
+static _Atomic unsigned nextRun = 1;
+
+/*
+* Threads get the shards of a run in the order they first touch the array. Parallel sorts start fresh pool threads
+* every run, handing out per run keeps those from piling onto a shard some earlier thread still writes.
+*/
+unsigned heatmap_assign_shard(struct AccessHeatmap *heatmap)
+{
+    unsigned shard = atomic_fetch_add(&heatmap->nextShard, 1);
+    heatmapShard = shard < HEATMAP_SHARDS - 1 ? shard : HEATMAP_SHARDS - 1;
+    heatmapShardRun = heatmap->run;
+    return heatmapShard;
+}
+
+void heatmap_init(struct AccessHeatmap *heatmap, const SortValueType *values, size_t count)
+{
+    unsigned shift = 0;
+    while ((count >> shift) > HEATMAP_MAX_BINS)
+    {
+        shift++;
+    }
+    size_t bins = count > 0 ? ((count - 1) >> shift) + 1 : 0;
+    size_t stride = (bins + HEATMAP_LINE_COUNTERS - 1) / HEATMAP_LINE_COUNTERS * HEATMAP_LINE_COUNTERS;
+    heatmap->values = values;
+    heatmap->count = count;
+    heatmap->bins = bins;
+    heatmap->shift = shift;
+    heatmap->stride = stride;
+    heatmap->reads = calloc(HEATMAP_SHARDS * stride + 1, sizeof(_Atomic uint32_t));
+    heatmap->writes = calloc(HEATMAP_SHARDS * stride + 1, sizeof(_Atomic uint32_t));
+    heatmap->seenReads = calloc(bins + 1, sizeof(uint32_t));
+    heatmap->seenWrites = calloc(bins + 1, sizeof(uint32_t));
+    heatmap->totalReads = calloc(bins + 1, sizeof(uint64_t));
+    heatmap->totalWrites = calloc(bins + 1, sizeof(uint64_t));
+    heatmap->recent = calloc(bins + 1, sizeof(float));
+    if (heatmap->reads == NULL || heatmap->writes == NULL || heatmap->seenReads == NULL ||
+        heatmap->seenWrites == NULL || heatmap->totalReads == NULL || heatmap->totalWrites == NULL ||
+        heatmap->recent == NULL)
+    {
+        fputs("Failed to allocate memory for access heatmap\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+    heatmap->run = atomic_fetch_add(&nextRun, 1);
+    atomic_store(&heatmap->nextShard, 0);
+    heatmap->peakRecent = HEATMAP_MIN_PEAK;
+    heatmap->peakTotal = 0;
+}
+
+void heatmap_free(struct AccessHeatmap *heatmap)
+{
+    free(heatmap->reads);
+    free(heatmap->writes);
+    free(heatmap->seenReads);
+    free(heatmap->seenWrites);
+    free(heatmap->totalReads);
+    free(heatmap->totalWrites);
+    free(heatmap->recent);
+    memset(heatmap, 0, sizeof(*heatmap));
+}
+
+void heatmap_reset(struct AccessHeatmap *heatmap)
+{
+    for (size_t i = 0; i < HEATMAP_SHARDS * heatmap->stride; i++)
+    {
+        atomic_store_explicit(&heatmap->reads[i], 0, memory_order_relaxed);
+        atomic_store_explicit(&heatmap->writes[i], 0, memory_order_relaxed);
+    }
+    memset(heatmap->seenReads, 0, heatmap->bins * sizeof(uint32_t));
+    memset(heatmap->seenWrites, 0, heatmap->bins * sizeof(uint32_t));
+    memset(heatmap->totalReads, 0, heatmap->bins * sizeof(uint64_t));
+    memset(heatmap->totalWrites, 0, heatmap->bins * sizeof(uint64_t));
+    memset(heatmap->recent, 0, heatmap->bins * sizeof(float));
+    heatmap->run = atomic_fetch_add(&nextRun, 1);
+    atomic_store(&heatmap->nextShard, 0);
+    heatmap->peakRecent = HEATMAP_MIN_PEAK;
+    heatmap->peakTotal = 0;
+}
+
+void heatmap_merge(struct AccessHeatmap *heatmap, float decay)
+{
+    float peakRecent = HEATMAP_MIN_PEAK;
+    uint64_t peakTotal = 0;
+    for (size_t bin = 0; bin < heatmap->bins; bin++)
+    {
+        // Shard counters only grow, so the change since the last merge is the difference of the sums, which stays
+        // right across a wrap of the 32-bit counters as long as a frame doesn't see four billion accesses
+        uint32_t reads = 0;
+        uint32_t writes = 0;
+        for (size_t shard = 0; shard < HEATMAP_SHARDS; shard++)
+        {
+            reads += atomic_load_explicit(&heatmap->reads[shard * heatmap->stride + bin], memory_order_relaxed);
+            writes += atomic_load_explicit(&heatmap->writes[shard * heatmap->stride + bin], memory_order_relaxed);
+        }
+        uint32_t newReads = reads - heatmap->seenReads[bin];
+        uint32_t newWrites = writes - heatmap->seenWrites[bin];
+        heatmap->seenReads[bin] = reads;
+        heatmap->seenWrites[bin] = writes;
+        heatmap->totalReads[bin] += newReads;
+        heatmap->totalWrites[bin] += newWrites;
+        // Writes dirty the line and cost more than reads, so they weigh double
+        heatmap->recent[bin] = heatmap->recent[bin] * decay + (float)newReads + 2.0f * (float)newWrites;
+        uint64_t total = heatmap->totalReads[bin] + heatmap->totalWrites[bin];
+        if (heatmap->recent[bin] > peakRecent)
+            peakRecent = heatmap->recent[bin];
+        if (total > peakTotal)
+            peakTotal = total;
+    }
+    heatmap->peakRecent = peakRecent;
+    heatmap->peakTotal = peakTotal;
+}
+
+float heatmap_recent(const struct AccessHeatmap *heatmap, size_t index)
+{
+    size_t bin = index >> heatmap->shift;
+    if (bin >= heatmap->bins)
+        return 0.0f;
+    return heatmap->recent[bin] / heatmap->peakRecent;
+}
+
+float heatmap_total(const struct AccessHeatmap *heatmap, size_t index)
+{
+    size_t bin = index >> heatmap->shift;
+    if (bin >= heatmap->bins || heatmap->peakTotal == 0)
+        return 0.0f;
+    // Totals span orders of magnitude between the hot and cold ends, a log scale keeps both visible
+    uint64_t total = heatmap->totalReads[bin] + heatmap->totalWrites[bin];
+    return (float)(log1p((double)total) / log1p((double)heatmap->peakTotal));
+}
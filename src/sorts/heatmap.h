@@ -0,0 +1,77 @@
+#ifndef HEATMAP_H
+#define HEATMAP_H
+
+#include "sort_types.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <threads.h>
+
+// Threads touching the array count into this many separate sets of counters
+#define HEATMAP_SHARDS 8
+// Neighbouring indices share a bin once the array has more values than this, nothing finer can be drawn anyway
+#define HEATMAP_MAX_BINS 4096
+
+/*
+* Per index read and write counts of the array being sorted, for colouring the visualisation by how hard each part
+* of it is being hit. Shards are handed out afresh for every run: the first threads to track into it get one each
+* and bump its counters with a plain load and store, so tracking an access costs no more than an uncontended
+* increment. Any further threads share the last shard and increment it atomically. Once per frame the drawing
+* thread sums the shards into running totals and a recent activity value that decays over time.
+*/
+struct AccessHeatmap {
+    const SortValueType *values;
+    size_t count;
+    size_t bins;
+    // Indices are shifted right by this to get their bin
+    unsigned shift;
+    // Counters of shard s start at s * stride, which keeps shards on separate cache lines
+    size_t stride;
+    _Atomic uint32_t *reads;
+    _Atomic uint32_t *writes;
+    // Run the shards are handed out for, unique across heatmaps, and the next shard to hand out in it
+    unsigned run;
+    _Atomic unsigned nextShard;
+    // Owned by the merging thread: shard sums seen at the last merge, totals since the reset and recent activity
+    uint32_t *seenReads;
+    uint32_t *seenWrites;
+    uint64_t *totalReads;
+    uint64_t *totalWrites;
+    float *recent;
+    // Largest recent value and total of any bin at the last merge, for scaling colours
+    float peakRecent;
+    uint64_t peakTotal;
+};
+
+// Shard of the calling thread and the run it was handed out for, on the thread's first tracked access of a run
+extern thread_local unsigned heatmapShard;
+extern thread_local unsigned heatmapShardRun;
+unsigned heatmap_assign_shard(struct AccessHeatmap *heatmap);
+
+void heatmap_init(struct AccessHeatmap *heatmap, const SortValueType *values, size_t count);
+void heatmap_free(struct AccessHeatmap *heatmap);
+// Zero every counter and start handing out shards for a new run, only while no thread is tracking into it
+void heatmap_reset(struct AccessHeatmap *heatmap);
+// Fold the counts since the last merge into the totals and decay recent activity by decay, from one thread only
+void heatmap_merge(struct AccessHeatmap *heatmap, float decay);
+// Recent and total activity of the bin holding index, both scaled to [0, 1]
+float heatmap_recent(const struct AccessHeatmap *heatmap, size_t index);
+float heatmap_total(const struct AccessHeatmap *heatmap, size_t index);
+
+// Count an access to address, which is ignored when it isn't in the tracked array such as in a scratch buffer
+static inline void heatmap_touch(struct AccessHeatmap *heatmap, const SortValueType *address, bool write)
+{
+    size_t index = (size_t)((uintptr_t)address - (uintptr_t)heatmap->values) / sizeof(SortValueType);
+    if (index >= heatmap->count)
+        return;
+    unsigned shard = heatmapShardRun == heatmap->run ? heatmapShard : heatmap_assign_shard(heatmap);
+    _Atomic uint32_t *counters = write ? heatmap->writes : heatmap->reads;
+    _Atomic uint32_t *counter = &counters[shard * heatmap->stride + (index >> heatmap->shift)];
+    // Only this thread writes an exclusive shard, so there is no read-modify-write to make atomic
+    if (shard < HEATMAP_SHARDS - 1)
+        atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + 1, memory_order_relaxed);
+    else
+        atomic_fetch_add_explicit(counter, 1, memory_order_relaxed);
+}
+
+#endif // !HEATMAP_H
@@ -1,6 +1,6 @@
 #include "insertion_sort.h"
 
-#define INSERTION_SORT_SLEEP sleep_microseconds((uint64_t)(*args.speed * 1000.0f));
+#define INSERTION_SORT_SLEEP sort_delay(&args, 1000.0f);
 
 void insertion_sort(struct SortFunctionArgs args)
 {
@@ -11,20 +11,30 @@ void insertion_sort(struct SortFunctionArgs args)
     for (size_t i = 1; i < count; i++)
     {
         key = values[i];
+        track_read(sortStats, &values[i]);
         sortStats->arrayAccesses++;
         size_t j = i;
         while (j > 0 && values[j - 1] > key)
         {
             sortStats->comparisons++;
+            track_read(sortStats, &values[j - 1]);
             values[j] = values[j - 1];
+            track_write(sortStats, &values[j]);
             sortStats->arrayWrites++;
             sortStats->swaps++;
             j--;
             INSERTION_SORT_SLEEP
-            if (atomic_load(args.cancelSort))
+            if (sort_checkpoint(&args))
+            {
+                // The key being inserted fills the gap it has reached, so a cancel keeps every key
+                values[j] = key;
                 return;
+            }
         }
         values[j] = key;
+        track_write(sortStats, &values[j]);
         sortStats->arrayWrites++;
+        if (sort_phase_end(&args))
+            return;
     }
 }
\ No newline at end of file
@@ -0,0 +1,128 @@
+#include "intro_sort.h"
+#include "partial_sort.h"
+
+#define INTRO_SORT_SLEEP sort_delay(args, 50000.0f);
+// Ranges this small are finished with insertion sort
+#define INTRO_SORT_INSERTION_THRESHOLD 16
+
+static void intro_insertion_sort(struct SortFunctionArgs *args, size_t low, size_t high)
+{
+    struct SortStats *sortStats = args->sortStats;
+    SortValueType *values = args->values;
+    for (size_t i = low + 1; i <= high; i++)
+    {
+        SortValueType key = values[i];
+        size_t j = i;
+        while (j > low && values[j - 1] > key)
+        {
+            sortStats->comparisons++;
+            track_read(sortStats, &values[j - 1]);
+            values[j] = values[j - 1];
+            track_write(sortStats, &values[j]);
+            sortStats->arrayWrites++;
+            j--;
+        }
+        values[j] = key;
+        track_write(sortStats, &values[j]);
+        sortStats->comparisons++;
+        sortStats->arrayWrites++;
+        INTRO_SORT_SLEEP
+        if (sort_checkpoint(args))
+            return;
+    }
+}
+
+// Order values[a] <= values[b]
+static void intro_sort_two(struct SortFunctionArgs *args, size_t a, size_t b)
+{
+    args->sortStats->comparisons++;
+    if (args->values[b] < args->values[a])
+        swap(args->sortStats, &args->values[a], &args->values[b]);
+}
+
+// Hoare partition around the median of the first, middle and last values, returns the last index of the left side
+static size_t intro_partition(struct SortFunctionArgs *args, size_t low, size_t high)
+{
+    struct SortStats *sortStats = args->sortStats;
+    SortValueType *values = args->values;
+    size_t mid = low + (high - low) / 2;
+    intro_sort_two(args, low, mid);
+    intro_sort_two(args, mid, high);
+    intro_sort_two(args, low, mid);
+    SortValueType pivot = values[mid];
+    size_t i = low;
+    size_t j = high;
+    for (;;)
+    {
+        while (values[i] < pivot)
+        {
+            track_read(sortStats, &values[i]);
+            sortStats->comparisons++;
+            i++;
+        }
+        while (values[j] > pivot)
+        {
+            track_read(sortStats, &values[j]);
+            sortStats->comparisons++;
+            j--;
+        }
+        sortStats->comparisons += 2;
+        sortStats->arrayAccesses += 2;
+        if (i >= j)
+            return j;
+        swap(sortStats, &values[i], &values[j]);
+        INTRO_SORT_SLEEP
+        if (sort_checkpoint(args))
+            return j;
+        i++;
+        j--;
+    }
+}
+
+/*
+* Quicksort with median of three pivots that stops recursing into ranges once they are small or the recursion
+* is deeper than 2 log2(n), finishing them with insertion sort and heap sort respectively. The larger side is
+* looped on rather than recursed into so the stack stays O(log n).
+*/
+static void intro_sort_impl(struct SortFunctionArgs *args, size_t low, size_t high, size_t depth)
+{
+    while (high > low && high - low >= INTRO_SORT_INSERTION_THRESHOLD)
+    {
+        if (sort_checkpoint(args))
+            return;
+        if (depth-- == 0)
+        {
+            size_t size = high - low + 1;
+            bounded_heap_select(args, low, high + 1, size);
+            bounded_heap_sort(args, low, size);
+            return;
+        }
+        size_t split = intro_partition(args, low, high);
+        if (sort_phase_end(args))
+            return;
+        if (split - low < high - split)
+        {
+            intro_sort_impl(args, low, split, depth);
+            low = split + 1;
+        }
+        else
+        {
+            intro_sort_impl(args, split + 1, high, depth);
+            high = split;
+        }
+    }
+    if (high > low && !sort_checkpoint(args))
+        intro_insertion_sort(args, low, high);
+}
+
+void intro_sort(struct SortFunctionArgs args)
+{
+    if (args.count < 2)
+        return;
+    size_t depth = 0;
+    for (size_t n = args.count; n > 1; n >>= 1)
+    {
+        depth += 2;
+    }
+    intro_sort_impl(&args, 0, args.count - 1, depth);
+}
@@ -0,0 +1,8 @@
+#ifndef INTRO_SORT_H
+#define INTRO_SORT_H
+
+#include "sorts.h"
+
+void intro_sort(struct SortFunctionArgs args);
+
+#endif // !INTRO_SORT_H
@@ -0,0 +1,122 @@
+#include "kway_merge.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define KWAY_MERGE_SORT_SLEEP sort_delay(args, 10000.0f);
+// Slices merged at once by the visual sort
+#define KWAY_MERGE_SORT_WAYS 8
+
+void kway_merger_init(struct KWayMerger *merger, const struct MergeSource *sources, size_t k,
+                      struct SortStats *sortStats)
+{
+    merger->sources = sources;
+    merger->positions = calloc(k > 0 ? k : 1, sizeof(size_t));
+    if (merger->positions == NULL)
+    {
+        fputs("Failed to allocate memory for k-way merge\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+    loser_tree_init(&merger->tree, k, sortStats);
+    for (size_t i = 0; i < k; i++)
+    {
+        // Empty sources start out as sentinels
+        merger->tree.exhausted[i] = sources[i].count == 0;
+        if (sources[i].count > 0)
+            merger->tree.keys[i] = sources[i].values[0];
+    }
+    loser_tree_build(&merger->tree);
+}
+
+void kway_merger_free(struct KWayMerger *merger)
+{
+    loser_tree_free(&merger->tree);
+    free(merger->positions);
+    merger->positions = NULL;
+}
+
+bool kway_merger_next(struct KWayMerger *merger, SortValueType *value)
+{
+    struct LoserTree *tree = &merger->tree;
+    if (loser_tree_empty(tree))
+        return false;
+    size_t winner = loser_tree_winner(tree);
+    *value = tree->keys[winner];
+    size_t position = ++merger->positions[winner];
+    if (position < merger->sources[winner].count)
+        tree->keys[winner] = merger->sources[winner].values[position];
+    else
+        tree->exhausted[winner] = true;
+    loser_tree_replay(tree, winner);
+    return true;
+}
+
+size_t kway_merge(const struct MergeSource *sources, size_t k, SortValueType *output, struct SortStats *sortStats)
+{
+    struct KWayMerger merger;
+    kway_merger_init(&merger, sources, k, sortStats);
+    size_t written = 0;
+    while (kway_merger_next(&merger, &output[written]))
+    {
+        written++;
+    }
+    kway_merger_free(&merger);
+    if (sortStats)
+    {
+        sortStats->arrayAccesses += written;
+        sortStats->arrayWrites += written;
+    }
+    return written;
+}
+
+static void kway_merge_sort_impl(struct SortFunctionArgs *args, SortValueType *scratch, size_t low, size_t high)
+{
+    size_t count = high - low;
+    if (count < 2 || sort_checkpoint(args))
+        return;
+    size_t ways = count < KWAY_MERGE_SORT_WAYS ? count : KWAY_MERGE_SORT_WAYS;
+    struct MergeSource sources[KWAY_MERGE_SORT_WAYS];
+    for (size_t i = 0; i < ways; i++)
+    {
+        size_t begin = low + count * i / ways;
+        size_t end = low + count * (i + 1) / ways;
+        kway_merge_sort_impl(args, scratch, begin, end);
+        sources[i].values = scratch + begin;
+        sources[i].count = end - begin;
+    }
+    if (sort_checkpoint(args))
+        return;
+    // The slices are merged out of a copy so every write lands in the visible array as it happens
+    memcpy(scratch + low, args->values + low, count * sizeof(SortValueType));
+    args->sortStats->arrayAccesses += count;
+    struct KWayMerger merger;
+    kway_merger_init(&merger, sources, ways, args->sortStats);
+    for (size_t k = low; kway_merger_next(&merger, &args->values[k]); k++)
+    {
+        track_write(args->sortStats, &args->values[k]);
+        args->sortStats->arrayWrites++;
+        KWAY_MERGE_SORT_SLEEP
+        if (sort_checkpoint(args))
+        {
+            // The copy still holds every key of the slice, put it back rather than leave it half merged
+            memcpy(args->values + low, scratch + low, count * sizeof(SortValueType));
+            break;
+        }
+    }
+    kway_merger_free(&merger);
+    sort_phase_end(args);
+}
+
+void kway_merge_sort(struct SortFunctionArgs args)
+{
+    if (args.count < 2)
+        return;
+    SortValueType *scratch = malloc(args.count * sizeof(SortValueType));
+    if (scratch == NULL)
+    {
+        fputs("Failed to allocate memory for k-way merge sort\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+    kway_merge_sort_impl(&args, scratch, 0, args.count);
+    free(scratch);
+}
@@ -0,0 +1,33 @@
+#ifndef KWAY_MERGE_H
+#define KWAY_MERGE_H
+
+#include "loser_tree.h"
+#include "sorts.h"
+
+// A sorted input to merge, an array in memory or the values of a mapped dataset
+struct MergeSource {
+    const SortValueType *values;
+    size_t count;
+};
+
+// Merges sources one value at a time, finding each next value with log2(k) comparisons in a loser tree
+struct KWayMerger {
+    struct LoserTree tree;
+    const struct MergeSource *sources;
+    size_t *positions;
+};
+
+// Comparisons are added to sortStats when it is not NULL, sources must outlive the merger
+void kway_merger_init(struct KWayMerger *merger, const struct MergeSource *sources, size_t k,
+                      struct SortStats *sortStats);
+void kway_merger_free(struct KWayMerger *merger);
+// Take the smallest remaining value, returns false once every source is used up. Equal values come out in source
+// order
+bool kway_merger_next(struct KWayMerger *merger, SortValueType *value);
+// Merge all k sources into output, which has room for the sum of their counts. Returns how many were written
+size_t kway_merge(const struct MergeSource *sources, size_t k, SortValueType *output, struct SortStats *sortStats);
+
+// Visual k-way merge sort, sorts KWAY_MERGE_SORT_WAYS slices recursively then merges them with a KWayMerger
+void kway_merge_sort(struct SortFunctionArgs args);
+
+#endif // !KWAY_MERGE_H
@@ -0,0 +1,103 @@
+#include "loser_tree.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+void loser_tree_init(struct LoserTree *tree, size_t k, struct SortStats *sortStats)
+{
+    tree->k = k;
+    tree->sortStats = sortStats;
+    tree->losers = malloc((k > 0 ? k : 1) * sizeof(size_t));
+    tree->keys = malloc((k > 0 ? k : 1) * sizeof(SortValueType));
+    tree->exhausted = malloc((k > 0 ? k : 1) * sizeof(bool));
+    if (tree->losers == NULL || tree->keys == NULL || tree->exhausted == NULL)
+    {
+        fputs("Failed to allocate memory for loser tree\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+    // Matches read the key of an exhausted source too and mask the result, so every key starts out written
+    for (size_t i = 0; i < k; i++)
+    {
+        tree->keys[i] = (SortValueType)~(SortValueType)0;
+        tree->exhausted[i] = true;
+    }
+    tree->losers[0] = 0;
+}
+
+void loser_tree_free(struct LoserTree *tree)
+{
+    free(tree->losers);
+    free(tree->keys);
+    free(tree->exhausted);
+    tree->losers = NULL;
+    tree->keys = NULL;
+    tree->exhausted = NULL;
+    tree->k = 0;
+}
+
+// Whether source a wins its match against source b. Evaluated without branches since on random keys the outcome
+// is a coin flip, and comparisons are tallied locally so the hot loop doesn't write through the stats pointer
+static inline bool loser_tree_beats(const struct LoserTree *tree, size_t a, size_t b, size_t *comparisons)
+{
+    bool bothLive = !tree->exhausted[a] & !tree->exhausted[b];
+    *comparisons += bothLive;
+    SortValueType keyA = tree->keys[a];
+    SortValueType keyB = tree->keys[b];
+    bool less = (keyA < keyB) | ((keyA == keyB) & (a < b));
+    return (!tree->exhausted[a] & tree->exhausted[b]) | (bothLive & less);
+}
+
+void loser_tree_build(struct LoserTree *tree)
+{
+    size_t k = tree->k;
+    if (k <= 1)
+    {
+        tree->losers[0] = 0;
+        return;
+    }
+    // Leaves sit at k..2k-1 of an implicit binary tree whose inner nodes are 1..k-1, winners of each inner node
+    // are only needed while building
+    size_t *winners = malloc(k * sizeof(size_t));
+    size_t comparisons = 0;
+    if (winners == NULL)
+    {
+        fputs("Failed to allocate memory for loser tree\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+    for (size_t node = k - 1; node > 0; node--)
+    {
+        size_t left = 2 * node;
+        size_t right = 2 * node + 1;
+        size_t a = left >= k ? left - k : winners[left];
+        size_t b = right >= k ? right - k : winners[right];
+        if (loser_tree_beats(tree, a, b, &comparisons))
+        {
+            winners[node] = a;
+            tree->losers[node] = b;
+        }
+        else
+        {
+            winners[node] = b;
+            tree->losers[node] = a;
+        }
+    }
+    tree->losers[0] = winners[1];
+    free(winners);
+    if (tree->sortStats)
+        tree->sortStats->comparisons += comparisons;
+}
+
+void loser_tree_replay(struct LoserTree *tree, size_t source)
+{
+    size_t winner = source;
+    size_t comparisons = 0;
+    for (size_t node = (source + tree->k) / 2; node > 0; node /= 2)
+    {
+        size_t challenger = tree->losers[node];
+        bool swap = loser_tree_beats(tree, challenger, winner, &comparisons);
+        tree->losers[node] = swap ? winner : challenger;
+        winner = swap ? challenger : winner;
+    }
+    tree->losers[0] = winner;
+    if (tree->sortStats)
+        tree->sortStats->comparisons += comparisons;
+}
@@ -0,0 +1,42 @@
+#ifndef LOSER_TREE_H
+#define LOSER_TREE_H
+
+#include "sorts.h"
+
+/*
+* Tournament tree over k sorted sources that finds the smallest current key in log2(k) comparisons. Each inner
+* node keeps the source that lost the match played there, so replacing the winner only replays the matches on its
+* own path to the root. An exhausted source acts as a sentinel that loses to everything, which lets every key value
+* including the largest one be merged. Ties go to the lower source index, keeping merges stable.
+*/
+struct LoserTree {
+    size_t k;
+    // losers[0] is the overall winner, losers[1..k) the loser of each inner node
+    size_t *losers;
+    // Current key of every source, only meaningful while it is not exhausted. Starts as the largest key
+    SortValueType *keys;
+    bool *exhausted;
+    // Comparisons are counted here when not NULL
+    struct SortStats *sortStats;
+};
+
+void loser_tree_init(struct LoserTree *tree, size_t k, struct SortStats *sortStats);
+void loser_tree_free(struct LoserTree *tree);
+// Play every match, call once keys and exhausted are filled in for all sources
+void loser_tree_build(struct LoserTree *tree);
+// Replay the path of source after its key or exhausted flag changed, it has to be the current winner
+void loser_tree_replay(struct LoserTree *tree, size_t source);
+
+// Source holding the smallest key
+static inline size_t loser_tree_winner(const struct LoserTree *tree)
+{
+    return tree->losers[0];
+}
+
+// Whether every source is exhausted
+static inline bool loser_tree_empty(const struct LoserTree *tree)
+{
+    return tree->k == 0 || tree->exhausted[tree->losers[0]];
+}
+
+#endif // !LOSER_TREE_H
@@ -1,23 +1,39 @@
 #include "merge_sort.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
-#define MERGE_SORT_SLEEP sleep_microseconds((uint64_t)(*args->speed * 10000.0f));
+#define MERGE_SORT_SLEEP sort_delay(args, 10000.0f);
 
 /*
-* This macro is helpful as the merge function uses heap allocated memory. Instead of repeating this large
-* block of code in every place where we need to exit the sort we use this macro.
+* These macros are helpful as the merge function uses heap allocated memory. Instead of repeating this large
+* block of code in every place where we need to exit the sort we use them. A cancel while merging back puts the
+* keys still in the copies after the merged ones, so the array keeps every key.
 */
+#define COPY_SORT_CHECK                                                                                                \
+    if (sort_checkpoint(args))                                                                                         \
+    {                                                                                                                  \
+        trace_end("merge");                                                                                            \
+        free(leftSide);                                                                                                \
+        free(rightSide);                                                                                               \
+        return;                                                                                                        \
+    }
 #define CONTINUE_SORT_CHECK                                                                                            \
-    if (atomic_load(args->cancelSort))                                                                                 \
+    if (sort_checkpoint(args))                                                                                         \
     {                                                                                                                  \
+        memcpy(values + k, leftSide + i, (leftSize - i) * sizeof(SortValueType));                                     \
+        memcpy(values + k + leftSize - i, rightSide + j, (rightSize - j) * sizeof(SortValueType));                     \
+        trace_end("merge");                                                                                            \
         free(leftSide);                                                                                                \
         free(rightSide);                                                                                               \
         return;                                                                                                        \
     }
 
-static void merge(size_t low, size_t mid, size_t high, struct SortFunctionArgs *args)
+void merge_sort_merge(size_t low, size_t mid, size_t high, struct SortFunctionArgs *args)
 {
     struct SortStats *sortStats = args->sortStats;
-    SortValueType *values = args->values;                                                                                                                 \
+    SortValueType *values = args->values;
+    trace_begin("merge");
     // Create temp arrays and copy data to them
     size_t leftSize = mid - low + 1;
     size_t rightSize = high - mid;
@@ -39,14 +55,16 @@ static void merge(size_t low, size_t mid, size_t high, struct SortFunctionArgs *
         sortStats->arrayWrites++;
         sortStats->arrayAccesses++;
         leftSide[i] = values[low + i];
-        CONTINUE_SORT_CHECK
+        track_read(sortStats, &values[low + i]);
+        COPY_SORT_CHECK
     }
     for (size_t j = 0; j < rightSize; j++)
     {
         sortStats->arrayWrites++;
         sortStats->arrayAccesses++;
         rightSide[j] = values[mid + 1 + j];
-        CONTINUE_SORT_CHECK
+        track_read(sortStats, &values[mid + 1 + j]);
+        COPY_SORT_CHECK
     }
     // Merge temp arrays back
     size_t i = 0;
@@ -58,6 +76,7 @@ static void merge(size_t low, size_t mid, size_t high, struct SortFunctionArgs *
         if (leftSide[i] <= rightSide[j])
         {
             values[k] = leftSide[i];
+            track_write(sortStats, &values[k]);
             sortStats->arrayWrites++;
             MERGE_SORT_SLEEP
             CONTINUE_SORT_CHECK
@@ -66,6 +85,7 @@ static void merge(size_t low, size_t mid, size_t high, struct SortFunctionArgs *
         else
         {
             values[k] = rightSide[j];
+            track_write(sortStats, &values[k]);
             sortStats->arrayWrites++;
             MERGE_SORT_SLEEP
             CONTINUE_SORT_CHECK
@@ -78,6 +98,7 @@ static void merge(size_t low, size_t mid, size_t high, struct SortFunctionArgs *
     while (i < leftSize)
     {
         values[k] = leftSide[i];
+        track_write(sortStats, &values[k]);
         sortStats->arrayWrites++;
         MERGE_SORT_SLEEP
         CONTINUE_SORT_CHECK
@@ -87,6 +108,7 @@ static void merge(size_t low, size_t mid, size_t high, struct SortFunctionArgs *
     while (j < rightSize)
     {
         values[k] = rightSide[j];
+        track_write(sortStats, &values[k]);
         sortStats->arrayWrites++;
         MERGE_SORT_SLEEP
         CONTINUE_SORT_CHECK
@@ -95,6 +117,8 @@ static void merge(size_t low, size_t mid, size_t high, struct SortFunctionArgs *
     }
     free(leftSide);
     free(rightSide);
+    trace_end("merge");
+#undef COPY_SORT_CHECK
 #undef CONTINUE_SORT_CHECK
 }
 
@@ -102,12 +126,13 @@ static void merge_sort_impl(size_t low, size_t high, struct SortFunctionArgs *ar
 {
     if (low >= high)
         return;
-    if (atomic_load(args->cancelSort))
+    if (sort_checkpoint(args))
         return;
     size_t mid = low + (high - low) / 2;
     merge_sort_impl(low, mid, args);
     merge_sort_impl(mid + 1, high, args);
-    merge(low, mid, high, args);
+    merge_sort_merge(low, mid, high, args);
+    sort_phase_end(args);
 }
 
 void merge_sort(struct SortFunctionArgs args)
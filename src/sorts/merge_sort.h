@@ -4,5 +4,7 @@
 #include "sorts.h"
 
 void merge_sort(struct SortFunctionArgs args);
+// Merge the sorted ranges [low, mid] and [mid + 1, high] of args->values in place
+void merge_sort_merge(size_t low, size_t mid, size_t high, struct SortFunctionArgs *args);
 
 #endif // !MERGE_SORT_H
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include "natural_merge_sort.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NATURAL_MERGE_SORT_SLEEP sort_delay(args, 10000.0f);
+
+// Merge the sorted runs [low, mid) and [mid, high), buffering only the left run
+static void natural_merge(struct SortFunctionArgs *args, SortValueType *buffer, size_t low, size_t mid, size_t high)
+{
+    struct SortStats *sortStats = args->sortStats;
+    SortValueType *values = args->values;
+    sortStats->comparisons++;
+    sortStats->arrayAccesses += 2;
+    if (values[mid - 1] <= values[mid])
+        return;
+    size_t leftSize = mid - low;
+    for (size_t i = 0; i < leftSize; i++)
+    {
+        buffer[i] = values[low + i];
+    }
+    sortStats->arrayAccesses += leftSize;
+    size_t i = 0;
+    size_t j = mid;
+    size_t k = low;
+    while (i < leftSize)
+    {
+        if (j < high)
+        {
+            sortStats->comparisons++;
+            sortStats->arrayAccesses++;
+        }
+        if (j < high)
+            track_read(sortStats, &values[j]);
+        if (j < high && values[j] < buffer[i])
+            values[k] = values[j++];
+        else
+            values[k] = buffer[i++];
+        track_write(sortStats, &values[k++]);
+        sortStats->arrayWrites++;
+        NATURAL_MERGE_SORT_SLEEP
+        if (sort_checkpoint(args))
+        {
+            // What is left of the right run is still in place, the rest of the left run goes back just before it
+            memcpy(values + k, buffer + i, (leftSize - i) * sizeof(SortValueType));
+            return;
+        }
+    }
+}
+
+/*
+* Run adaptive merge sort: the input is split into its existing ascending runs (descending runs are reversed
+* in place), then neighbouring runs are merged pairwise until one is left. Costs O(n log r) for r runs,
+* so already sorted or reversed input takes a single linear pass.
+*/
+void natural_merge_sort(struct SortFunctionArgs args)
+{
+    struct SortStats *sortStats = args.sortStats;
+    SortValueType *values = args.values;
+    size_t count = args.count;
+    if (count < 2)
+        return;
+    size_t *runs = malloc((count + 1) * sizeof(size_t));
+    SortValueType *buffer = malloc(count * sizeof(SortValueType));
+    if (runs == NULL || buffer == NULL)
+    {
+        fputs("Failed to allocate memory for natural merge sort\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+    size_t runCount = 0;
+    for (size_t i = 0; i < count;)
+    {
+        // Leading equal keys belong to whichever direction the run turns out to have
+        size_t j = i + 1;
+        while (j < count && values[j] == values[j - 1])
+        {
+            j++;
+        }
+        if (j < count && values[j] < values[j - 1])
+        {
+            // Equal keys are interchangeable, so a descending run may include them
+            while (j < count && values[j] <= values[j - 1])
+            {
+                j++;
+            }
+            for (size_t a = i, b = j - 1; a < b; a++, b--)
+            {
+                swap(sortStats, &values[a], &values[b]);
+            }
+        }
+        else
+        {
+            while (j < count && values[j] >= values[j - 1])
+            {
+                j++;
+            }
+        }
+        sortStats->comparisons += j - i;
+        sortStats->arrayAccesses += 2 * (j - i);
+        runs[runCount++] = i;
+        i = j;
+    }
+    runs[runCount] = count;
+
+    while (runCount > 1 && !sort_checkpoint(&args))
+    {
+        size_t merged = 0;
+        for (size_t r = 0; r < runCount; r += 2)
+        {
+            if (r + 1 < runCount)
+            {
+                natural_merge(&args, buffer, runs[r], runs[r + 1], runs[r + 2]);
+                sort_phase_end(&args);
+            }
+            runs[merged++] = runs[r];
+        }
+        runs[merged] = count;
+        runCount = merged;
+    }
+    free(buffer);
+    free(runs);
+}
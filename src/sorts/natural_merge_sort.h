@@ -0,0 +1,8 @@
+#ifndef NATURAL_MERGE_SORT_H
+#define NATURAL_MERGE_SORT_H
+
+#include "sorts.h"
+
+void natural_merge_sort(struct SortFunctionArgs args);
+
+#endif // !NATURAL_MERGE_SORT_H
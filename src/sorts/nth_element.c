@@ -0,0 +1,111 @@
+#include "nth_element.h"
+#include "partial_sort.h"
+#include <math.h>
+
+#define NTH_ELEMENT_SLEEP sort_delay(args, 50000.0f);
+// Ranges larger than this pick their pivot by recursively selecting from a sample (Floyd-Rivest)
+#define NTH_ELEMENT_SAMPLE_THRESHOLD 600
+
+/*
+* Introselect: Floyd-Rivest selection, which narrows the range with a pivot chosen from a recursively selected
+* sample, bounded by a depth limit after which the remaining range falls back to a heap select so that the
+* worst case stays O(n log n).
+*/
+static void floyd_rivest_select(struct SortFunctionArgs *args, size_t left, size_t right, size_t nth, size_t depth)
+{
+    struct SortStats *sortStats = args->sortStats;
+    SortValueType *values = args->values;
+    while (right > left)
+    {
+        if (depth-- == 0)
+        {
+            bounded_heap_select(args, left, right + 1, nth - left + 1);
+            swap(sortStats, &values[left], &values[nth]);
+            return;
+        }
+        if (right - left > NTH_ELEMENT_SAMPLE_THRESHOLD)
+        {
+            double n = (double)(right - left + 1);
+            double i = (double)(nth - left + 1);
+            double z = log(n);
+            double s = 0.5 * exp(2.0 * z / 3.0);
+            double sd = 0.5 * sqrt(z * s * (n - s) / n) * (i < n / 2.0 ? -1.0 : 1.0);
+            double sampleLeft = (double)nth - i * s / n + sd;
+            double sampleRight = (double)nth + (n - i) * s / n + sd;
+            size_t newLeft = sampleLeft > (double)left ? (size_t)sampleLeft : left;
+            size_t newRight = sampleRight < (double)right ? (size_t)sampleRight : right;
+            floyd_rivest_select(args, newLeft, newRight, nth, depth);
+            if (sort_checkpoint(args))
+                return;
+        }
+        // Partition [left, right] around values[nth]
+        SortValueType pivot = values[nth];
+        size_t i = left;
+        size_t j = right;
+        swap(sortStats, &values[left], &values[nth]);
+        sortStats->comparisons++;
+        if (values[right] > pivot)
+            swap(sortStats, &values[right], &values[left]);
+        while (i < j)
+        {
+            swap(sortStats, &values[i], &values[j]);
+            NTH_ELEMENT_SLEEP
+            if (sort_checkpoint(args))
+                return;
+            i++;
+            j--;
+            while (values[i] < pivot)
+            {
+                track_read(sortStats, &values[i]);
+                sortStats->comparisons++;
+                i++;
+            }
+            while (values[j] > pivot)
+            {
+                track_read(sortStats, &values[j]);
+                sortStats->comparisons++;
+                j--;
+            }
+            sortStats->comparisons += 2;
+            sortStats->arrayAccesses += 2;
+        }
+        sortStats->comparisons++;
+        if (values[left] == pivot)
+        {
+            swap(sortStats, &values[left], &values[j]);
+        }
+        else
+        {
+            j++;
+            swap(sortStats, &values[j], &values[right]);
+        }
+        NTH_ELEMENT_SLEEP
+        if (sort_phase_end(args))
+            return;
+        if (j <= nth)
+            left = j + 1;
+        if (nth <= j)
+        {
+            if (j == 0)
+                return;
+            right = j - 1;
+        }
+    }
+}
+
+void nth_element_range(struct SortFunctionArgs *args, size_t left, size_t right, size_t nth)
+{
+    size_t depth = 2;
+    for (size_t n = right - left + 1; n > 1; n >>= 1)
+    {
+        depth += 2;
+    }
+    floyd_rivest_select(args, left, right, nth, depth);
+}
+
+void nth_element(struct SortFunctionArgs args, size_t k)
+{
+    if (args.count < 2 || k >= args.count)
+        return;
+    nth_element_range(&args, 0, args.count - 1, k);
+}
@@ -0,0 +1,13 @@
+#ifndef NTH_ELEMENT_H
+#define NTH_ELEMENT_H
+
+#include "sorts.h"
+
+void nth_element(struct SortFunctionArgs args, size_t k);
+/*
+* Rearrange [left, right] so that values[nth] holds the value it would have if the range were sorted, with
+* nothing larger before it and nothing smaller after it.
+*/
+void nth_element_range(struct SortFunctionArgs *args, size_t left, size_t right, size_t nth);
+
+#endif // !NTH_ELEMENT_H
@@ -0,0 +1,65 @@
+#include "odd_even_sort.h"
+
+#define ODD_EVEN_SORT_DELAY 20000.0f
+#define ODD_EVEN_SORT_MIN_PAIRS_PER_WORKER 16
+
+struct OddEvenSort {
+    struct PhaseRunner runner;
+    size_t quietPhases;
+};
+
+/*
+* Phases alternate between comparing pairs (0,1), (2,3), ... and (1,2), (3,4), ... so the sort is finished
+* once an even and an odd phase in a row made no swaps, and n phases are always enough.
+*/
+static bool odd_even_finished(void *context, size_t phase, size_t phaseSwaps)
+{
+    struct OddEvenSort *sort = (struct OddEvenSort *)context;
+    sort->quietPhases = phaseSwaps > 0 ? 0 : sort->quietPhases + 1;
+    return sort->quietPhases >= 2 || phase + 1 >= sort->runner.args.count;
+}
+
+static void odd_even_worker(void *context, size_t workerIndex, size_t workerCount)
+{
+    struct OddEvenSort *sort = (struct OddEvenSort *)context;
+    struct PhaseRunner *runner = &sort->runner;
+    struct SortStats *sortStats = phase_runner_stats(runner, workerIndex);
+    SortValueType *values = runner->args.values;
+    size_t count = runner->args.count;
+    do
+    {
+        size_t first = runner->phase & 1;
+        size_t pairs = (count - first) / 2;
+        size_t begin = pairs * workerIndex / workerCount;
+        size_t end = pairs * (workerIndex + 1) / workerCount;
+        for (size_t pair = begin; pair < end; pair++)
+        {
+            size_t i = first + pair * 2;
+            track_read(sortStats, &values[i]);
+            track_read(sortStats, &values[i + 1]);
+            if (values[i] > values[i + 1])
+            {
+                swap(sortStats, &values[i], &values[i + 1]);
+            }
+            sortStats->comparisons++;
+        }
+    } while (phase_runner_sync(runner, workerIndex));
+}
+
+void odd_even_sort_parallel(struct SortFunctionArgs args, size_t workerCount, struct ParallelSortProfile *profile)
+{
+    if (args.count < 2)
+        return;
+    if (workerCount == 0)
+        workerCount = phase_worker_count(args.count / 2, ODD_EVEN_SORT_MIN_PAIRS_PER_WORKER);
+    struct OddEvenSort sort;
+    sort.quietPhases = 0;
+    phase_runner_init(&sort.runner, args, workerCount, ODD_EVEN_SORT_DELAY, odd_even_finished, &sort, profile);
+    phase_runner_run(&sort.runner, odd_even_worker, &sort);
+    phase_runner_free(&sort.runner);
+}
+
+void odd_even_sort(struct SortFunctionArgs args)
+{
+    odd_even_sort_parallel(args, 0, NULL);
+}
@@ -0,0 +1,11 @@
+#ifndef ODD_EVEN_SORT_H
+#define ODD_EVEN_SORT_H
+
+#include "sorts.h"
+#include "parallel_phases.h"
+
+void odd_even_sort(struct SortFunctionArgs args);
+// Odd-even transposition sort on an explicit number of workers (0 picks one from the array size)
+void odd_even_sort_parallel(struct SortFunctionArgs args, size_t workerCount, struct ParallelSortProfile *profile);
+
+#endif // !ODD_EVEN_SORT_H
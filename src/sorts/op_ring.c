@@ -0,0 +1,146 @@
+#include "op_ring.h"
+#include "audio/sonify.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// How long a producer waiting for room sleeps before looking at the cancel flag again
+#define OP_RING_WAIT_NANOSECONDS 10000000L
+
+void op_ring_init(struct OpRing *ring)
+{
+    if (mtx_init(&ring->mutex, mtx_plain) != thrd_success || cnd_init(&ring->drained) != thrd_success)
+    {
+        fputs("Failed to initialise operation ring synchronisation\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+    op_ring_reset(ring, NULL, 0, NULL);
+}
+
+void op_ring_free(struct OpRing *ring)
+{
+    cnd_destroy(&ring->drained);
+    mtx_destroy(&ring->mutex);
+}
+
+void op_ring_reset(struct OpRing *ring, const SortValueType *values, size_t count, _Atomic bool *cancelSort)
+{
+    atomic_store(&ring->head, 0);
+    atomic_store(&ring->tail, 0);
+    ring->written = 0;
+    ring->cachedTail = 0;
+    ring->cachedHead = 0;
+    ring->values = values;
+    ring->count = count;
+    ring->cancelSort = cancelSort;
+    ring->marks[0] = SIZE_MAX;
+    ring->marks[1] = SIZE_MAX;
+    ring->tones = NULL;
+    atomic_store(&ring->producerWaiting, false);
+    atomic_store(&ring->resync, false);
+}
+
+void op_ring_publish(struct OpRing *ring)
+{
+    atomic_store_explicit(&ring->head, ring->written, memory_order_release);
+}
+
+bool op_ring_wait(struct OpRing *ring)
+{
+    // The consumer can only make room for records it can see
+    op_ring_publish(ring);
+    ring->cachedTail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (ring->written - ring->cachedTail < OP_RING_CAPACITY)
+        return true;
+    atomic_store(&ring->producerWaiting, true);
+    mtx_lock(&ring->mutex);
+    // Checked again under the lock, a consumer draining in between either saw the flag or moved the tail first
+    while ((ring->cachedTail = atomic_load(&ring->tail)) + OP_RING_CAPACITY == ring->written &&
+           !atomic_load(ring->cancelSort))
+    {
+        struct timespec deadline;
+        timespec_get(&deadline, TIME_UTC);
+        deadline.tv_nsec += OP_RING_WAIT_NANOSECONDS;
+        if (deadline.tv_nsec >= 1000000000L)
+        {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        cnd_timedwait(&ring->drained, &ring->mutex, &deadline);
+    }
+    mtx_unlock(&ring->mutex);
+    atomic_store(&ring->producerWaiting, false);
+    return ring->written - ring->cachedTail < OP_RING_CAPACITY;
+}
+
+void op_ring_resync(struct OpRing *ring)
+{
+    op_ring_publish(ring);
+    atomic_store_explicit(&ring->resync, true, memory_order_release);
+}
+
+size_t op_ring_drain(struct OpRing *ring, SortValueType *shown, size_t budget)
+{
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    if (atomic_exchange_explicit(&ring->resync, false, memory_order_acquire))
+    {
+        // Whatever is left in the ring is older than the array itself
+        memcpy(shown, ring->values, ring->count * sizeof(SortValueType));
+        tail = atomic_load_explicit(&ring->head, memory_order_acquire);
+        ring->cachedHead = tail;
+        ring->marks[0] = SIZE_MAX;
+        ring->marks[1] = SIZE_MAX;
+        atomic_store_explicit(&ring->tail, tail, memory_order_release);
+        budget = 0;
+    }
+    if (ring->cachedHead - tail < budget)
+        ring->cachedHead = atomic_load_explicit(&ring->head, memory_order_acquire);
+    size_t available = ring->cachedHead - tail;
+    size_t applied = available < budget ? available : budget;
+    for (size_t i = 0; i < applied; i++)
+    {
+        const struct SortOp *op = &ring->ops[(tail + i) & (OP_RING_CAPACITY - 1)];
+        switch (op->kind)
+        {
+        case SortOpWrite:
+            shown[op->index] = op->value;
+            ring->marks[0] = op->index;
+            ring->marks[1] = SIZE_MAX;
+            if (ring->tones != NULL)
+                tone_queue_push(ring->tones, op->value, true);
+            break;
+        case SortOpSwap: {
+            SortValueType value = shown[op->index];
+            shown[op->index] = shown[op->other];
+            shown[op->other] = value;
+            ring->marks[0] = op->index;
+            ring->marks[1] = op->other;
+            if (ring->tones != NULL)
+            {
+                tone_queue_push(ring->tones, shown[op->index], true);
+                tone_queue_push(ring->tones, value, true);
+            }
+            break;
+        }
+        default:
+            // Reads come in the pairs that get compared, the last two stay highlighted
+            ring->marks[1] = ring->marks[0];
+            ring->marks[0] = op->index;
+            if (ring->tones != NULL)
+                tone_queue_push(ring->tones, shown[op->index], false);
+            break;
+        }
+    }
+    if (applied > 0)
+    {
+        atomic_store_explicit(&ring->tail, tail + applied, memory_order_seq_cst);
+        if (atomic_load(&ring->producerWaiting))
+        {
+            mtx_lock(&ring->mutex);
+            cnd_signal(&ring->drained);
+            mtx_unlock(&ring->mutex);
+        }
+    }
+    return applied;
+}
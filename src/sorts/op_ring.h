@@ -0,0 +1,104 @@
+#ifndef OP_RING_H
+#define OP_RING_H
+
+#include "sort_types.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <threads.h>
+
+// Records the ring holds, a power of two so positions wrap with a mask
+#define OP_RING_CAPACITY 4096
+// Records written between publications of the head, a power of two
+#define OP_RING_BATCH 64
+
+enum SortOpKind {
+    SortOpRead,
+    SortOpWrite,
+    SortOpSwap,
+};
+
+// One access to the array, indices fit 32 bits because only generated arrays are streamed
+struct SortOp {
+    uint32_t index;
+    // Second index of a swap
+    uint32_t other;
+    // Value written, for writes
+    SortValueType value;
+    uint8_t kind;
+};
+
+/*
+* Single producer, single consumer ring of the accesses a sort makes to the array, so the drawing thread can replay
+* them onto a copy of its own instead of reading an array that is being written under it. The sorting thread fills
+* slots and publishes the head once per batch, the drawing thread drains what it is due each frame and publishes
+* the tail. Head and tail live on separate cache lines and each side keeps a cached copy of the other's index, so
+* neither touches the other's line until it has run out of records or room. A full ring blocks the sort until the
+* drawing thread has made room, which is what paces a streamed sort instead of sleeping between steps.
+*/
+struct OpRing {
+    // Producer side
+    _Atomic size_t head;
+    // Records written, ahead of head by the batch not yet published
+    size_t written;
+    size_t cachedTail;
+    const SortValueType *values;
+    size_t count;
+    _Atomic bool *cancelSort;
+    char producerPadding[64];
+    // Consumer side
+    _Atomic size_t tail;
+    size_t cachedHead;
+    // Indices touched by the last records applied, drawn highlighted
+    size_t marks[2];
+    // Where the values of applied records are queued to be heard as they are drawn, NULL for silence
+    struct ToneQueue *tones;
+    char consumerPadding[64];
+    // Set by a producer waiting for room, so the consumer only signals when someone is waiting
+    _Atomic bool producerWaiting;
+    // Set when a run ends with the array rewritten outside the ring, the consumer copies it whole
+    _Atomic bool resync;
+    mtx_t mutex;
+    cnd_t drained;
+    struct SortOp ops[OP_RING_CAPACITY];
+};
+
+void op_ring_init(struct OpRing *ring);
+void op_ring_free(struct OpRing *ring);
+// Empty the ring for a run over values, while neither side is using it
+void op_ring_reset(struct OpRing *ring, const SortValueType *values, size_t count, _Atomic bool *cancelSort);
+// Make every record written so far visible to the consumer
+void op_ring_publish(struct OpRing *ring);
+// Block until there is room for a record, false when the sort was cancelled while waiting
+bool op_ring_wait(struct OpRing *ring);
+// Tell the consumer the array was rewritten outside the ring, the last thing a producer does in a run
+void op_ring_resync(struct OpRing *ring);
+// Apply up to budget published records to shown and return how many were applied, from the consumer only
+size_t op_ring_drain(struct OpRing *ring, SortValueType *shown, size_t budget);
+
+// Queue one access to the array, addresses outside it such as in a scratch buffer are ignored
+static inline void op_ring_push(struct OpRing *ring, enum SortOpKind kind, const SortValueType *address,
+                                const SortValueType *other)
+{
+    size_t index = (size_t)((uintptr_t)address - (uintptr_t)ring->values) / sizeof(SortValueType);
+    if (index >= ring->count)
+        return;
+    // Records of a cancelled run are dropped rather than waited for, its array is resynced as a whole
+    if (ring->written - ring->cachedTail == OP_RING_CAPACITY && !op_ring_wait(ring))
+        return;
+    size_t otherIndex =
+        other != NULL ? (size_t)((uintptr_t)other - (uintptr_t)ring->values) / sizeof(SortValueType) : 0;
+    // Swapping with a value outside the array only changes this end of it
+    if (kind == SortOpSwap && otherIndex >= ring->count)
+        kind = SortOpWrite;
+    struct SortOp *op = &ring->ops[ring->written & (OP_RING_CAPACITY - 1)];
+    op->index = (uint32_t)index;
+    op->other = (uint32_t)otherIndex;
+    op->value = *address;
+    op->kind = (uint8_t)kind;
+    ring->written++;
+    if ((ring->written & (OP_RING_BATCH - 1)) == 0)
+        atomic_store_explicit(&ring->head, ring->written, memory_order_release);
+}
+
+#endif // !OP_RING_H
@@ -0,0 +1,78 @@
+#include "pacer.h"
+#include "sorts.h"
+
+void op_pacer_start(struct OpPacer *pacer, const float *speed, bool byOps)
+{
+    pacer->speed = speed;
+    pacer->targetSeconds = NULL;
+    pacer->targetOps = 0;
+    pacer->byOps = byOps;
+    pacer->paidOps = 0;
+    pacer->deadline = monotonic_nanoseconds();
+    pacer->windowStart = pacer->deadline;
+    pacer->windowOps = 0;
+    atomic_store(&pacer->opsPerSecond, 0);
+    atomic_store(&pacer->lagNanoseconds, 0);
+}
+
+void op_pacer_target(struct OpPacer *pacer, const float *targetSeconds, size_t ops)
+{
+    pacer->targetSeconds = targetSeconds;
+    pacer->targetOps = ops > 0 ? ops : 1;
+    pacer->byOps = true;
+}
+
+static void op_pacer_measure_at(struct OpPacer *pacer, size_t ops, uint64_t now)
+{
+    uint64_t elapsed = now - pacer->windowStart;
+    if (elapsed < OP_PACER_RATE_WINDOW_NANOSECONDS)
+        return;
+    uint64_t rate = (uint64_t)((double)(ops - pacer->windowOps) * 1e9 / (double)elapsed);
+    atomic_store_explicit(&pacer->opsPerSecond, rate, memory_order_relaxed);
+    pacer->windowStart = now;
+    pacer->windowOps = ops;
+}
+
+void op_pacer_wait(struct OpPacer *pacer, size_t ops, uint64_t stepNanoseconds)
+{
+    // The slider is read on every call so moving it changes the pace of the operations still to come
+    if (pacer->targetSeconds != NULL)
+    {
+        double cost = (double)*pacer->targetSeconds * 1e9 / (double)pacer->targetOps;
+        pacer->deadline += (uint64_t)((double)(ops - pacer->paidOps) * cost);
+    }
+    else if (pacer->byOps)
+    {
+        uint64_t cost = (uint64_t)(*pacer->speed * (float)OP_PACER_MAX_OP_NANOSECONDS);
+        pacer->deadline += (uint64_t)(ops - pacer->paidOps) * cost;
+    }
+    else
+    {
+        pacer->deadline += stepNanoseconds;
+    }
+    pacer->paidOps = ops;
+    uint64_t now = monotonic_nanoseconds();
+    op_pacer_measure_at(pacer, ops, now);
+    if (pacer->targetSeconds == NULL && *pacer->speed <= 0.0f)
+    {
+        // Unpaced, nothing to fall behind on once the slider is turned back up
+        pacer->deadline = now;
+        atomic_store_explicit(&pacer->lagNanoseconds, 0, memory_order_relaxed);
+        return;
+    }
+    if (pacer->deadline > now)
+    {
+        atomic_store_explicit(&pacer->lagNanoseconds, 0, memory_order_relaxed);
+        if (pacer->deadline - now >= OP_PACER_MIN_SLEEP_NANOSECONDS)
+            sleep_until_nanoseconds(pacer->deadline);
+        return;
+    }
+    atomic_store_explicit(&pacer->lagNanoseconds, now - pacer->deadline, memory_order_relaxed);
+    if (now - pacer->deadline > OP_PACER_MAX_LAG_NANOSECONDS)
+        pacer->deadline = now;
+}
+
+void op_pacer_measure(struct OpPacer *pacer, size_t ops)
+{
+    op_pacer_measure_at(pacer, ops, monotonic_nanoseconds());
+}
@@ -0,0 +1,58 @@
+#ifndef PACER_H
+#define PACER_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Time every comparison and write is charged with the delay slider all the way up
+#define OP_PACER_MAX_OP_NANOSECONDS 500000ULL
+// A sort that falls further behind than this, such as after the slider was turned down, starts over from now
+// instead of running unpaced until it has caught up
+#define OP_PACER_MAX_LAG_NANOSECONDS 50000000ULL
+// A sort less than this ahead of its deadline carries on instead of sleeping, steps too short for a timer to wake up
+// in time for are run back to back until they add up to a sleep worth taking
+#define OP_PACER_MIN_SLEEP_NANOSECONDS 50000ULL
+// Span the measured operation rate is averaged over
+#define OP_PACER_RATE_WINDOW_NANOSECONDS 250000000ULL
+
+/*
+* Paces a sort against an absolute deadline on the monotonic clock. Every delay is added to the deadline rather than
+* slept on its own, so the time the sort spends working and the timer's slack don't add up over a run, and a sort
+* that fell behind catches up by running its steps back to back. Paced by operations, every comparison and array
+* write costs the same slice of time, so sorts paced off the same slider run at the same operations per second
+* whatever their step sizes, which is what makes racing them against each other fair. Paced by steps, every step
+* costs the delay the sort asks for. Owned by the sorting thread, apart from the measurements.
+*/
+struct OpPacer {
+    // Delay slider the rate follows, 0 runs unpaced
+    const float *speed;
+    // Length in seconds a run of targetOps operations is spread over instead, NULL to follow the slider
+    const float *targetSeconds;
+    size_t targetOps;
+    // Charge comparisons and writes instead of the delay of each step
+    bool byOps;
+    // Operations already paid for and when the ones paid for are due
+    size_t paidOps;
+    uint64_t deadline;
+    // Start of the window the rate is measured over and the operations done by then
+    uint64_t windowStart;
+    size_t windowOps;
+    // Measurements the drawing thread shows while the sort runs
+    _Atomic uint64_t opsPerSecond;
+    // How far behind its deadline the sort was at its last step, 0 while it keeps up
+    _Atomic uint64_t lagNanoseconds;
+};
+
+void op_pacer_start(struct OpPacer *pacer, const float *speed, bool byOps);
+// Pace the run by operations so that ops of them take targetSeconds, whatever the slider says. The target is read on
+// every step, so it can be changed while the run goes on
+void op_pacer_target(struct OpPacer *pacer, const float *targetSeconds, size_t ops);
+// Sleep until a sort that has done ops operations in total and asks for a delay of stepNanoseconds is due to carry
+// on, the step's delay is ignored when paced by operations
+void op_pacer_wait(struct OpPacer *pacer, size_t ops, uint64_t stepNanoseconds);
+// Update the measured rate of a sort that is paced some other way, such as by the ring it streams to
+void op_pacer_measure(struct OpPacer *pacer, size_t ops);
+
+#endif // !PACER_H
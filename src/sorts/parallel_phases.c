@@ -0,0 +1,135 @@
+#include "parallel_phases.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static void phase_runner_complete(void *arg)
+{
+    struct PhaseRunner *runner = (struct PhaseRunner *)arg;
+    size_t phaseSwaps = 0;
+    for (size_t i = 0; i < runner->pool.workerCount; i++)
+    {
+        struct SortStats *workerStats = &runner->workers[i].stats;
+        phaseSwaps += workerStats->swaps;
+        sort_stats_add(runner->args.sortStats, workerStats);
+        sort_stats_reset(workerStats);
+    }
+    if (runner->finished(runner->context, runner->phase, phaseSwaps))
+    {
+        runner->done = true;
+    }
+    else
+    {
+        sort_delay(&runner->args, runner->delayScale);
+        runner->done = sort_phase_end(&runner->args);
+    }
+    runner->phase++;
+}
+
+size_t phase_worker_count(size_t itemsPerPhase, size_t minItemsPerWorker)
+{
+    size_t workers = itemsPerPhase / minItemsPerWorker;
+    size_t hardwareThreads = hardware_thread_count();
+    if (workers > hardwareThreads)
+        workers = hardwareThreads;
+    return workers > 0 ? workers : 1;
+}
+
+void phase_runner_init(struct PhaseRunner *runner, struct SortFunctionArgs args, size_t workerCount, float delayScale,
+                       PhaseFinished finished, void *context, struct ParallelSortProfile *profile)
+{
+    runner->args = args;
+    runner->phase = 0;
+    runner->done = false;
+    runner->delayScale = delayScale;
+    runner->finished = finished;
+    runner->context = context;
+    runner->profile = profile;
+    runner->workers = calloc(workerCount, sizeof(struct PhaseWorker));
+    if (runner->workers == NULL)
+    {
+        fputs("Failed to allocate memory for parallel sort workers\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+    // Each worker thread tracks into a heatmap shard of its own, and queues tones alongside the others
+    for (size_t i = 0; i < workerCount; i++)
+    {
+        runner->workers[i].stats.heatmap = args.sortStats->heatmap;
+        runner->workers[i].stats.tones = args.sortStats->tones;
+    }
+    thread_pool_init(&runner->pool, workerCount);
+    barrier_init(&runner->barrier, runner->pool.workerCount, phase_runner_complete, runner);
+}
+
+void phase_runner_free(struct PhaseRunner *runner)
+{
+    barrier_destroy(&runner->barrier);
+    thread_pool_free(&runner->pool);
+    free(runner->workers);
+    runner->workers = NULL;
+}
+
+// Runs the sort's task on a worker inside a trace span, which phase_runner_sync ends and reopens around the barrier
+static void phase_runner_task(void *context, size_t workerIndex, size_t workerCount)
+{
+    struct PhaseRunner *runner = (struct PhaseRunner *)context;
+    trace_begin("phase");
+    runner->task(runner->taskContext, workerIndex, workerCount);
+}
+
+void phase_runner_run(struct PhaseRunner *runner, ThreadPoolTask task, void *taskContext)
+{
+    uint64_t start = monotonic_nanoseconds();
+    for (size_t i = 0; i < runner->pool.workerCount; i++)
+    {
+        runner->workers[i].phaseStart = start;
+    }
+    runner->task = task;
+    runner->taskContext = taskContext;
+    if (runner->args.sortStats->threads < runner->pool.workerCount)
+        runner->args.sortStats->threads = runner->pool.workerCount;
+    thread_pool_run(&runner->pool, phase_runner_task, runner);
+    if (runner->profile)
+    {
+        struct ParallelSortProfile *profile = runner->profile;
+        profile->workerCount = runner->pool.workerCount;
+        profile->phases = runner->phase;
+        profile->wallNanoseconds = monotonic_nanoseconds() - start;
+        profile->workNanoseconds = 0;
+        profile->barrierNanoseconds = 0;
+        for (size_t i = 0; i < runner->pool.workerCount; i++)
+        {
+            profile->workNanoseconds += runner->workers[i].workNanoseconds;
+            profile->barrierNanoseconds += runner->workers[i].barrierNanoseconds;
+        }
+    }
+}
+
+struct SortStats *phase_runner_stats(struct PhaseRunner *runner, size_t workerIndex)
+{
+    return &runner->workers[workerIndex].stats;
+}
+
+bool phase_runner_sync(struct PhaseRunner *runner, size_t workerIndex)
+{
+    struct PhaseWorker *worker = &runner->workers[workerIndex];
+    trace_end("phase");
+    trace_begin("barrier");
+    if (runner->profile)
+    {
+        uint64_t arrived = monotonic_nanoseconds();
+        barrier_wait(&runner->barrier);
+        uint64_t released = monotonic_nanoseconds();
+        worker->workNanoseconds += arrived - worker->phaseStart;
+        worker->barrierNanoseconds += released - arrived;
+        worker->phaseStart = released;
+    }
+    else
+    {
+        barrier_wait(&runner->barrier);
+    }
+    trace_end("barrier");
+    if (runner->done)
+        return false;
+    trace_begin("phase");
+    return true;
+}
@@ -0,0 +1,63 @@
+#ifndef PARALLEL_PHASES_H
+#define PARALLEL_PHASES_H
+
+#include "sorts.h"
+#include "parallel/barrier.h"
+#include "parallel/thread_pool.h"
+
+// Timing breakdown of a phase parallel sort, filled in when a profile is requested
+struct ParallelSortProfile {
+    size_t workerCount;
+    size_t phases;
+    uint64_t wallNanoseconds;
+    // Summed over all workers
+    uint64_t workNanoseconds;
+    uint64_t barrierNanoseconds;
+};
+
+// Called once per phase, while every worker is parked, to decide whether the sort is finished
+typedef bool (*PhaseFinished)(void *context, size_t phase, size_t phaseSwaps);
+
+// Per worker counters, padded so that workers never write to the same cache line
+struct PhaseWorker {
+    struct SortStats stats;
+    uint64_t phaseStart;
+    uint64_t workNanoseconds;
+    uint64_t barrierNanoseconds;
+    char padding[64];
+};
+
+/*
+* Runs a sort as a sequence of phases across a thread pool. Every compare-exchange of a phase happens
+* concurrently, then all workers meet at a barrier where the last one to arrive merges the per worker stats,
+* paces the visualisation once for the whole phase and checks for cancellation.
+*/
+struct PhaseRunner {
+    struct SortFunctionArgs args;
+    struct ThreadPool pool;
+    struct Barrier barrier;
+    struct PhaseWorker *workers;
+    size_t phase;
+    bool done;
+    float delayScale;
+    PhaseFinished finished;
+    void *context;
+    struct ParallelSortProfile *profile;
+    ThreadPoolTask task;
+    void *taskContext;
+};
+
+// Pick a worker count so that each worker has at least minItemsPerWorker units of work per phase
+size_t phase_worker_count(size_t itemsPerPhase, size_t minItemsPerWorker);
+
+void phase_runner_init(struct PhaseRunner *runner, struct SortFunctionArgs args, size_t workerCount, float delayScale,
+                       PhaseFinished finished, void *context, struct ParallelSortProfile *profile);
+void phase_runner_free(struct PhaseRunner *runner);
+// Run task on every worker until the finished callback or a cancellation ends the sort
+void phase_runner_run(struct PhaseRunner *runner, ThreadPoolTask task, void *taskContext);
+// Stats that a worker should count into, merged into the sort stats at the end of each phase
+struct SortStats *phase_runner_stats(struct PhaseRunner *runner, size_t workerIndex);
+// End the current phase for a worker. Returns false once the sort is finished and the worker should return
+bool phase_runner_sync(struct PhaseRunner *runner, size_t workerIndex);
+
+#endif // !PARALLEL_PHASES_H
@@ -0,0 +1,83 @@
+#include "partial_sort.h"
+
+#define PARTIAL_SORT_SLEEP sort_delay(args, 50000.0f);
+
+static void bounded_heap_sift_down(struct SortFunctionArgs *args, SortValueType *heap, size_t root, size_t size)
+{
+    struct SortStats *sortStats = args->sortStats;
+    for (;;)
+    {
+        size_t largest = root;
+        size_t left = 2 * root + 1;
+        size_t right = left + 1;
+        if (left < size)
+            track_read(sortStats, &heap[left]);
+        if (right < size)
+            track_read(sortStats, &heap[right]);
+        if (left < size && heap[left] > heap[largest])
+            largest = left;
+        if (right < size && heap[right] > heap[largest])
+            largest = right;
+        sortStats->comparisons += 2;
+        sortStats->arrayAccesses += 4;
+        if (largest == root)
+            return;
+        swap(sortStats, &heap[root], &heap[largest]);
+        PARTIAL_SORT_SLEEP
+        if (sort_checkpoint(args))
+            return;
+        root = largest;
+    }
+}
+
+void bounded_heap_select(struct SortFunctionArgs *args, size_t begin, size_t end, size_t k)
+{
+    if (k == 0)
+        return;
+    SortValueType *heap = args->values + begin;
+    for (size_t i = k / 2; i-- > 0;)
+    {
+        bounded_heap_sift_down(args, heap, i, k);
+        if (sort_checkpoint(args))
+            return;
+    }
+    if (sort_phase_end(args))
+        return;
+    // Anything smaller than the largest of the k kept so far replaces it
+    for (size_t i = begin + k; i < end; i++)
+    {
+        args->sortStats->comparisons++;
+        args->sortStats->arrayAccesses += 2;
+        track_read(args->sortStats, &args->values[i]);
+        if (args->values[i] < heap[0])
+        {
+            swap(args->sortStats, &args->values[i], &heap[0]);
+            bounded_heap_sift_down(args, heap, 0, k);
+            if (sort_checkpoint(args))
+                return;
+        }
+    }
+}
+
+void bounded_heap_sort(struct SortFunctionArgs *args, size_t begin, size_t k)
+{
+    SortValueType *heap = args->values + begin;
+    for (size_t size = k; size > 1; size--)
+    {
+        swap(args->sortStats, &heap[0], &heap[size - 1]);
+        PARTIAL_SORT_SLEEP
+        bounded_heap_sift_down(args, heap, 0, size - 1);
+        if (sort_phase_end(args))
+            return;
+    }
+}
+
+void partial_sort(struct SortFunctionArgs args, size_t k)
+{
+    if (k > args.count)
+        k = args.count;
+    bounded_heap_select(&args, 0, args.count, k);
+    if (sort_checkpoint(&args))
+        return;
+    bounded_heap_sort(&args, 0, k);
+}
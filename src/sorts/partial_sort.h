@@ -0,0 +1,12 @@
+#ifndef PARTIAL_SORT_H
+#define PARTIAL_SORT_H
+
+#include "sorts.h"
+
+void partial_sort(struct SortFunctionArgs args, size_t k);
+// Move the k smallest values of [begin, end) into [begin, begin + k) arranged as a max heap
+void bounded_heap_select(struct SortFunctionArgs *args, size_t begin, size_t end, size_t k);
+// Sort the max heap in [begin, begin + k) into ascending order
+void bounded_heap_sort(struct SortFunctionArgs *args, size_t begin, size_t k);
+
+#endif // !PARTIAL_SORT_H
@@ -1,6 +1,6 @@
 #include "quick_sort.h"
 
-#define QUICK_SORT_SLEEP sleep_microseconds((uint64_t)(*args->speed * 50000.0f));
+#define QUICK_SORT_SLEEP sort_delay(args, 50000.0f);
 
 static size_t quicksort_partition(size_t low, size_t high, struct SortFunctionArgs *args)
 {
@@ -16,43 +16,59 @@ static size_t quicksort_partition(size_t low, size_t high, struct SortFunctionAr
         sortStats->comparisons++;
         while (i <= high && values[i] <= pivot)
         {
+            track_read(sortStats, &values[i]);
             i++;
         }
         sortStats->comparisons++;
         while (j >= low && values[j] > pivot)
         {
+            track_read(sortStats, &values[j]);
             j--;
         }
         if (i < j)
         {
             swap(sortStats, &values[i], &values[j]);
             QUICK_SORT_SLEEP
-            if (atomic_load(args->cancelSort))
+            if (sort_checkpoint(args))
                 return 0;
         }
     }
     swap(sortStats, &values[low], &values[j]);
     QUICK_SORT_SLEEP
-    if (atomic_load(args->cancelSort))
+    if (sort_checkpoint(args))
         return 0;
     return j;
 }
 
 static void quicksort_impl(size_t low, size_t high, struct SortFunctionArgs *args)
 {
-    if (low >= high)
-        return;
-
-    size_t partition_idx = quicksort_partition(low, high, args);
-    if (atomic_load(args->cancelSort))
-        return;
+    // Recurse into the smaller side and loop on the larger one, so the stack stays logarithmic on inputs such as
+    // all equal values where every partition only splits off the pivot
+    while (low < high)
+    {
+        trace_begin("quicksort_partition");
+        size_t partition_idx = quicksort_partition(low, high, args);
+        trace_end("quicksort_partition");
+        if (sort_phase_end(args))
+            return;
 
-    if (partition_idx > 0)
-        quicksort_impl(low, partition_idx - 1, args);
-    quicksort_impl(partition_idx + 1, high, args);
+        if (partition_idx - low < high - partition_idx)
+        {
+            if (partition_idx > low)
+                quicksort_impl(low, partition_idx - 1, args);
+            low = partition_idx + 1;
+        }
+        else
+        {
+            quicksort_impl(partition_idx + 1, high, args);
+            high = partition_idx - 1;
+        }
+    }
 }
 
 void quick_sort(struct SortFunctionArgs args)
 {
+    if (args.count < 2)
+        return;
     quicksort_impl(0, args.count - 1, &args);
 }
\ No newline at end of file
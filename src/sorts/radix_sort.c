@@ -0,0 +1,90 @@
+#include "radix_sort.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RADIX_SORT_SLEEP sort_delay(&args, 5000.0f);
+
+/*
+* Least significant digit radix sort, one byte per pass. Every histogram is built in a single read of the
+* input and passes where all keys share the same digit are skipped. Passes ping-pong between the array and a
+* scratch buffer, so the visualizer only sees the passes that scatter back into the array.
+*/
+void radix_sort(struct SortFunctionArgs args)
+{
+    struct SortStats *sortStats = args.sortStats;
+    size_t count = args.count;
+    if (count < 2)
+        return;
+    size_t(*histograms)[RADIX_BUCKETS] = calloc(RADIX_PASSES, sizeof(*histograms));
+    SortValueType *scratch = malloc(count * sizeof(SortValueType));
+    if (histograms == NULL || scratch == NULL)
+    {
+        fputs("Failed to allocate memory for radix sort\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+    sort_kernels()->radixHistograms(args.values, count, histograms);
+    sortStats->arrayAccesses += count;
+
+    SortValueType *source = args.values;
+    SortValueType *destination = scratch;
+    for (size_t pass = 0; pass < RADIX_PASSES; pass++)
+    {
+        size_t *histogram = histograms[pass];
+        size_t offsets[RADIX_BUCKETS];
+        size_t total = 0;
+        bool trivial = false;
+        for (size_t bucket = 0; bucket < RADIX_BUCKETS; bucket++)
+        {
+            trivial |= histogram[bucket] == count;
+            offsets[bucket] = total;
+            total += histogram[bucket];
+        }
+        if (trivial)
+            continue;
+        bool visible = destination == args.values;
+        if (!visible && sortStats->heatmap != NULL)
+        {
+            // Scattering out of the array reads it front to back
+            for (size_t i = 0; i < count; i++)
+            {
+                track_read(sortStats, &source[i]);
+            }
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            SortValueType value = source[i];
+            SortValueType *target = &destination[offsets[(value >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1)]++];
+            *target = value;
+            if (visible)
+            {
+                // Counted as they happen so a sort paced by its operations is paced through the visible passes
+                track_write(sortStats, target);
+                sortStats->arrayWrites++;
+                RADIX_SORT_SLEEP
+                if (sort_checkpoint(&args))
+                {
+                    // The scratch buffer still holds every key as the last pass left them
+                    memcpy(args.values, source, count * sizeof(SortValueType));
+                    break;
+                }
+            }
+        }
+        sortStats->arrayAccesses += count;
+        if (!visible)
+            sortStats->arrayWrites += count;
+        SortValueType *swapBuffers = source;
+        source = destination;
+        destination = swapBuffers;
+        if (sort_phase_end(&args))
+            break;
+    }
+    if (source != args.values && !sort_checkpoint(&args))
+    {
+        memcpy(args.values, source, count * sizeof(SortValueType));
+        track_writes(sortStats, args.values, count);
+        sortStats->arrayWrites += count;
+    }
+    free(scratch);
+    free(histograms);
+}
@@ -0,0 +1,8 @@
+#ifndef RADIX_SORT_H
+#define RADIX_SORT_H
+
+#include "sorts.h"
+
+void radix_sort(struct SortFunctionArgs args);
+
+#endif // !RADIX_SORT_H
@@ -0,0 +1,117 @@
+#include "random.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <threads.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static _Atomic uint64_t globalSeed = 0;
+// Threads that never chose a stream get one after all the well known streams, in order of first use
+static _Atomic uint64_t nextThreadStream = RandomStreamChunks + (1ULL << 32);
+static thread_local struct RandomState threadState;
+static thread_local bool threadSeeded = false;
+
+static uint64_t splitmix64(uint64_t *x)
+{
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static uint64_t rotate_left(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+// High and low halves of the full 128 bit product of a and b
+static uint64_t multiply_high(uint64_t a, uint64_t b, uint64_t *low)
+{
+#if defined(__SIZEOF_INT128__)
+    __extension__ typedef unsigned __int128 uint128;
+    uint128 product = (uint128)a * b;
+    *low = (uint64_t)product;
+    return (uint64_t)(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    uint64_t high;
+    *low = _umul128(a, b, &high);
+    return high;
+#else
+    uint64_t aLow = a & 0xFFFFFFFFULL, aHigh = a >> 32;
+    uint64_t bLow = b & 0xFFFFFFFFULL, bHigh = b >> 32;
+    uint64_t lowLow = aLow * bLow;
+    uint64_t highLow = aHigh * bLow;
+    uint64_t lowHigh = aLow * bHigh;
+    uint64_t cross = (lowLow >> 32) + (highLow & 0xFFFFFFFFULL) + lowHigh;
+    *low = (cross << 32) | (lowLow & 0xFFFFFFFFULL);
+    return aHigh * bHigh + (highLow >> 32) + (cross >> 32);
+#endif
+}
+
+void random_seed(struct RandomState *state, uint64_t seed, uint64_t stream)
+{
+    uint64_t x = seed ^ splitmix64(&stream);
+    for (int i = 0; i < 4; i++)
+    {
+        state->s[i] = splitmix64(&x);
+    }
+}
+
+uint64_t random_next(struct RandomState *state)
+{
+    uint64_t *s = state->s;
+    uint64_t result = rotate_left(s[0] + s[3], 23) + s[0];
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotate_left(s[3], 45);
+    return result;
+}
+
+uint64_t random_bounded(struct RandomState *state, uint64_t bound)
+{
+    uint64_t low;
+    uint64_t high = multiply_high(random_next(state), bound, &low);
+    if (low < bound)
+    {
+        // Only reject in the rare case that the low half falls in the biased sliver
+        uint64_t threshold = (0 - bound) % bound;
+        while (low < threshold)
+        {
+            high = multiply_high(random_next(state), bound, &low);
+        }
+    }
+    return high;
+}
+
+double random_double(struct RandomState *state)
+{
+    return (double)(random_next(state) >> 11) * 0x1.0p-53;
+}
+
+void random_set_global_seed(uint64_t seed)
+{
+    atomic_store(&globalSeed, seed);
+}
+
+uint64_t random_global_seed(void)
+{
+    return atomic_load(&globalSeed);
+}
+
+void random_seed_thread(uint64_t stream)
+{
+    random_seed(&threadState, random_global_seed(), stream);
+    threadSeeded = true;
+}
+
+struct RandomState *random_thread_state(void)
+{
+    if (!threadSeeded)
+        random_seed_thread(atomic_fetch_add(&nextThreadStream, 1));
+    return &threadState;
+}
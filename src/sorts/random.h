@@ -0,0 +1,37 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <stdint.h>
+
+// State of a xoshiro256++ generator
+struct RandomState {
+    uint64_t s[4];
+};
+
+// Well known streams so that the threads of a run always draw the same numbers for the same seed
+enum RandomStream {
+    RandomStreamMain,
+    RandomStreamSort,
+    RandomStreamBench,
+    RandomStreamGenerator,
+    // Streams from here on are free for parallel work, one per chunk
+    RandomStreamChunks,
+};
+
+// Seed a generator from a seed and a stream number, different streams give independent sequences
+void random_seed(struct RandomState *state, uint64_t seed, uint64_t stream);
+uint64_t random_next(struct RandomState *state);
+// Uniform value in [0, bound) without modulo bias (Lemire's multiply and reject), bound must not be zero
+uint64_t random_bounded(struct RandomState *state, uint64_t bound);
+// Uniform value in [0, 1)
+double random_double(struct RandomState *state);
+
+// Seed every thread's generator is derived from
+void random_set_global_seed(uint64_t seed);
+uint64_t random_global_seed(void);
+// Reseed the calling thread's generator from the global seed and a stream
+void random_seed_thread(uint64_t stream);
+// The calling thread's generator, seeded with a stream of its own on first use if random_seed_thread was not called
+struct RandomState *random_thread_state(void);
+
+#endif // !RANDOM_H
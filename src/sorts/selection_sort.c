@@ -1,25 +1,30 @@
 #include "selection_sort.h"
 
-#define SELECTION_SORT_SLEEP sleep_microseconds((uint64_t)(*args.speed * 1000.0f));
+#define SELECTION_SORT_SLEEP sort_delay(&args, 1000.0f);
 
 void selection_sort(struct SortFunctionArgs args)
 {
     struct SortStats *sortStats = args.sortStats;
     SortValueType *values = args.values;
     size_t count = args.count;
+    if (count < 2)
+        return;
     size_t min_idx = 0;
     for (size_t i = 0; i < count - 1; i++)
     {
         min_idx = i;
         for (size_t j = i + 1; j < count; j++)
         {
+            track_read(sortStats, &values[j]);
             if (values[j] < values[min_idx])
                 min_idx = j;
             sortStats->comparisons++;
             SELECTION_SORT_SLEEP
-            if (atomic_load(args.cancelSort))
+            if (sort_checkpoint(&args))
                 return;
         }
         swap(sortStats, &values[min_idx], &values[i]);
+        if (sort_phase_end(&args))
+            return;
     }
 }
\ No newline at end of file
@@ -0,0 +1,149 @@
+#include "shear_sort.h"
+
+#define SHEAR_SORT_DELAY 50000.0f
+#define SHEAR_SORT_MIN_PAIRS_PER_WORKER 16
+
+/*
+* The array is viewed as a rows x columns mesh. Rows are sorted in snake order (even rows ascending, odd rows
+* descending) alternating with columns sorted top to bottom, ceil(log2(rows)) + 1 times. Every row and column
+* is sorted with odd-even transposition so that one step of every line is one parallel phase. The mesh ends
+* up sorted in snake order, so the last stage reverses the odd rows to make the array ascending.
+*/
+struct ShearSort {
+    struct PhaseRunner runner;
+    size_t rows;
+    size_t columns;
+    size_t stage;
+    size_t reverseStage;
+    size_t step;
+    size_t quietSteps;
+};
+
+static bool shear_is_row_stage(const struct ShearSort *sort)
+{
+    return sort->stage % 2 == 0;
+}
+
+static bool shear_finished(void *context, size_t phase, size_t phaseSwaps)
+{
+    (void)phase;
+    struct ShearSort *sort = (struct ShearSort *)context;
+    if (sort->stage == sort->reverseStage)
+        return true;
+    sort->quietSteps = phaseSwaps > 0 ? 0 : sort->quietSteps + 1;
+    sort->step++;
+    size_t lineLength = shear_is_row_stage(sort) ? sort->columns : sort->rows;
+    if (sort->quietSteps >= 2 || sort->step >= lineLength)
+    {
+        sort->stage++;
+        sort->step = 0;
+        sort->quietSteps = 0;
+        // A single row has no odd rows to reverse
+        if (sort->stage == sort->reverseStage && sort->rows < 2)
+            return true;
+    }
+    return false;
+}
+
+static void shear_reverse_odd_rows(struct ShearSort *sort, struct SortStats *sortStats, size_t workerIndex,
+                                   size_t workerCount)
+{
+    SortValueType *values = sort->runner.args.values;
+    size_t oddRows = sort->rows / 2;
+    size_t half = sort->columns / 2;
+    size_t swaps = oddRows * half;
+    size_t begin = swaps * workerIndex / workerCount;
+    size_t end = swaps * (workerIndex + 1) / workerCount;
+    for (size_t k = begin; k < end; k++)
+    {
+        size_t row = (k / half) * 2 + 1;
+        size_t column = k % half;
+        SortValueType *line = values + row * sort->columns;
+        swap(sortStats, &line[column], &line[sort->columns - 1 - column]);
+    }
+}
+
+static void shear_step(struct ShearSort *sort, struct SortStats *sortStats, size_t workerIndex, size_t workerCount)
+{
+    SortValueType *values = sort->runner.args.values;
+    bool rowStage = shear_is_row_stage(sort);
+    size_t lineLength = rowStage ? sort->columns : sort->rows;
+    size_t first = sort->step & 1;
+    size_t pairsPerLine = lineLength > first ? (lineLength - first) / 2 : 0;
+    size_t pairs = (rowStage ? sort->rows : sort->columns) * pairsPerLine;
+    size_t begin = pairs * workerIndex / workerCount;
+    size_t end = pairs * (workerIndex + 1) / workerCount;
+    for (size_t k = begin; k < end; k++)
+    {
+        size_t line = k / pairsPerLine;
+        size_t position = first + (k % pairsPerLine) * 2;
+        size_t a, b;
+        bool ascending;
+        if (rowStage)
+        {
+            a = line * sort->columns + position;
+            b = a + 1;
+            ascending = line % 2 == 0;
+        }
+        else
+        {
+            a = position * sort->columns + line;
+            b = a + sort->columns;
+            ascending = true;
+        }
+        track_read(sortStats, &values[a]);
+        track_read(sortStats, &values[b]);
+        if (ascending ? values[a] > values[b] : values[a] < values[b])
+        {
+            swap(sortStats, &values[a], &values[b]);
+        }
+        sortStats->comparisons++;
+    }
+}
+
+static void shear_worker(void *context, size_t workerIndex, size_t workerCount)
+{
+    struct ShearSort *sort = (struct ShearSort *)context;
+    struct SortStats *sortStats = phase_runner_stats(&sort->runner, workerIndex);
+    do
+    {
+        if (sort->stage == sort->reverseStage)
+            shear_reverse_odd_rows(sort, sortStats, workerIndex, workerCount);
+        else
+            shear_step(sort, sortStats, workerIndex, workerCount);
+    } while (phase_runner_sync(&sort->runner, workerIndex));
+}
+
+void shear_sort_parallel(struct SortFunctionArgs args, size_t workerCount, struct ParallelSortProfile *profile)
+{
+    if (args.count < 2)
+        return;
+    struct ShearSort sort;
+    // Use the most square mesh that exactly covers the array, with no more rows than columns
+    sort.rows = 1;
+    for (size_t rows = 2; rows * rows <= args.count; rows++)
+    {
+        if (args.count % rows == 0)
+            sort.rows = rows;
+    }
+    sort.columns = args.count / sort.rows;
+    size_t log2Rows = 0;
+    while (((size_t)1 << log2Rows) < sort.rows)
+    {
+        log2Rows++;
+    }
+    sort.stage = 0;
+    sort.reverseStage = log2Rows * 2 + 1;
+    sort.step = 0;
+    sort.quietSteps = 0;
+    if (workerCount == 0)
+        workerCount = phase_worker_count(args.count / 2, SHEAR_SORT_MIN_PAIRS_PER_WORKER);
+    phase_runner_init(&sort.runner, args, workerCount, SHEAR_SORT_DELAY, shear_finished, &sort, profile);
+    phase_runner_run(&sort.runner, shear_worker, &sort);
+    phase_runner_free(&sort.runner);
+}
+
+void shear_sort(struct SortFunctionArgs args)
+{
+    shear_sort_parallel(args, 0, NULL);
+}
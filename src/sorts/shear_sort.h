@@ -0,0 +1,11 @@
+#ifndef SHEAR_SORT_H
+#define SHEAR_SORT_H
+
+#include "sorts.h"
+#include "parallel_phases.h"
+
+void shear_sort(struct SortFunctionArgs args);
+// Shear sort on an explicit number of workers (0 picks one from the array size)
+void shear_sort_parallel(struct SortFunctionArgs args, size_t workerCount, struct ParallelSortProfile *profile);
+
+#endif // !SHEAR_SORT_H
@@ -1,25 +1,39 @@
 #include "shell_sort.h"
 
-#define SHELL_SORT_SLEEP sleep_microseconds((uint64_t)(*args.speed * 50000.0f));
+#define SHELL_SORT_SLEEP sort_delay(&args, 50000.0f);
 
 void shell_sort(struct SortFunctionArgs args) {
     size_t interval = args.count / 2;
     while (interval > 0) {
+        trace_begin_arg("shell gap pass", "gap", (int64_t)interval);
         for (size_t i = interval; i < args.count; i++) {
             SortValueType temp = args.values[i];
             args.sortStats->arrayAccesses++;
+            track_read(args.sortStats, &args.values[i]);
             size_t j = i;
             while (j >= interval && args.values[j - interval] > temp) {
                 args.sortStats->comparisons++;
+                track_read(args.sortStats, &args.values[j - interval]);
                 args.values[j] = args.values[j - interval];
+                track_write(args.sortStats, &args.values[j]);
                 args.sortStats->swaps++;
                 args.sortStats->arrayWrites++;
                 args.sortStats->arrayAccesses++;
                 j -= interval;
                 SHELL_SORT_SLEEP
+                if (sort_checkpoint(&args)) {
+                    // The value being inserted fills the gap it has reached, so a cancel keeps every key
+                    args.values[j] = temp;
+                    trace_end("shell gap pass");
+                    return;
+                }
             }
             args.values[j] = temp;
+            track_write(args.sortStats, &args.values[j]);
         }
+        trace_end("shell gap pass");
+        if (sort_phase_end(&args))
+            return;
         interval /= 2;
     } 
 }
\ No newline at end of file
@@ -0,0 +1,144 @@
+#include "sort_control.h"
+#include "sorts.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Longest the stepping thread sleeps before checking whether the sort has finished instead of reaching a checkpoint
+#define SORT_CONTROL_WAIT_NANOSECONDS 1000000L
+
+void sort_control_init(struct SortControl *control)
+{
+    if (mtx_init(&control->mutex, mtx_plain) != thrd_success || cnd_init(&control->changed) != thrd_success)
+    {
+        fputs("Failed to create sort control\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+    control->command = SortCommandResume;
+    control->waiting = false;
+    control->pausedNanoseconds = 0;
+    control->cancelAtPhaseEnd = false;
+    atomic_init(&control->held, false);
+    atomic_init(&control->cancelReached, false);
+}
+
+void sort_control_free(struct SortControl *control)
+{
+    cnd_destroy(&control->changed);
+    mtx_destroy(&control->mutex);
+}
+
+void sort_control_start(struct SortControl *control, bool paused)
+{
+    mtx_lock(&control->mutex);
+    control->command = paused ? SortCommandPause : SortCommandResume;
+    control->waiting = false;
+    control->pausedNanoseconds = 0;
+    control->cancelAtPhaseEnd = false;
+    atomic_store(&control->cancelReached, false);
+    atomic_store(&control->held, paused);
+    mtx_unlock(&control->mutex);
+}
+
+void sort_control_command(struct SortControl *control, enum SortCommand command)
+{
+    mtx_lock(&control->mutex);
+    control->command = command;
+    // A sort still waiting has yet to see the command, it counts as waiting again once it has acted on it
+    control->waiting = false;
+    // Even a resume goes through the slow path once, which is where the held flag is cleared without losing a
+    // cancel raised in between
+    atomic_store(&control->held, true);
+    cnd_broadcast(&control->changed);
+    mtx_unlock(&control->mutex);
+}
+
+void sort_control_wake(struct SortControl *control)
+{
+    mtx_lock(&control->mutex);
+    atomic_store(&control->held, true);
+    cnd_broadcast(&control->changed);
+    mtx_unlock(&control->mutex);
+}
+
+bool sort_control_paused(struct SortControl *control)
+{
+    mtx_lock(&control->mutex);
+    bool paused = control->command != SortCommandResume;
+    mtx_unlock(&control->mutex);
+    return paused;
+}
+
+void sort_control_wait_held(struct SortControl *control, _Atomic bool *running)
+{
+    mtx_lock(&control->mutex);
+    while (!control->waiting && atomic_load(running))
+    {
+        // A sort that finishes never reaches another checkpoint, so nothing would signal the last step
+        struct timespec deadline;
+        timespec_get(&deadline, TIME_UTC);
+        deadline.tv_nsec += SORT_CONTROL_WAIT_NANOSECONDS;
+        if (deadline.tv_nsec >= 1000000000L)
+        {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        cnd_timedwait(&control->changed, &control->mutex, &deadline);
+    }
+    mtx_unlock(&control->mutex);
+}
+
+bool sort_control_hold(const struct SortFunctionArgs *args, bool phaseEnd)
+{
+    struct SortControl *control = args->control;
+    // A deferred cancel lets the sort run on to the end of its phase without taking the mutex at every step
+    if (!phaseEnd && control->cancelAtPhaseEnd && atomic_load(args->cancelSort) &&
+        !atomic_load(&control->cancelReached))
+        return false;
+    bool atPhaseEnd = phaseEnd;
+    uint64_t pausedAt = 0;
+    mtx_lock(&control->mutex);
+    while (!atomic_load(args->cancelSort) && control->command != SortCommandResume)
+    {
+        if (control->command == SortCommandStepOp)
+        {
+            control->command = SortCommandPause;
+            break;
+        }
+        if (control->command == SortCommandStepPhase)
+        {
+            if (!phaseEnd)
+                break;
+            control->command = SortCommandPause;
+        }
+        if (pausedAt == 0)
+        {
+            pausedAt = monotonic_nanoseconds();
+            // Hand the drawing thread the batch still being filled, so it shows everything up to the pause
+            if (args->sortStats->ops != NULL)
+                op_ring_publish(args->sortStats->ops);
+        }
+        if (!control->waiting)
+        {
+            control->waiting = true;
+            cnd_broadcast(&control->changed);
+        }
+        cnd_wait(&control->changed, &control->mutex);
+        // The phase that ended here has been stopped at, a step from here runs to the end of the next one
+        phaseEnd = false;
+    }
+    control->waiting = false;
+    if (pausedAt != 0)
+        control->pausedNanoseconds += monotonic_nanoseconds() - pausedAt;
+    bool cancelled = atomic_load(args->cancelSort);
+    atomic_store(&control->held, cancelled || control->command != SortCommandResume);
+    mtx_unlock(&control->mutex);
+    if (cancelled && control->cancelAtPhaseEnd && !atomic_load(&control->cancelReached))
+    {
+        // Cancelled while paused part way through a phase, which still has to finish
+        if (!atPhaseEnd)
+            return false;
+        atomic_store(&control->cancelReached, true);
+    }
+    return cancelled;
+}
@@ -0,0 +1,60 @@
+#ifndef SORT_CONTROL_H
+#define SORT_CONTROL_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <threads.h>
+
+enum SortCommand {
+    SortCommandResume,
+    SortCommandPause,
+    // Let the sort past its next checkpoint, then pause it again
+    SortCommandStepOp,
+    // Let the sort run until it ends its current phase, such as a pass, a partition or a merge, then pause it again
+    SortCommandStepPhase,
+};
+
+/*
+* Pause, resume and single step a running sort from another thread. Sorts check in between their steps, see
+* sort_checkpoint, and all a check in reads while nothing was asked of the sort is the held flag. A paused sort
+* waits on a condition variable, so it uses no CPU until it is told to carry on or to stop.
+*/
+struct SortControl {
+    // Raised by every command and by a cancel, the sort takes the slow path at its next checkpoint and clears it
+    // again once it is left running
+    _Atomic bool held;
+    mtx_t mutex;
+    cnd_t changed;
+    // Last command given, under the mutex
+    enum SortCommand command;
+    // Set while the sort sits waiting at a checkpoint for a command, under the mutex
+    bool waiting;
+    // Time the run spent paused, written by the sorting thread and read once the run has finished
+    uint64_t pausedNanoseconds;
+    // Set before a run whose array has to stay a permutation of its keys, such as a file mapped in place. A cancel
+    // then stops the sort only once its current phase has ended, every checkpoint after that stops it as usual
+    bool cancelAtPhaseEnd;
+    // Raised at the phase end where such a deferred cancel took effect
+    _Atomic bool cancelReached;
+};
+
+struct SortFunctionArgs;
+
+void sort_control_init(struct SortControl *control);
+void sort_control_free(struct SortControl *control);
+// Ready the control for a new run, while no sort is using it. A paused run stops at its first checkpoint, and a cancel
+// takes effect at once until cancelAtPhaseEnd is set again
+void sort_control_start(struct SortControl *control, bool paused);
+void sort_control_command(struct SortControl *control, enum SortCommand command);
+// Wake the sort so it notices its cancelSort, which the caller has already set
+void sort_control_wake(struct SortControl *control);
+// Whether the last command leaves the sort paused once it reaches a checkpoint
+bool sort_control_paused(struct SortControl *control);
+// Block until the sort waits at a checkpoint for the next command, or until running is cleared because it finished
+// first. For stepping through a run from another thread
+void sort_control_wait_held(struct SortControl *control, _Atomic bool *running);
+// Slow path of a checkpoint, blocks for as long as the sort is paused. Returns whether the sort was cancelled
+bool sort_control_hold(const struct SortFunctionArgs *args, bool phaseEnd);
+
+#endif // !SORT_CONTROL_H
@@ -0,0 +1,108 @@
+#ifndef SORT_TYPES_H
+#define SORT_TYPES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Types the sort kernels share with whatever runs them, the visualizer or a program embedding sortsim_core
+
+// Width of the sorted keys, set with the SORTSIM_KEY_BITS CMake option so mapped datasets of that width can be
+// sorted in place
+#ifndef SORTSIM_KEY_BITS
+#define SORTSIM_KEY_BITS 16
+#endif
+#if SORTSIM_KEY_BITS == 16
+typedef uint16_t SortValueType;
+#elif SORTSIM_KEY_BITS == 32
+typedef uint32_t SortValueType;
+#elif SORTSIM_KEY_BITS == 64
+typedef uint64_t SortValueType;
+#else
+#error "SORTSIM_KEY_BITS must be 16, 32 or 64"
+#endif
+
+enum SortType {
+    BubbleSort,
+    SelectionSort,
+    InsertionSort,
+    ShellSort,
+    CocktailShakerSort,
+    Quicksort,
+    MergeSort,
+    HeapSort,
+    BogoSort,
+    OddEvenSort,
+    ShearSort,
+    CountingSort,
+    RadixSort,
+    NaturalMergeSort,
+    IntroSort,
+    KWayMergeSort,
+    AutoSort,
+    NumSorts,
+};
+
+// Input patterns the array can be filled with, see sorts/distribution.h
+enum Distribution {
+    DistributionShuffled,
+    DistributionRandom,
+    DistributionSorted,
+    DistributionReversed,
+    DistributionNearlySorted,
+    DistributionSawtooth,
+    DistributionOrganPipe,
+    DistributionFewUnique,
+    DistributionAllEqual,
+    DistributionZipf,
+    DistributionGaussian,
+    DistributionSortedRuns,
+    NumDistributions,
+};
+
+enum SelectType {
+    NthElement,
+    PartialSort,
+    TopK,
+    NumSelects,
+};
+
+struct AccessHeatmap;
+struct OpPacer;
+struct OpRing;
+struct ToneQueue;
+
+struct SortStats {
+    size_t swaps;
+    size_t comparisons;
+    size_t arrayAccesses;
+    size_t arrayWrites;
+    // Most threads the run sorted on at once
+    size_t threads;
+    // Where accesses to the array are tracked for the heatmap overlay, NULL when nobody is watching
+    struct AccessHeatmap *heatmap;
+    // Paces the run by its operation count instead of the delays of each sort's steps, NULL for the usual delays
+    struct OpPacer *pacer;
+    // Where accesses to the array are streamed to the drawing thread, NULL when it reads the array itself
+    struct OpRing *ops;
+    // Where the values read and written are queued to be heard, NULL when the run is silent or its accesses are
+    // heard as the drawing thread replays them from the ring
+    struct ToneQueue *tones;
+};
+
+// What the auto sort found when probing the array and which sort it picked because of it
+struct AutoSortDecision {
+    enum SortType sort;
+    size_t sampledPairs;
+    size_t descents;
+    size_t equals;
+    size_t estimatedRuns;
+    float duplicateRatio;
+    SortValueType minimum;
+    SortValueType maximum;
+    char reason[128];
+};
+
+// Set all sort stats to zero and the thread count to one, the heatmap, pacer, ring and tone queue are left alone
+void sort_stats_reset(struct SortStats *sortStats);
+
+#endif // !SORT_TYPES_H
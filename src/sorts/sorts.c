@@ -8,14 +8,42 @@
 #include "merge_sort.h"
 #include "heap_sort.h"
 #include "bogo_sort.h"
+#include "odd_even_sort.h"
+#include "shear_sort.h"
+#include "nth_element.h"
+#include "partial_sort.h"
+#include "top_k.h"
+#include "counting_sort.h"
+#include "radix_sort.h"
+#include "natural_merge_sort.h"
+#include "intro_sort.h"
+#include "kway_merge.h"
+#include "auto_sort.h"
+#include "random.h"
+#include "pacer.h"
 
+#include <ctype.h>
+#include <math.h>
 #include <stdatomic.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <threads.h>
+
+#define SHUFFLE_LOOKAHEAD 16
+
+#if defined(__GNUC__) || defined(__clang__)
+#define PREFETCH_WRITE(address) __builtin_prefetch((address), 1)
+#else
+#define PREFETCH_WRITE(address) ((void)(address))
+#endif
 #if defined(_WIN32)
 #include <windows.h>
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
 #elif defined(__unix__)
 #include <errno.h>
 #include <time.h>
@@ -23,60 +51,193 @@
 
 void sleep_microseconds(uint64_t microseconds)
 {
-#if defined(_WIN32)
-    // Ugly busy waiting for microsecond precision sleep
-    LARGE_INTEGER frequency;
-    QueryPerformanceFrequency(&frequency);
+    if (microseconds == 0)
+        return;
+    sleep_until_nanoseconds(monotonic_nanoseconds() + microseconds * 1000);
+}
 
-    LARGE_INTEGER start, end;
-    QueryPerformanceCounter(&start);
+void sleep_until_nanoseconds(uint64_t deadline)
+{
+#if defined(_WIN32)
+    uint64_t now = monotonic_nanoseconds();
+    if (deadline <= now)
+        return;
+    // A high resolution waitable timer wakes within a fraction of a millisecond without keeping a core busy, older
+    // versions of Windows only have the plain one which rounds up to the scheduler tick
+    static thread_local HANDLE timer = NULL;
+    if (timer == NULL)
+        timer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    if (timer == NULL)
+        timer = CreateWaitableTimerW(NULL, TRUE, NULL);
+    if (timer == NULL)
+    {
+        Sleep((DWORD)((deadline - now + 999999) / 1000000));
+        return;
+    }
+    // Negative due times are relative, in 100 nanosecond units
+    LARGE_INTEGER dueTime;
+    dueTime.QuadPart = -(LONGLONG)((deadline - now + 99) / 100);
+    if (SetWaitableTimer(timer, &dueTime, 0, NULL, NULL, FALSE))
+        WaitForSingleObject(timer, INFINITE);
+#elif defined(__unix__)
+    // monotonic_nanoseconds reads the same clock, so the deadline can be slept on as it is
+    struct timespec ts = {(time_t)(deadline / 1000000000ULL), (long int)(deadline % 1000000000ULL)};
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+    {
+    }
+#else
+    uint64_t now = monotonic_nanoseconds();
+    if (deadline <= now)
+        return;
+    struct timespec ts = {(time_t)((deadline - now) / 1000000000ULL), (long int)((deadline - now) % 1000000000ULL)};
+    thrd_sleep(&ts, NULL);
+#endif
+}
 
-    long long elapsedMicroseconds = 0;
-    while (elapsedMicroseconds < (long long)microseconds)
+void sort_delay(const struct SortFunctionArgs *args, float scale)
+{
+    // A cancel deferred to the end of the phase lets the phase finish at full speed
+    if (atomic_load_explicit(args->cancelSort, memory_order_relaxed))
+        return;
+    struct SortStats *sortStats = args->sortStats;
+    struct OpPacer *pacer = sortStats->pacer;
+    size_t ops = sortStats->comparisons + sortStats->arrayWrites;
+    // A streamed sort is held back by the drawing thread consuming its ring, only the batch so far is handed over.
+    // One spread over a target duration is still paced here, the drawing thread shows whatever has arrived
+    if (sortStats->ops != NULL)
     {
-        QueryPerformanceCounter(&end);
-        elapsedMicroseconds = (end.QuadPart - start.QuadPart) * 1000000LL / frequency.QuadPart;
+        op_ring_publish(sortStats->ops);
+        if (pacer == NULL || pacer->targetSeconds == NULL)
+        {
+            if (pacer != NULL)
+                op_pacer_measure(pacer, ops);
+            return;
+        }
     }
+    if (pacer != NULL)
+        op_pacer_wait(pacer, ops, (uint64_t)(*args->speed * scale * 1000.0f));
+    else
+        sleep_microseconds((uint64_t)(*args->speed * scale));
+}
+
+uint64_t monotonic_nanoseconds(void)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return (uint64_t)(counter.QuadPart / frequency.QuadPart) * 1000000000ULL +
+           (uint64_t)(counter.QuadPart % frequency.QuadPart) * 1000000000ULL / (uint64_t)frequency.QuadPart;
 #elif defined(__unix__)
-    struct timespec ts = {0, (long int)microseconds * 1000L};
-    nanosleep(&ts, NULL);
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#else
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
 #endif
 }
 
-int perform_sort(void *arg)
+void sort_stats_reset(struct SortStats *sortStats)
+{
+    sortStats->swaps = 0;
+    sortStats->comparisons = 0;
+    sortStats->arrayAccesses = 0;
+    sortStats->arrayWrites = 0;
+    sortStats->threads = 1;
+}
+
+void sort_stats_add(struct SortStats *destination, const struct SortStats *source)
 {
-    struct Visualizer *visualizer = (struct Visualizer *)arg;
-    sort_stats_reset(&visualizer->sortStats);
-    struct SortFunctionArgs sortFunctionArgs = {&visualizer->sortStats, visualizer->values, visualizer->count,
-                                         &visualizer->cancelSort, &visualizer->speed};
-    sortFunctions[visualizer->selectedSort](sortFunctionArgs);
-    if (atomic_load(&visualizer->cancelSort))
+    destination->swaps += source->swaps;
+    destination->comparisons += source->comparisons;
+    destination->arrayAccesses += source->arrayAccesses;
+    destination->arrayWrites += source->arrayWrites;
+    if (source->threads > destination->threads)
+        destination->threads = source->threads;
+}
+
+size_t estimate_sort_ops(enum SortType sort, size_t count)
+{
+    double n = (double)count;
+    double logN = log2(n > 2.0 ? n : 2.0);
+    double ops;
+    switch (sort)
     {
-        for (size_t i = 0; i < visualizer->count; i++)
+    case BubbleSort:
+    case InsertionSort:
+    case CocktailShakerSort:
+    case OddEvenSort:
+        // Half of all pairs compared and a quarter of them moved
+        ops = 0.75 * n * n;
+        break;
+    case SelectionSort:
+        ops = 0.5 * n * n + 2.0 * n;
+        break;
+    case ShellSort:
+        ops = 2.0 * n * sqrt(n);
+        break;
+    case ShearSort:
+        ops = n * sqrt(n) * logN;
+        break;
+    case CountingSort:
+        ops = n;
+        break;
+    case RadixSort:
+        ops = n * (double)sizeof(SortValueType);
+        break;
+    case BogoSort:
+        // n! shuffles of n writes each on average, which overflows long before the array gets large
+        ops = n;
+        for (size_t i = 2; i <= count && ops < 1e18; i++)
         {
-            visualizer->values[i] = (SortValueType)(visualizer->count - i);
+            ops *= (double)i;
         }
-        shuffle(visualizer->values, visualizer->count, NULL);
-        sort_stats_reset(&visualizer->sortStats);
-        atomic_store(&visualizer->cancelSort, false);
+        break;
+    default:
+        ops = 2.0 * n * logN;
+        break;
     }
-    atomic_store(&visualizer->isSorting, false);
-    return 0;
+    return ops < 1e18 ? (size_t)ops + 1 : (size_t)1e18;
 }
 
 void shuffle(SortValueType *values, size_t count, struct SortStats *sortStats)
+{
+    shuffle_with_random(values, count, sortStats, random_thread_state());
+}
+
+void shuffle_with_random(SortValueType *values, size_t count, struct SortStats *sortStats,
+                         struct RandomState *random)
 {
     if (count > 1)
     {
+        // The swap targets only depend on the generator, so they are drawn SHUFFLE_LOOKAHEAD steps early and
+        // prefetched, which keeps several cache misses in flight on arrays larger than the cache
+        size_t targets[SHUFFLE_LOOKAHEAD];
+        for (size_t i = 0; i < SHUFFLE_LOOKAHEAD && i < count - 1; i++)
+        {
+            targets[i] = i + (size_t)random_bounded(random, count - i);
+            PREFETCH_WRITE(&values[targets[i]]);
+        }
         size_t i;
         for (i = 0; i < count - 1; i++)
         {
-            size_t j = i + (size_t)rand() / (RAND_MAX / (count - i) + 1);
+            size_t slot = i % SHUFFLE_LOOKAHEAD;
+            size_t j = targets[slot];
+            size_t ahead = i + SHUFFLE_LOOKAHEAD;
+            if (ahead < count - 1)
+            {
+                targets[slot] = ahead + (size_t)random_bounded(random, count - ahead);
+                PREFETCH_WRITE(&values[targets[slot]]);
+            }
             SortValueType t = values[j];
             values[j] = values[i];
             values[i] = t;
             if (sortStats)
             {
+                track_swap(sortStats, &values[i], &values[j]);
                 sortStats->swaps++;
                 sortStats->arrayAccesses += 2;
                 sortStats->arrayWrites += 2;
@@ -85,21 +246,25 @@ void shuffle(SortValueType *values, size_t count, struct SortStats *sortStats)
     }
 }
 
+struct OrderScan scan_order(const SortValueType *values, size_t count)
+{
+    return sort_kernels()->scanOrder(values, count);
+}
+
 bool is_already_sorted(SortValueType *values, size_t count, struct SortStats *sortStats)
 {
-    for (size_t i = 0; i < count - 1; i++)
+    if (count < 2)
+        return true;
+    size_t ordered = sort_kernels()->orderedPrefix(values, count);
+    bool sorted = ordered == count - 1;
+    // The stats match an element by element scan, which stops at the first descent
+    size_t pairs = sorted ? ordered : ordered + 1;
+    if (sortStats)
     {
-        if (sortStats)
-        {
-            sortStats->arrayAccesses += 2;
-            sortStats->comparisons += 1;
-        }
-        if (values[i] > values[i + 1])
-        {
-            return false;
-        }
+        sortStats->arrayAccesses += 2 * pairs;
+        sortStats->comparisons += pairs;
     }
-    return true;
+    return sorted;
 }
 
 void swap(struct SortStats *stats, SortValueType *a, SortValueType *b)
@@ -107,11 +272,50 @@ void swap(struct SortStats *stats, SortValueType *a, SortValueType *b)
     SortValueType temp = *a;
     *a = *b;
     *b = temp;
+    track_swap(stats, a, b);
     stats->swaps++;
     stats->arrayAccesses += 2;
     stats->arrayWrites += 2;
 }
 
-const SortFunction sortFunctions[] = {bubble_sort, selection_sort, insertion_sort, shell_sort, cocktail_shaker_sort,
-                                      quick_sort,  merge_sort,     heap_sort, bogo_sort};
+const SortFunction sortFunctions[] = {bubble_sort, selection_sort, insertion_sort, shell_sort,    cocktail_shaker_sort,
+                                      quick_sort,  merge_sort,     heap_sort,      bogo_sort,     odd_even_sort,
+                                      shear_sort,  counting_sort,  radix_sort,     natural_merge_sort,
+                                      intro_sort,  kway_merge_sort, auto_sort};
+const char *const sortNames[] = {"Bubble Sort", "Selection Sort", "Insertion Sort", "Shell Sort",
+                                 "Cocktail Shaker Sort", "Quick Sort", "Merge Sort", "Heap Sort",
+                                 "Bogo Sort", "Odd-Even Sort", "Shear Sort", "Counting Sort", "Radix Sort",
+                                 "Natural Merge Sort", "Intro Sort", "K-Way Merge Sort", "Auto"};
 const size_t totalSorts = sizeof(sortFunctions) / sizeof(SortFunction);
+
+bool names_match(const char *input, const char *name)
+{
+    for (;;)
+    {
+        while (*input == ' ' || *input == '-' || *input == '_')
+            input++;
+        while (*name == ' ' || *name == '-')
+            name++;
+        if (*input == '\0' || *name == '\0' || tolower((unsigned char)*input) != tolower((unsigned char)*name))
+            break;
+        input++;
+        name++;
+    }
+    return *input == '\0' && *name == '\0';
+}
+
+enum SortType sort_from_name(const char *name)
+{
+    char withSuffix[64];
+    snprintf(withSuffix, sizeof(withSuffix), "%s sort", name);
+    for (size_t s = 0; s < totalSorts; s++)
+    {
+        if (names_match(name, sortNames[s]) || names_match(withSuffix, sortNames[s]))
+            return (enum SortType)s;
+    }
+    return NumSorts;
+}
+
+const SelectFunction selectFunctions[] = {nth_element, partial_sort, top_k};
+const char *const selectNames[] = {"Nth Element", "Partial Sort", "Top K"};
+const size_t totalSelects = sizeof(selectFunctions) / sizeof(SelectFunction);
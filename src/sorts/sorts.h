@@ -1,7 +1,13 @@
 #ifndef SORTS_H
 #define SORTS_H
 
-#include "visualizer.h"
+#include "sort_types.h"
+#include "cpu_dispatch.h"
+#include "heatmap.h"
+#include "op_ring.h"
+#include "audio/sonify.h"
+#include "sort_control.h"
+#include "perf/trace.h"
 #include <stdatomic.h>
 #include <stdbool.h>
 
@@ -12,27 +18,124 @@ struct SortFunctionArgs {
     size_t count;
     _Atomic bool *cancelSort;
     float *speed;
+    // Pauses and steps the sort at its checkpoints, NULL for a sort that only ever stops when cancelled. Every
+    // cancel of a sort with a control has to wake it with sort_control_wake
+    struct SortControl *control;
 };
 
 // The function pointer of a sort function
 typedef void (*SortFunction)(struct SortFunctionArgs);
+// The function pointer of a selection function, which moves the k smallest values to the front of the array
+typedef void (*SelectFunction)(struct SortFunctionArgs, size_t k);
 
-int perform_sort(void *arg);
-// When we pass the perform_sort to a thread it can only take one argument, a void*, so
-// we pass this and cast it in the function! C is so safe...
-struct PerformSortArgs {
-    struct Visualizer *visualizer;
-    SortFunction sort;
-};
+// Comparisons and array writes a sort is expected to take on count values in random order
+size_t estimate_sort_ops(enum SortType sort, size_t count);
+
+struct RandomState;
 
 // Shuffle the sorting array
 void shuffle(SortValueType *values, size_t count, struct SortStats *sortStats);
+// Shuffle the sorting array drawing from a given generator instead of the calling thread's one
+void shuffle_with_random(SortValueType *values, size_t count, struct SortStats *sortStats,
+                         struct RandomState *random);
+// Compare every adjacent pair of values without branching, the building block for sortedness checks. Runs the
+// order scan kernel of the bound CPU level
+struct OrderScan scan_order(const SortValueType *values, size_t count);
 // Determine if all elements are in ascending order
 bool is_already_sorted(SortValueType *values, size_t count, struct SortStats *sortStats);
+// Record a read or write of an array element for the heatmap overlay, the drawing thread and the sonifier, nearly
+// free when none of them is listening. Writes are recorded after the value is stored, the ring carries the value
+// written
+static inline void track_read(struct SortStats *stats, const SortValueType *address)
+{
+    if (stats == NULL)
+        return;
+    if (stats->heatmap != NULL)
+        heatmap_touch(stats->heatmap, address, false);
+    if (stats->ops != NULL)
+        op_ring_push(stats->ops, SortOpRead, address, NULL);
+    if (stats->tones != NULL)
+        tone_queue_push(stats->tones, *address, false);
+}
+static inline void track_write(struct SortStats *stats, const SortValueType *address)
+{
+    if (stats == NULL)
+        return;
+    if (stats->heatmap != NULL)
+        heatmap_touch(stats->heatmap, address, true);
+    if (stats->ops != NULL)
+        op_ring_push(stats->ops, SortOpWrite, address, NULL);
+    if (stats->tones != NULL)
+        tone_queue_push(stats->tones, *address, true);
+}
+// A swap is two writes to the heatmap but a single record in the ring
+static inline void track_swap(struct SortStats *stats, const SortValueType *a, const SortValueType *b)
+{
+    if (stats == NULL)
+        return;
+    if (stats->heatmap != NULL)
+    {
+        heatmap_touch(stats->heatmap, a, true);
+        heatmap_touch(stats->heatmap, b, true);
+    }
+    if (stats->ops != NULL)
+        op_ring_push(stats->ops, SortOpSwap, a, b);
+    if (stats->tones != NULL)
+    {
+        tone_queue_push(stats->tones, *a, true);
+        tone_queue_push(stats->tones, *b, true);
+    }
+}
+// Record count values copied into the array in one go
+static inline void track_writes(struct SortStats *stats, const SortValueType *first, size_t count)
+{
+    if (stats == NULL || (stats->heatmap == NULL && stats->ops == NULL && stats->tones == NULL))
+        return;
+    for (size_t i = 0; i < count; i++)
+    {
+        track_write(stats, &first[i]);
+    }
+}
+// Where a sort stops when cancelled and waits while paused, called between steps. Returns whether the sort should
+// return. While nothing was asked of the sort this is a single relaxed load
+static inline bool sort_checkpoint(const struct SortFunctionArgs *args)
+{
+    if (args->control == NULL)
+        return atomic_load_explicit(args->cancelSort, memory_order_relaxed);
+    if (!atomic_load_explicit(&args->control->held, memory_order_relaxed))
+        return false;
+    return sort_control_hold(args, false);
+}
+// A checkpoint at the end of one phase of a sort, such as a pass, a partition or a merge, where stepping a phase at
+// a time stops
+static inline bool sort_phase_end(const struct SortFunctionArgs *args)
+{
+    if (args->control == NULL)
+        return atomic_load_explicit(args->cancelSort, memory_order_relaxed);
+    if (!atomic_load_explicit(&args->control->held, memory_order_relaxed))
+        return false;
+    return sort_control_hold(args, true);
+}
 // Swap two elements in the sorting array
 void swap(struct SortStats *stats, SortValueType *a, SortValueType *b);
+// Number of distinct keys from minimum to maximum inclusive, saturating at SIZE_MAX for full width 64-bit keys
+static inline size_t key_range(SortValueType minimum, SortValueType maximum)
+{
+    size_t span = (size_t)(maximum - minimum);
+    return span == SIZE_MAX ? SIZE_MAX : span + 1;
+}
+// Add every counter of source onto destination, keeping the larger thread count
+void sort_stats_add(struct SortStats *destination, const struct SortStats *source);
 // sleep current thread for a specified amount of microseconds
 void sleep_microseconds(uint64_t microseconds);
+// Sleep until monotonic_nanoseconds reaches deadline, without busy waiting
+void sleep_until_nanoseconds(uint64_t deadline);
+// Pause a sort between steps for the delay slider times scale microseconds, scheduled against its pacer's deadline
+// when it has one, which charges operations instead when it is paced by operation count. A sort streaming its
+// operations isn't paused, it waits on the ring instead
+void sort_delay(const struct SortFunctionArgs *args, float scale);
+// Current time of a monotonic clock in nanoseconds, only meaningful relative to another call
+uint64_t monotonic_nanoseconds(void);
 
 // Sort function forward declarations
 void bubble_sort(struct SortFunctionArgs args);
@@ -44,9 +147,31 @@ void quick_sort(struct SortFunctionArgs args);
 void merge_sort(struct SortFunctionArgs args);
 void heap_sort(struct SortFunctionArgs args);
 void bogo_sort(struct SortFunctionArgs args);
+void odd_even_sort(struct SortFunctionArgs args);
+void shear_sort(struct SortFunctionArgs args);
+void counting_sort(struct SortFunctionArgs args);
+void radix_sort(struct SortFunctionArgs args);
+void natural_merge_sort(struct SortFunctionArgs args);
+void intro_sort(struct SortFunctionArgs args);
+void auto_sort(struct SortFunctionArgs args);
+
+// Selection function forward declarations
+void nth_element(struct SortFunctionArgs args, size_t k);
+void partial_sort(struct SortFunctionArgs args, size_t k);
+void top_k(struct SortFunctionArgs args, size_t k);
 
-// All sorts
+// All sorts, indexed by enum SortType
 extern const SortFunction sortFunctions[];
+// Display name of each sort, in the same order as sortFunctions
+extern const char *const sortNames[];
+// Whether input names name, ignoring case, spaces, dashes and underscores so "few-unique" matches "Few Unique"
+bool names_match(const char *input, const char *name);
+// Look a sort up by its name, the trailing " Sort" can be left out. Returns NumSorts when there is none
+enum SortType sort_from_name(const char *name);
 extern const size_t totalSorts;
+// All selections, indexed by enum SelectType
+extern const SelectFunction selectFunctions[];
+extern const char *const selectNames[];
+extern const size_t totalSelects;
 
 #endif // !SORTS_H
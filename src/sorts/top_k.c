@@ -0,0 +1,57 @@
+#include "top_k.h"
+#include "nth_element.h"
+#include "partial_sort.h"
+
+#define TOP_K_SLEEP sort_delay(&args, 20000.0f);
+
+/*
+* Single pass over the input that keeps candidates in a buffer of 2k slots at the front of the array. Values not
+* below the current threshold (the largest of the best k so far) are skipped, and whenever the buffer fills up
+* it is cut back down to k with nth_element, lowering the threshold. That is O(n + k log k) expected work with
+* one sequential read of the input, which is what you want when the input is a stream.
+*/
+void top_k(struct SortFunctionArgs args, size_t k)
+{
+    struct SortStats *sortStats = args.sortStats;
+    SortValueType *values = args.values;
+    size_t count = args.count;
+    if (k == 0)
+        return;
+    if (k > count)
+        k = count;
+    size_t capacity = k * 2 < count ? k * 2 : count;
+    size_t fill = capacity;
+    nth_element_range(&args, 0, fill - 1, k - 1);
+    if (sort_checkpoint(&args))
+        return;
+    SortValueType threshold = values[k - 1];
+    fill = k;
+    for (size_t i = capacity; i < count; i++)
+    {
+        sortStats->comparisons++;
+        sortStats->arrayAccesses++;
+        track_read(sortStats, &values[i]);
+        if (values[i] < threshold)
+        {
+            swap(sortStats, &values[i], &values[fill++]);
+            if (fill == capacity)
+            {
+                nth_element_range(&args, 0, fill - 1, k - 1);
+                threshold = values[k - 1];
+                fill = k;
+                if (sort_phase_end(&args))
+                    return;
+            }
+        }
+        TOP_K_SLEEP
+        if (sort_checkpoint(&args))
+            return;
+    }
+    nth_element_range(&args, 0, fill - 1, k - 1);
+    if (sort_checkpoint(&args))
+        return;
+    bounded_heap_select(&args, 0, k, k);
+    if (sort_checkpoint(&args))
+        return;
+    bounded_heap_sort(&args, 0, k);
+}
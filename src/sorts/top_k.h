@@ -0,0 +1,8 @@
+#ifndef TOP_K_H
+#define TOP_K_H
+
+#include "sorts.h"
+
+void top_k(struct SortFunctionArgs args, size_t k);
+
+#endif // !TOP_K_H
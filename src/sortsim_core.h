@@ -0,0 +1,33 @@
+#ifndef SORTSIM_CORE_H
+#define SORTSIM_CORE_H
+
+/*
+* Everything the sortsim_core library offers a program embedding the sort kernels, none of it needs a window, a GPU
+* or raylib. A run sorts count values in place through the function of its SortType:
+*
+*     struct SortStats stats = {0, 0, 0, 0, 1, NULL, NULL, NULL, NULL};
+*     _Atomic bool cancel = false;
+*     float delay = 0.0f;
+*     struct SortFunctionArgs args = {&stats, values, count, &cancel, &delay, NULL};
+*     cpu_dispatch_init();
+*     random_seed_thread(RandomStreamSort);
+*     sortFunctions[Quicksort](args);
+*
+* Leaving the heatmap, pacer, ring and tone queue of the stats NULL and the delay at 0 runs at full speed with only
+* the counters kept. Randomised sorts draw from the calling thread's generator, seeded from random_set_global_seed,
+* so the same seed gives the same run. Keys are SORTSIM_KEY_BITS wide, which the library's users are built with too.
+* cpu_dispatch_init picks the kernels built for the widest instruction set the CPU has, without it every sort runs
+* the scalar ones.
+*/
+
+#include "sorts/sort_types.h"
+#include "sorts/cpu_dispatch.h"
+#include "sorts/sorts.h"
+#include "sorts/auto_sort.h"
+#include "sorts/distribution.h"
+#include "sorts/random.h"
+#include "io/dataset.h"
+#include "io/external_sort.h"
+#include "io/results.h"
+
+#endif // !SORTSIM_CORE_H
@@ -0,0 +1,446 @@
+#include "sortsim_core.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Sizes every sort and selection is checked at, small ones for the edge cases and a few past the block and chunk
+// boundaries of the kernels
+static const size_t testSizes[] = {0, 1, 2, 3, 5, 16, 17, 63, 64, 65, 100, 1000, 4097, 40000};
+static const size_t totalTestSizes = sizeof(testSizes) / sizeof(size_t);
+// Largest arrays the quadratic sorts and bogo sort are given
+#define TEST_QUADRATIC_LIMIT 4097
+#define TEST_BOGO_LIMIT 6
+// Values every sort is cancelled part way through, and the distributions it is cancelled on
+#define TEST_CANCEL_COUNT 2000
+static const enum Distribution cancelDistributions[] = {DistributionShuffled, DistributionReversed,
+                                                        DistributionFewUnique, DistributionSortedRuns};
+// Values the external sort is given under a budget that splits them into many runs and, with a fan-in of two, merges
+// those in several passes at every key width
+#define TEST_EXTERNAL_COUNT 300001
+#define TEST_EXTERNAL_BUDGET ((size_t)256 << 10)
+static const enum Distribution externalDistributions[] = {DistributionShuffled, DistributionReversed,
+                                                          DistributionFewUnique};
+// Pairs the order scan counts per chunk is 32768, sizes either side of it and of two chunks
+static const size_t kernelSizes[] = {0, 1, 2, 63, 64, 65, 1000, 32768, 32769, 32770, 65538, 100000};
+static const size_t totalKernelSizes = sizeof(kernelSizes) / sizeof(size_t);
+
+struct TestRun {
+    struct SortStats sortStats;
+    _Atomic bool cancelSort;
+    float speed;
+};
+
+// A test, run as `SortSimTests <name>`, or every test without a name
+struct TestSuite {
+    const char *name;
+    // Number of failures, every one of them printed
+    size_t (*run)(void);
+};
+
+static int compare_values(const void *a, const void *b)
+{
+    SortValueType x = *(const SortValueType *)a;
+    SortValueType y = *(const SortValueType *)b;
+    return (x > y) - (x < y);
+}
+
+static SortValueType *test_alloc_values(size_t count)
+{
+    SortValueType *values = malloc((count > 0 ? count : 1) * sizeof(SortValueType));
+    if (values == NULL)
+    {
+        fputs("Failed to allocate memory for test values\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+    return values;
+}
+
+static struct SortFunctionArgs test_sort_args(struct TestRun *run, SortValueType *values, size_t count)
+{
+    struct SortStats sortStats = {0, 0, 0, 0, 1, NULL, NULL, NULL, NULL};
+    run->sortStats = sortStats;
+    atomic_store(&run->cancelSort, false);
+    run->speed = 0.0f;
+    struct SortFunctionArgs args = {&run->sortStats, values, count, &run->cancelSort, &run->speed, NULL};
+    return args;
+}
+
+// The same input for a distribution and size every time the tests run
+static void test_generate(SortValueType *values, size_t count, enum Distribution distribution)
+{
+    distribution_generate(values, count, distribution, NULL, 0x5eed0000u + (uint64_t)distribution * 65537 + count, 0);
+}
+
+static bool sort_tested_at(enum SortType sort, size_t count)
+{
+    switch (sort)
+    {
+    case BogoSort:
+        return count <= TEST_BOGO_LIMIT;
+    case BubbleSort:
+    case SelectionSort:
+    case InsertionSort:
+    case CocktailShakerSort:
+    case OddEvenSort:
+        return count <= TEST_QUADRATIC_LIMIT;
+    default:
+        return true;
+    }
+}
+
+// A sort run on a thread of its own so the test can step it to some point and cancel it there
+struct CancelJob {
+    enum SortType sort;
+    struct SortFunctionArgs args;
+    _Atomic bool running;
+};
+
+static int cancel_job_run(void *arg)
+{
+    struct CancelJob *job = (struct CancelJob *)arg;
+    sortFunctions[job->sort](job->args);
+    atomic_store(&job->running, false);
+    return 0;
+}
+
+// Step a sort paused from its start phases phase ends on and then steps checkpoints further, and cancel it there
+static void cancel_sort_at(struct SortControl *control, enum SortType sort, SortValueType *values, size_t count,
+                           size_t phases, size_t steps, bool deferred)
+{
+    struct TestRun run;
+    struct CancelJob job;
+    job.sort = sort;
+    job.args = test_sort_args(&run, values, count);
+    job.args.control = control;
+    atomic_init(&job.running, true);
+    sort_control_start(control, true);
+    control->cancelAtPhaseEnd = deferred;
+    thrd_t thread;
+    if (thrd_create(&thread, cancel_job_run, &job) != thrd_success)
+    {
+        fputs("Failed to start a sort to cancel\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < phases + steps; i++)
+    {
+        sort_control_wait_held(control, &job.running);
+        sort_control_command(control, i < phases ? SortCommandStepPhase : SortCommandStepOp);
+    }
+    sort_control_wait_held(control, &job.running);
+    atomic_store(&run.cancelSort, true);
+    sort_control_wake(control);
+    thrd_join(thread, NULL);
+}
+
+// Every sort cancelled after a few phases and a few steps into the next, at once and deferred to the end of that
+// phase as for a file mapped in place. Either has to leave the array a permutation of its input
+static size_t test_cancel(void)
+{
+    size_t failures = 0;
+    const size_t count = TEST_CANCEL_COUNT;
+    const size_t phases[] = {0, 2};
+    const size_t steps[] = {1, 50};
+    SortValueType *input = test_alloc_values(count);
+    SortValueType *expected = test_alloc_values(count);
+    SortValueType *values = test_alloc_values(count);
+    struct SortControl control;
+    sort_control_init(&control);
+    for (size_t d = 0; d < sizeof(cancelDistributions) / sizeof(enum Distribution); d++)
+    {
+        enum Distribution distribution = cancelDistributions[d];
+        test_generate(input, count, distribution);
+        memcpy(expected, input, count * sizeof(SortValueType));
+        qsort(expected, count, sizeof(SortValueType), compare_values);
+        for (enum SortType sort = 0; sort < NumSorts; sort++)
+        {
+            for (int deferred = 0; deferred < 2; deferred++)
+            {
+                for (size_t p = 0; p < sizeof(phases) / sizeof(size_t); p++)
+                {
+                    for (size_t s = 0; s < sizeof(steps) / sizeof(size_t); s++)
+                    {
+                        memcpy(values, input, count * sizeof(SortValueType));
+                        cancel_sort_at(&control, sort, values, count, phases[p], steps[s], deferred);
+                        qsort(values, count, sizeof(SortValueType), compare_values);
+                        if (memcmp(values, expected, count * sizeof(SortValueType)) == 0)
+                            continue;
+                        fprintf(stderr, "%s cancelled%s %zu phases and %zu steps into %zu %s values lost keys\n",
+                                sortNames[sort], deferred ? " at the phase end" : "", phases[p], steps[s], count,
+                                distributionNames[distribution]);
+                        failures++;
+                    }
+                }
+            }
+        }
+    }
+    sort_control_free(&control);
+    free(values);
+    free(expected);
+    free(input);
+    return failures;
+}
+
+// Every sort on every distribution and size, against qsort of the same input
+static size_t test_sorts(void)
+{
+    size_t failures = 0;
+    for (size_t s = 0; s < totalTestSizes; s++)
+    {
+        size_t count = testSizes[s];
+        SortValueType *input = test_alloc_values(count);
+        SortValueType *expected = test_alloc_values(count);
+        SortValueType *values = test_alloc_values(count);
+        for (enum Distribution d = 0; d < NumDistributions; d++)
+        {
+            test_generate(input, count, d);
+            memcpy(expected, input, count * sizeof(SortValueType));
+            qsort(expected, count, sizeof(SortValueType), compare_values);
+            for (enum SortType sort = 0; sort < NumSorts; sort++)
+            {
+                if (!sort_tested_at(sort, count))
+                    continue;
+                struct TestRun run;
+                memcpy(values, input, count * sizeof(SortValueType));
+                sortFunctions[sort](test_sort_args(&run, values, count));
+                if (memcmp(values, expected, count * sizeof(SortValueType)) != 0)
+                {
+                    fprintf(stderr, "%s didn't sort %zu %s values\n", sortNames[sort], count, distributionNames[d]);
+                    failures++;
+                }
+            }
+        }
+        free(values);
+        free(expected);
+        free(input);
+    }
+    return failures;
+}
+
+// Every selection on every distribution and size, for a few k. The first k values have to be the k smallest and
+// the rest of the array what is left of the input
+static size_t test_selects(void)
+{
+    size_t failures = 0;
+    for (size_t s = 0; s < totalTestSizes; s++)
+    {
+        size_t count = testSizes[s];
+        if (count < 2)
+            continue;
+        SortValueType *input = test_alloc_values(count);
+        SortValueType *expected = test_alloc_values(count);
+        SortValueType *values = test_alloc_values(count);
+        SortValueType *scratch = test_alloc_values(count);
+        const size_t ks[] = {1, count / 3 > 0 ? count / 3 : 1, count - 1};
+        for (enum Distribution d = 0; d < NumDistributions; d++)
+        {
+            test_generate(input, count, d);
+            memcpy(expected, input, count * sizeof(SortValueType));
+            qsort(expected, count, sizeof(SortValueType), compare_values);
+            for (enum SelectType select = 0; select < NumSelects; select++)
+            {
+                for (size_t j = 0; j < sizeof(ks) / sizeof(size_t); j++)
+                {
+                    size_t k = ks[j];
+                    struct TestRun run;
+                    memcpy(values, input, count * sizeof(SortValueType));
+                    selectFunctions[select](test_sort_args(&run, values, count), k);
+                    memcpy(scratch, values, count * sizeof(SortValueType));
+                    qsort(scratch, k, sizeof(SortValueType), compare_values);
+                    bool smallest = memcmp(scratch, expected, k * sizeof(SortValueType)) == 0;
+                    qsort(scratch, count, sizeof(SortValueType), compare_values);
+                    if (!smallest || memcmp(scratch, expected, count * sizeof(SortValueType)) != 0)
+                    {
+                        fprintf(stderr, "%s didn't select the %zu smallest of %zu %s values\n", selectNames[select], k,
+                                count, distributionNames[d]);
+                        failures++;
+                    }
+                }
+            }
+        }
+        free(scratch);
+        free(values);
+        free(expected);
+        free(input);
+    }
+    return failures;
+}
+
+// Every kernel family at every level this machine runs, against the scalar build on the same input
+static size_t test_kernels(void)
+{
+    size_t failures = 0;
+    enum CpuLevel bound = cpu_dispatch_level();
+    cpu_dispatch_set_level(CpuLevelScalar);
+    const struct SortKernels *scalar = sort_kernels();
+    size_t(*expectedHistograms)[RADIX_BUCKETS] = calloc(RADIX_PASSES, sizeof(*expectedHistograms));
+    size_t(*histograms)[RADIX_BUCKETS] = calloc(RADIX_PASSES, sizeof(*histograms));
+    if (expectedHistograms == NULL || histograms == NULL)
+    {
+        fputs("Failed to allocate memory for test histograms\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+    for (int level = CpuLevelScalar + 1; level <= (int)cpu_detected_level(); level++)
+    {
+        cpu_dispatch_set_level((enum CpuLevel)level);
+        const struct SortKernels *kernels = sort_kernels();
+        for (size_t s = 0; s < totalKernelSizes; s++)
+        {
+            size_t count = kernelSizes[s];
+            SortValueType *values = test_alloc_values(count);
+            for (enum Distribution d = 0; d < NumDistributions; d++)
+            {
+                test_generate(values, count, d);
+                const char *name = distributionNames[d];
+                struct OrderScan expectedScan = scalar->scanOrder(values, count);
+                struct OrderScan scan = kernels->scanOrder(values, count);
+                if (scan.descents != expectedScan.descents || scan.equals != expectedScan.equals)
+                {
+                    fprintf(stderr, "Order scan at %s counted %zu descents and %zu equals in %zu %s values, scalar "
+                            "%zu and %zu\n", cpuLevelNames[level], scan.descents, scan.equals, count, name,
+                            expectedScan.descents, expectedScan.equals);
+                    failures++;
+                }
+                size_t expectedPrefix = scalar->orderedPrefix(values, count);
+                size_t prefix = kernels->orderedPrefix(values, count);
+                if (prefix != expectedPrefix)
+                {
+                    fprintf(stderr, "Ordered prefix at %s is %zu of %zu %s values, scalar %zu\n", cpuLevelNames[level],
+                            prefix, count, name, expectedPrefix);
+                    failures++;
+                }
+                memset(expectedHistograms, 0, RADIX_PASSES * sizeof(*expectedHistograms));
+                memset(histograms, 0, RADIX_PASSES * sizeof(*histograms));
+                scalar->radixHistograms(values, count, expectedHistograms);
+                kernels->radixHistograms(values, count, histograms);
+                if (memcmp(histograms, expectedHistograms, RADIX_PASSES * sizeof(*histograms)) != 0)
+                {
+                    fprintf(stderr, "Radix histograms at %s differ from scalar on %zu %s values\n",
+                            cpuLevelNames[level], count, name);
+                    failures++;
+                }
+            }
+            free(values);
+        }
+    }
+    free(histograms);
+    free(expectedHistograms);
+    cpu_dispatch_set_level(bound);
+    return failures;
+}
+
+// Write count values to path, which the tests remove once they are done with it
+static void test_write_file(const char *path, const SortValueType *values, size_t count)
+{
+    FILE *file = fopen(path, "wb");
+    if (file == NULL || fwrite(values, sizeof(SortValueType), count, file) != count || fclose(file) != 0)
+    {
+        perror(path);
+        exit(EXIT_FAILURE);
+    }
+}
+
+// Read back up to capacity values from path, returning how many it held
+static size_t test_read_file(const char *path, SortValueType *values, size_t capacity)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        perror(path);
+        return 0;
+    }
+    size_t count = fread(values, sizeof(SortValueType), capacity, file);
+    fclose(file);
+    return count;
+}
+
+// The external sort of a file in the working directory, to a second file and over itself, against qsort of the
+// same keys. Every run has to take more than one merge pass, or the multi-pass merge goes untested
+static size_t test_external(void)
+{
+    size_t failures = 0;
+    const size_t count = TEST_EXTERNAL_COUNT;
+    const char *inputPath = "sortsim-test-input.bin";
+    const char *outputPath = "sortsim-test-output.bin";
+    SortValueType *input = test_alloc_values(count);
+    SortValueType *expected = test_alloc_values(count);
+    // One more than the input, so a file with extra keys is caught
+    SortValueType *values = test_alloc_values(count + 1);
+    for (size_t d = 0; d < sizeof(externalDistributions) / sizeof(enum Distribution); d++)
+    {
+        enum Distribution distribution = externalDistributions[d];
+        test_generate(input, count, distribution);
+        memcpy(expected, input, count * sizeof(SortValueType));
+        qsort(expected, count, sizeof(SortValueType), compare_values);
+        for (int inPlace = 0; inPlace < 2; inPlace++)
+        {
+            test_write_file(inputPath, input, count);
+            struct ExternalSortOptions options = {inputPath, inPlace ? inputPath : outputPath, NULL,
+                                                  TEST_EXTERNAL_BUDGET};
+            struct ExternalSortProgress progress;
+            struct TestRun run;
+            test_sort_args(&run, NULL, 0);
+            const char *placement = inPlace ? "over itself" : "to another file";
+            if (!external_sort(&options, &run.sortStats, &run.cancelSort, &progress))
+            {
+                fprintf(stderr, "External sort of %zu %s values %s failed\n", count, distributionNames[distribution],
+                        placement);
+                failures++;
+                continue;
+            }
+            if (atomic_load(&progress.pass) < 2)
+            {
+                fprintf(stderr, "External sort of %zu %s values merged %zu runs in a single pass\n", count,
+                        distributionNames[distribution], atomic_load(&progress.generatedRuns));
+                failures++;
+            }
+            size_t read = test_read_file(options.outputPath, values, count + 1);
+            if (read != count || memcmp(values, expected, count * sizeof(SortValueType)) != 0)
+            {
+                fprintf(stderr, "External sort of %zu %s values %s wrote %zu values, not the input sorted\n", count,
+                        distributionNames[distribution], placement, read);
+                failures++;
+            }
+        }
+    }
+    remove(inputPath);
+    remove(outputPath);
+    free(values);
+    free(expected);
+    free(input);
+    return failures;
+}
+
+static const struct TestSuite suites[] = {
+    {"sorts", test_sorts},
+    {"select", test_selects},
+    {"cancel", test_cancel},
+    {"kernels", test_kernels},
+    {"external", test_external},
+};
+static const size_t totalSuites = sizeof(suites) / sizeof(struct TestSuite);
+
+int main(int argc, char **argv)
+{
+    random_set_global_seed(1);
+    random_seed_thread(RandomStreamMain);
+    cpu_dispatch_init();
+    size_t failures = 0;
+    bool found = false;
+    for (size_t i = 0; i < totalSuites; i++)
+    {
+        if (argc >= 2 && strcmp(argv[1], suites[i].name) != 0)
+            continue;
+        found = true;
+        size_t suiteFailures = suites[i].run();
+        printf("%-8s %s\n", suites[i].name, suiteFailures == 0 ? "passed" : "FAILED");
+        failures += suiteFailures;
+    }
+    if (!found)
+    {
+        fprintf(stderr, "Usage: SortSimTests [test]\n\nTests:\n");
+        for (size_t i = 0; i < totalSuites; i++)
+            fprintf(stderr, "  %s\n", suites[i].name);
+        return EXIT_FAILURE;
+    }
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
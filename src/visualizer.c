@@ -1,16 +1,66 @@
 #include "visualizer.h"
 #include "sorts/sorts.h"
+#include "sorts/auto_sort.h"
+#include "sorts/random.h"
+#include "sorts/distribution.h"
+#include "sorts/heatmap.h"
+#include "sorts/op_ring.h"
+#include "sorts/pacer.h"
+#include "race.h"
+#include "soft_render.h"
+#include "audio/sonify.h"
+#include "io/dataset.h"
+#include "io/external_sort.h"
+#include "io/results.h"
+#include "perf/perf_counters.h"
 #include <math.h>
 #include <raygui.h>
 #include <raylib.h>
+#include <rlgl.h>
 #include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <threads.h>
 
 #define MAX_VISUALIZER_SIZE 256
 #define MIN_VISUALIZER_SIZE 8
 #define TOOLBAR_HEIGHT 45
+// Most points or sectors drawn in the spiral and color wheel modes, larger arrays are sampled down to it
+#define MAX_DRAWN_POINTS 2048
+// Seconds for the heatmap's recent activity to fade to half
+#define HEATMAP_HALF_LIFE 0.25f
+// Seconds frames keep coming after a sort has finished, long enough for the heatmap to fade out
+#define VISUALIZER_SETTLE_SECONDS 2.0
+// Bars or sectors of a race pane submitted between checks that the render batch has room for them
+#define RACE_BATCH_PRIMITIVES 1024
+// Triangles a whole circle is split into at least in a race pane, so few values still make a round wheel
+#define RACE_CIRCLE_SEGMENTS 64
+// Samples the audio stream is fed in at a time, about 12 ms of latency
+#define SOUND_BUFFER_FRAMES 512
+
+// The software renderer's frame and the texture it is shown through in the window
+struct SoftCanvas {
+    struct SoftRenderer renderer;
+    Texture2D texture;
+};
+
+// The mixer and the stream its output is played through
+struct SoundOutput {
+    struct Sonifier sonifier;
+    AudioStream stream;
+};
+
+// Raylib's stream callbacks take no context, there is only ever the one stream
+static struct Sonifier *streamSonifier = NULL;
+
+struct ExternalSortJob {
+    struct ExternalSortOptions options;
+    struct ExternalSortProgress progress;
+    struct Visualizer *visualizer;
+    struct Job job;
+    uint64_t startNanoseconds;
+};
 
 static Color hsv_to_rgb(float h, float s, float v)
 {
@@ -56,37 +106,159 @@ static Color hsv_to_rgb(float h, float s, float v)
     return color;
 }
 
-void sort_stats_reset(struct SortStats *sortStats)
-{
-    sortStats->swaps = 0;
-    sortStats->comparisons = 0;
-    sortStats->arrayAccesses = 0;
-    sortStats->arrayWrites = 0;
-}
-
 void visualizer_init(struct Visualizer *visualizer)
 {
     visualizer->values = NULL;
     visualizer->count = 0;
-    struct SortStats sortStats = {0, 0, 0, 0};
+    visualizer->maximum = 1;
+    visualizer->dataset = NULL;
+    visualizer->externalJob = NULL;
+    struct SortStats sortStats = {0, 0, 0, 0, 1, NULL, NULL, NULL, NULL};
     visualizer->sortStats = sortStats;
     visualizer->mode = Staircase;
     visualizer->speed = 0.5f;
+    visualizer->timed = false;
+    visualizer->targetSeconds = 10.0f;
     visualizer->isSorting = false;
     visualizer->cancelSort = false;
+    sort_control_init(&visualizer->control);
+    visualizer->startPaused = false;
     visualizer->selectedSort = BubbleSort;
+    visualizer->autoDecision.sort = AutoSort;
+    visualizer->selectMode = false;
+    visualizer->selectedSelect = NthElement;
+    visualizer->selectFraction = 0.25f;
+    visualizer->distribution = DistributionShuffled;
+    memset(visualizer->perfBySort, 0, sizeof(visualizer->perfBySort));
+    memset(visualizer->perfBySelect, 0, sizeof(visualizer->perfBySelect));
+    visualizer->heatmapOverlay = false;
+    visualizer->heatmap = NULL;
+    visualizer->opRing = NULL;
+    visualizer->shown = NULL;
+    visualizer->streaming = false;
+    visualizer->opBudget = 0.0f;
+    visualizer->frameOps = 0;
+    visualizer->softwareRender = false;
+    visualizer->canvas = NULL;
+    visualizer->sound = true;
+    visualizer->soundOutput = NULL;
+    visualizer->results = NULL;
+    visualizer->raceMode = false;
+    memset(visualizer->raceEntries, 0, sizeof(visualizer->raceEntries));
+    visualizer->raceEntries[Quicksort] = true;
+    visualizer->raceEntries[MergeSort] = true;
+    visualizer->raceEntries[HeapSort] = true;
+    visualizer->race = NULL;
+    visualizer->jobs = NULL;
+    memset(&visualizer->sortJob, 0, sizeof(visualizer->sortJob));
+    visualizer->lastAnimated = 0.0;
+}
+
+enum VisualizerMode visualizer_mode_from_name(const char *name)
+{
+    static const char *const modeNames[NumModes] = {"Staircase", "Pyramid", "Spiral", "Color Wheel"};
+    for (size_t m = 0; m < NumModes; m++)
+    {
+        if (names_match(name, modeNames[m]))
+            return (enum VisualizerMode)m;
+    }
+    return NumModes;
+}
+
+// Stop the running sort or race, waking it if it is paused
+static void visualizer_cancel(struct Visualizer *visualizer)
+{
+    atomic_store(&visualizer->cancelSort, true);
+    sort_control_wake(&visualizer->control);
+    if (visualizer->race != NULL)
+    {
+        for (size_t i = 0; i < visualizer->race->paneCount; i++)
+        {
+            sort_control_wake(&visualizer->race->panes[i].control);
+        }
+    }
+}
+
+// Pause, resume or step the running sort, or every pane of the running race at once
+static void visualizer_command(struct Visualizer *visualizer, enum SortCommand command)
+{
+    if (!visualizer->raceMode)
+    {
+        sort_control_command(&visualizer->control, command);
+        return;
+    }
+    for (size_t i = 0; visualizer->race != NULL && i < visualizer->race->paneCount; i++)
+    {
+        sort_control_command(&visualizer->race->panes[i].control, command);
+    }
+}
+
+static bool visualizer_paused(struct Visualizer *visualizer)
+{
+    if (!visualizer->raceMode)
+        return sort_control_paused(&visualizer->control);
+    return visualizer->race != NULL && visualizer->race->paneCount > 0 &&
+           sort_control_paused(&visualizer->race->panes[0].control);
 }
 
 void visualizer_free(struct Visualizer *visualizer)
 {
-    free(visualizer->values);
+    if (visualizer->jobs != NULL)
+    {
+        if (atomic_load(&visualizer->isSorting))
+            visualizer_cancel(visualizer);
+        job_queue_wait(visualizer->jobs, &visualizer->sortJob);
+        if (visualizer->externalJob != NULL)
+            job_queue_wait(visualizer->jobs, &visualizer->externalJob->job);
+        // Race panes hold copies sized for the array, the next race makes new ones
+        if (visualizer->race != NULL)
+        {
+            race_free(visualizer->race);
+            free(visualizer->race);
+            visualizer->race = NULL;
+        }
+        atomic_store(&visualizer->cancelSort, false);
+    }
+    if (visualizer->externalJob != NULL)
+    {
+        free(visualizer->externalJob);
+        visualizer->externalJob = NULL;
+    }
+    // The heatmap is sized for the array, the next sort makes a new one
+    if (visualizer->heatmap != NULL)
+    {
+        heatmap_free(visualizer->heatmap);
+        free(visualizer->heatmap);
+        visualizer->heatmap = NULL;
+    }
+    // So are the drawn copy and the ring streaming into it
+    if (visualizer->opRing != NULL)
+    {
+        op_ring_free(visualizer->opRing);
+        free(visualizer->opRing);
+        visualizer->opRing = NULL;
+    }
+    visualizer->sortStats.ops = NULL;
+    free(visualizer->shown);
+    visualizer->shown = NULL;
+    visualizer->streaming = false;
+    if (visualizer->dataset != NULL)
+    {
+        dataset_close(visualizer->dataset);
+        free(visualizer->dataset);
+        visualizer->dataset = NULL;
+    }
+    else
+    {
+        free(visualizer->values);
+    }
     visualizer->values = NULL;
     visualizer->count = 0;
 }
 
 void visualizer_resize(struct Visualizer *visualizer, size_t count)
 {
-    free(visualizer->values);
+    visualizer_free(visualizer);
     visualizer->values = malloc(count * sizeof(SortValueType));
     if (visualizer->values == NULL)
     {
@@ -94,27 +266,648 @@ void visualizer_resize(struct Visualizer *visualizer, size_t count)
         exit(EXIT_FAILURE);
     }
     visualizer->count = count;
+    visualizer->maximum = (SortValueType)count;
     for (size_t i = 0; i < count; i++)
     {
         visualizer->values[i] = (SortValueType)(i + 1);
     }
 }
 
+bool visualizer_load(struct Visualizer *visualizer, const char *path, unsigned keyBits)
+{
+    struct Dataset *dataset = malloc(sizeof(struct Dataset));
+    if (dataset == NULL)
+    {
+        fputs("Failed to allocate memory for dataset\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+    if (!dataset_open(dataset, path, keyBits, DatasetInPlace))
+    {
+        free(dataset);
+        return false;
+    }
+    visualizer_free(visualizer);
+    visualizer->dataset = dataset;
+    visualizer->values = dataset->values;
+    visualizer->count = dataset->count;
+    SortValueType maximum = dataset_maximum(dataset);
+    visualizer->maximum = maximum > 0 ? maximum : 1;
+    return true;
+}
+
+// Value drawn at position i of drawCount as a fraction of the largest value. Arrays with more values than can be
+// drawn are sampled evenly, which keeps a multi-gigabyte dataset as cheap to draw as the largest generated array
+static size_t visualizer_index(const struct Visualizer *visualizer, size_t i, size_t drawCount)
+{
+    return drawCount == visualizer->count ? i : (size_t)((uint64_t)i * visualizer->count / drawCount);
+}
+
+static float visualizer_sample(const struct Visualizer *visualizer, size_t i, size_t drawCount)
+{
+    const SortValueType *values = visualizer->streaming ? visualizer->shown : visualizer->values;
+    return (float)values[visualizer_index(visualizer, i, drawCount)] / (float)visualizer->maximum;
+}
+
+// Colour of position i in the heatmap overlay, from cold dark blue to hot red. Recent accesses glow, what was
+// accessed a lot over the whole sort stays dimly lit after it settles
+static Color visualizer_heat_color(const struct Visualizer *visualizer, size_t i, size_t drawCount)
+{
+    float heat = 0.0f;
+    if (visualizer->heatmap != NULL)
+    {
+        size_t index = visualizer_index(visualizer, i, drawCount);
+        heat = fmaxf(heatmap_recent(visualizer->heatmap, index), 0.4f * heatmap_total(visualizer->heatmap, index));
+    }
+    heat = fminf(sqrtf(heat), 1.0f);
+    return hsv_to_rgb(0.66f * (1.0f - heat), 0.9f, 0.35f + 0.65f * heat);
+}
+
+// Colour of position i, its heat when the overlay is on and red where the last streamed accesses landed
+static Color visualizer_color(const struct Visualizer *visualizer, size_t i, size_t drawCount, Color base)
+{
+    if (visualizer->heatmapOverlay)
+        return visualizer_heat_color(visualizer, i, drawCount);
+    if (visualizer->streaming)
+    {
+        size_t index = visualizer_index(visualizer, i, drawCount);
+        if (index == visualizer->opRing->marks[0] || index == visualizer->opRing->marks[1])
+            return RED;
+    }
+    return base;
+}
+
+// Replay what a streamed sort did since the last frame onto the drawn copy, as much of it as the delay slider
+// allows. Whatever is left waits in the ring, and a full ring holds the sort back
+static void visualizer_apply_ops(struct Visualizer *visualizer)
+{
+    size_t budget = SIZE_MAX;
+    // A timed run is paced on the sorting thread, whatever it has published is due. Exported frames take a fixed share
+    if (visualizer->frameOps > 0)
+        budget = visualizer->frameOps;
+    else if (visualizer->speed > 0.0f && visualizer->pacer.targetSeconds == NULL)
+    {
+        // Records are due at the same rate the op pacer charges for them
+        float due = GetFrameTime() * 1e9f / (visualizer->speed * (float)OP_PACER_MAX_OP_NANOSECONDS);
+        visualizer->opBudget = fminf(visualizer->opBudget + due, (float)OP_RING_CAPACITY);
+        budget = (size_t)visualizer->opBudget;
+    }
+    // Heard as they are drawn, so turning the sound on halfway through a streamed sort takes effect straight away
+    visualizer->opRing->tones =
+        visualizer->sound && visualizer->soundOutput != NULL ? &visualizer->soundOutput->sonifier.queue : NULL;
+    size_t applied = op_ring_drain(visualizer->opRing, visualizer->shown, budget);
+    // A ring that ran dry doesn't bank the rest for a burst once the sort catches up
+    visualizer->opBudget = applied < budget || visualizer->frameOps > 0 ? 0.0f : visualizer->opBudget - (float)applied;
+    if (applied == 0 && !atomic_load(&visualizer->isSorting))
+    {
+        visualizer->opRing->marks[0] = SIZE_MAX;
+        visualizer->opRing->marks[1] = SIZE_MAX;
+    }
+}
+
+static size_t visualizer_draw_count(const struct Visualizer *visualizer, int available)
+{
+    size_t limit = available > 1 ? (size_t)available : 1;
+    return visualizer->count < limit ? visualizer->count : limit;
+}
+
+static void visualizer_draw_external(struct Visualizer *visualizer)
+{
+    struct ExternalSortJob *job = visualizer->externalJob;
+    struct ExternalSortProgress *progress = &job->progress;
+    static const char *const phaseNames[] = {"Starting", "Generating runs", "Merging runs", "Done", "Failed"};
+    int phase = atomic_load(&progress->phase);
+    uint64_t total = atomic_load(&progress->bytesTotal);
+    uint64_t done = atomic_load(&progress->bytesDone);
+    float fraction = total > 0 ? (float)((double)done / (double)total) : 0.0f;
+    double seconds = (double)(monotonic_nanoseconds() - job->startNanoseconds) / 1e9;
+
+    char formatted[256];
+    if (phase == ExternalSortMerging)
+        snprintf(formatted, sizeof(formatted), "%s: pass %zu over %zu runs", phaseNames[phase],
+                 atomic_load(&progress->pass), atomic_load(&progress->runs));
+    else
+        snprintf(formatted, sizeof(formatted), "%s: %zu runs written", phaseNames[phase],
+                 atomic_load(&progress->runs));
+    const int screenWidth = GetScreenWidth();
+    const int y = (GetScreenHeight() - TOOLBAR_HEIGHT) / 2;
+    DrawText(job->options.inputPath, 40, y - 70, 20, RAYWHITE);
+    DrawText(formatted, 40, y - 40, 20, RAYWHITE);
+    GuiProgressBar((Rectangle){40, (float)y, (float)(screenWidth - 80), 30}, NULL, NULL, &fraction, 0.0f, 1.0f);
+    snprintf(formatted, sizeof(formatted), "%.1f / %.1f MiB, %.1f s elapsed", (double)done / 1048576.0,
+             (double)total / 1048576.0, seconds);
+    DrawText(formatted, 40, y + 40, 20, RAYWHITE);
+}
+
+static void visualizer_pane_quad(float left, float top, float right, float bottom, Color color)
+{
+    rlColor4ub(color.r, color.g, color.b, color.a);
+    rlVertex2f(left, top);
+    rlVertex2f(left, bottom);
+    rlVertex2f(right, bottom);
+    rlVertex2f(right, top);
+}
+
+/*
+* Draw the array of one race pane inside bounds. Every bar, dot or sector goes into a single rlgl batch of quads or
+* triangles with the gaps between bars standing in for outlines, where drawing the pane like the full size array
+* would cost a draw call per bar and four more per outline, nine times over.
+*/
+static void visualizer_draw_pane(const struct Visualizer *visualizer, const struct RacePane *pane, Rectangle bounds)
+{
+    const struct Race *race = pane->race;
+    const size_t count = visualizer->count;
+    const float maximum = (float)race->maximum;
+    const enum VisualizerMode mode = visualizer->mode;
+    const size_t place = atomic_load(&pane->place);
+    Rectangle area = {bounds.x + 4.0f, bounds.y + 4.0f, bounds.width - 8.0f, bounds.height - 8.0f};
+    float extent = mode == Pyramid ? area.height : area.width;
+    size_t drawCount = count < (size_t)fmaxf(extent, 1.0f) ? count : (size_t)fmaxf(extent, 1.0f);
+    Vector2 center = {area.x + area.width / 2.0f, area.y + area.height / 2.0f};
+    float radius = fminf(area.width, area.height) / 2.0f;
+    float step = (mode == Pyramid ? area.height : area.width) / (float)drawCount;
+    float gap = step > 4.0f ? 1.0f : 0.0f;
+    float dot = fminf(fmaxf(radius / 60.0f, 1.0f), 4.0f);
+    size_t segments = mode == Circle && drawCount < RACE_CIRCLE_SEGMENTS
+                          ? (RACE_CIRCLE_SEGMENTS + drawCount - 1) / drawCount
+                          : 1;
+    // Finished panes turn green so the order they came in stays visible once the race is over
+    Color barColor = place > 0 ? GREEN : RAYWHITE;
+    for (size_t start = 0; start < drawCount; start += RACE_BATCH_PRIMITIVES)
+    {
+        size_t end = start + RACE_BATCH_PRIMITIVES < drawCount ? start + RACE_BATCH_PRIMITIVES : drawCount;
+        rlCheckRenderBatchLimit((int)((end - start) * (mode == Circle ? 3 * segments : 4)));
+        rlBegin(mode == Circle ? RL_TRIANGLES : RL_QUADS);
+        for (size_t i = start; i < end; i++)
+        {
+            size_t index = drawCount == count ? i : (size_t)((uint64_t)i * count / drawCount);
+            float value = (float)pane->values[index] / maximum;
+            switch (mode)
+            {
+            case Staircase: {
+                float left = area.x + (float)i * step;
+                float bottom = area.y + area.height;
+                visualizer_pane_quad(left, bottom - fmaxf(area.height * value, 1.0f), left + fmaxf(step - gap, 1.0f), bottom,
+                          barColor);
+                break;
+            }
+            case Pyramid: {
+                float top = area.y + (float)i * step;
+                float width = fmaxf(area.width * value, 1.0f);
+                visualizer_pane_quad(center.x - width / 2.0f, top, center.x + width / 2.0f, top + fmaxf(step - gap, 1.0f),
+                          barColor);
+                break;
+            }
+            case Spiral: {
+                float theta = (float)i * (360.0f / (float)drawCount) * 3.0f * DEG2RAD;
+                float x = center.x + radius * value * cosf(theta);
+                float y = center.y + radius * value * sinf(theta);
+                visualizer_pane_quad(x - dot, y - dot, x + dot, y + dot, place > 0 ? GREEN : BLUE);
+                break;
+            }
+            case Circle: {
+                Color color = hsv_to_rgb(value, 1.0f, 1.0f);
+                float sector = 360.0f / (float)drawCount;
+                float segment = sector / (float)segments;
+                rlColor4ub(color.r, color.g, color.b, color.a);
+                // Same winding as raylib's own sectors, which are culled when drawn the other way round
+                for (size_t s = 0; s < segments; s++)
+                {
+                    float angle = ((float)i * sector + (float)s * segment) * DEG2RAD;
+                    float next = angle + segment * DEG2RAD;
+                    rlVertex2f(center.x, center.y);
+                    rlVertex2f(center.x + cosf(next) * radius, center.y + sinf(next) * radius);
+                    rlVertex2f(center.x + cosf(angle) * radius, center.y + sinf(angle) * radius);
+                }
+                break;
+            }
+            default:
+                fputs("Error: Current selected visualizer mode is somehow invalid, tell a programmer!\n", stderr);
+                exit(EXIT_FAILURE);
+            }
+        }
+        rlEnd();
+    }
+    DrawRectangleLinesEx(bounds, place == 1 ? 3.0f : 1.0f, place == 1 ? GREEN : DARKGRAY);
+
+    // Stats of the pane, top left of it
+    const struct SortStats *sortStats = &pane->sortStats;
+    char formatted[256];
+    uint64_t nanoseconds = place > 0 || !atomic_load(&visualizer->isSorting)
+                               ? pane->wallNanoseconds
+                               : monotonic_nanoseconds() - race->startNanoseconds;
+    if (place > 0)
+        snprintf(formatted, sizeof(formatted), "#%zu %s: %.2f s", place, sortNames[pane->sort],
+                 (double)nanoseconds / 1e9);
+    else
+        snprintf(formatted, sizeof(formatted), "%s: %.2f s", sortNames[pane->sort], (double)nanoseconds / 1e9);
+    DrawText(formatted, (int)area.x + 6, (int)area.y + 6, 20, GREEN);
+    snprintf(formatted, sizeof(formatted), "Comparisons: %zu\nArray Writes: %zu\nSwaps: %zu", sortStats->comparisons,
+             sortStats->arrayWrites, sortStats->swaps);
+    if (place == 0 && atomic_load(&visualizer->isSorting))
+    {
+        size_t length = strlen(formatted);
+        snprintf(formatted + length, sizeof(formatted) - length, "\nPace: %llu ops/s, %.1f ms behind",
+                 (unsigned long long)atomic_load(&pane->pacer.opsPerSecond),
+                 (double)atomic_load(&pane->pacer.lagNanoseconds) / 1e6);
+    }
+    DrawText(formatted, (int)area.x + 6, (int)area.y + 30, 10, GREEN);
+}
+
+// The panes of a race in a grid as close to square as their number allows, filling the space above the toolbar
+static void visualizer_draw_race(const struct Visualizer *visualizer)
+{
+    const struct Race *race = visualizer->race;
+    size_t columns = 1;
+    while (columns * columns < race->paneCount)
+    {
+        columns++;
+    }
+    size_t rows = (race->paneCount + columns - 1) / columns;
+    float paneWidth = (float)GetScreenWidth() / (float)columns;
+    float paneHeight = (float)(GetScreenHeight() - TOOLBAR_HEIGHT) / (float)rows;
+    for (size_t i = 0; i < race->paneCount; i++)
+    {
+        Rectangle bounds = {(float)(i % columns) * paneWidth, (float)(i / columns) * paneHeight, paneWidth,
+                            paneHeight};
+        visualizer_draw_pane(visualizer, &race->panes[i], bounds);
+    }
+}
+
+// Bring the drawn copy of a streamed sort and the heatmap up to this frame
+static void visualizer_advance(struct Visualizer *visualizer)
+{
+    if (visualizer->streaming)
+        visualizer_apply_ops(visualizer);
+    // Sorting threads only count into their shards, everything else about the heatmap happens here once a frame
+    if (visualizer->heatmap != NULL)
+        heatmap_merge(visualizer->heatmap, exp2f(-GetFrameTime() / HEATMAP_HALF_LIFE));
+}
+
+// Bar of the staircase as drawn, in pixels
+struct SoftBar {
+    int x;
+    int y;
+    int width;
+    int height;
+};
+
+// What the bands of a software drawn frame are drawn from, worked out once before they start
+struct SoftFrame {
+    const struct Visualizer *visualizer;
+    size_t drawCount;
+    // Length and colour of every drawn position
+    const float *samples;
+    const uint32_t *colors;
+    // Cotangent of the angle every sector of the color wheel starts at
+    const float *cotangents;
+    // Bars of the staircase
+    const struct SoftBar *bars;
+};
+
+static uint32_t visualizer_pixel(Color color)
+{
+    return soft_pixel(color.r, color.g, color.b, color.a);
+}
+
+// Draw one band of the array in the current mode, laid out as visualizer_draw lays it out
+static void visualizer_draw_band(void *context, const struct SoftBand *band)
+{
+    const struct SoftFrame *frame = (const struct SoftFrame *)context;
+    const struct Visualizer *visualizer = frame->visualizer;
+    const int screenWidth = band->width;
+    const int screenHeight = band->height;
+    const size_t drawCount = frame->drawCount;
+    const uint32_t black = visualizer_pixel(BLACK);
+    float drawHeight = (float)(screenHeight - TOOLBAR_HEIGHT) / (float)screenHeight;
+    switch (visualizer->mode)
+    {
+    case Staircase: {
+        // Row by row rather than bar by bar, so neighbouring bars of the same colour that both reach a row are filled
+        // as one span, and thin bars aren't written one pixel per cache line
+        const struct SoftBar *bars = frame->bars;
+        for (int row = band->top; row < band->bottom; row++)
+        {
+            uint32_t *pixels = band->pixels + (size_t)row * (size_t)screenWidth;
+            for (size_t i = 0; i < drawCount;)
+            {
+                if (row < bars[i].y || row >= bars[i].y + bars[i].height)
+                {
+                    i++;
+                    continue;
+                }
+                int start = bars[i].x;
+                int end = bars[i].x + bars[i].width;
+                uint32_t color = frame->colors[i];
+                for (i++; i < drawCount && row >= bars[i].y && row < bars[i].y + bars[i].height && bars[i].x <= end &&
+                          frame->colors[i] == color;
+                     i++)
+                {
+                    end = bars[i].x + bars[i].width;
+                }
+                if (start < 0)
+                    start = 0;
+                if (end > screenWidth)
+                    end = screenWidth;
+                if (start < end)
+                    soft_fill_span(pixels, start, end, color);
+            }
+        }
+        if ((float)screenWidth / (float)drawCount > 4.0f)
+        {
+            for (size_t i = 0; i < drawCount; i++)
+            {
+                soft_outline_rect(band, bars[i].x, bars[i].y, bars[i].width, bars[i].height, black);
+            }
+        }
+        break;
+    }
+    case Pyramid: {
+        float barHeight = ((float)screenHeight / (float)drawCount) * drawHeight;
+        // Bars are stacked top to bottom, only those reaching into the band are looked at
+        size_t first = (size_t)fmaxf((float)band->top / barHeight - 1.0f, 0.0f);
+        for (size_t i = first; i < drawCount && barHeight * (float)i < (float)band->bottom; i++)
+        {
+            float barWidth = (float)screenWidth * frame->samples[i];
+            int x = (int)(((float)screenWidth - barWidth) / 2);
+            int y = (int)(barHeight * (float)i);
+            int width = (int)(barWidth);
+            int height = (int)(barHeight);
+            if (width < 1)
+                width = 1;
+            if (height < 1)
+                height = 1;
+            soft_fill_rect(band, x, y, width, height, frame->colors[i]);
+            if (barHeight > 4.0f)
+                soft_outline_rect(band, x, y, width, (int)((float)height * drawHeight), black);
+        }
+        break;
+    }
+    case Spiral: {
+        float theta = 0.0f;
+        float deltaTheta = (360.0f / (float)drawCount) * 3.0f;
+        Vector2 center = {(float)screenWidth / 2.0f, (float)screenHeight / 2.0f - TOOLBAR_HEIGHT / 2.0f};
+        float radius = ((float)screenHeight * drawHeight) / 2.0f;
+        for (size_t i = 0; i < drawCount; i++)
+        {
+            float x = center.x + radius * frame->samples[i] * cosf(theta * DEG2RAD);
+            float y = center.y + radius * frame->samples[i] * sinf(theta * DEG2RAD);
+            soft_fill_circle(band, (float)(int)x, (float)(int)y, 5.0f, frame->colors[i]);
+            theta += deltaTheta;
+        }
+        break;
+    }
+    case Circle: {
+        // Along a row of the disc the angle only ever falls below the centre and rises above it, so the row is cut
+        // into one span for every sector it crosses, ending where it meets the sector's edge. Only the first pixel's
+        // sector needs an arc tangent
+        float theta = 360.0f / (float)drawCount;
+        Vector2 center = {(float)screenWidth / 2.0f, (float)screenHeight / 2.0f - TOOLBAR_HEIGHT / 2.0f};
+        float radius = ((float)screenHeight * drawHeight) / 2.0f;
+        int top = (int)fmaxf(floorf(center.y - radius), (float)band->top);
+        int bottom = (int)fminf(ceilf(center.y + radius), (float)band->bottom);
+        for (int row = top; row < bottom; row++)
+        {
+            // A row through the centre is taken as just below it, it still has to be either side of it
+            float dy = (float)row + 0.5f - center.y;
+            dy = dy < 0.0f ? fminf(dy, -1e-3f) : fmaxf(dy, 1e-3f);
+            float squared = radius * radius - dy * dy;
+            if (squared < 0.0f)
+                continue;
+            float half = sqrtf(squared);
+            int left = (int)fmaxf(ceilf(center.x - half - 0.5f), 0.0f);
+            int right = (int)fminf(floorf(center.x + half - 0.5f) + 1.0f, (float)screenWidth);
+            uint32_t *pixels = band->pixels + (size_t)row * (size_t)screenWidth;
+            if (left >= right)
+                continue;
+            float angle = atan2f(dy, (float)left + 0.5f - center.x) * RAD2DEG;
+            if (angle < 0.0f)
+                angle += 360.0f;
+            size_t sector = (size_t)(angle / theta);
+            if (sector >= drawCount)
+                sector = drawCount - 1;
+            bool below = dy > 0.0f;
+            for (int x = left; x < right;)
+            {
+                // Below the centre the angle falls towards the sector's first edge, above it rises to its last
+                size_t edge = below ? sector : sector + 1;
+                int end = right;
+                if (edge > 0 && edge < drawCount)
+                    end = (int)fminf(fmaxf(floorf(center.x + dy * frame->cotangents[edge] - 0.5f) + 1.0f,
+                                           (float)x), (float)right);
+                soft_fill_span(pixels, x, end, frame->colors[sector]);
+                x = end;
+                if (below ? sector == 0 : sector + 1 == drawCount)
+                    break;
+                sector = below ? sector - 1 : sector + 1;
+            }
+        }
+        break;
+    }
+    default:
+        fputs("Error: Current selected visualizer mode is somehow invalid, tell a programmer!\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+    if (visualizer->selectMode)
+    {
+        float position = (float)visualizer_select_k(visualizer) / (float)visualizer->count;
+        uint32_t red = visualizer_pixel(RED);
+        if (visualizer->mode == Staircase)
+            soft_fill_rect(band, (int)(position * (float)screenWidth) - 1, 0, 2, screenHeight - TOOLBAR_HEIGHT, red);
+        else if (visualizer->mode == Pyramid)
+            soft_fill_rect(band, 0, (int)(position * (float)screenHeight * drawHeight) - 1, screenWidth, 2, red);
+    }
+}
+
+// Draw the array into the renderer's framebuffer at its current size. The lengths and colours are looked up here
+// once, so the bands only ever read plain arrays
+static void visualizer_rasterize(const struct Visualizer *visualizer, struct SoftRenderer *renderer)
+{
+    size_t drawCount;
+    switch (visualizer->mode)
+    {
+    case Staircase:
+        drawCount = visualizer_draw_count(visualizer, renderer->width);
+        break;
+    case Pyramid:
+        drawCount = visualizer_draw_count(visualizer, renderer->height - TOOLBAR_HEIGHT);
+        break;
+    default:
+        drawCount = visualizer_draw_count(visualizer, MAX_DRAWN_POINTS);
+        break;
+    }
+    struct SoftBar *bars =
+        soft_renderer_scratch(renderer, drawCount * (sizeof(struct SoftBar) + 2 * sizeof(float) + sizeof(uint32_t)));
+    float *samples = (float *)(bars + drawCount);
+    uint32_t *colors = (uint32_t *)(samples + drawCount);
+    float *cotangents = (float *)(colors + drawCount);
+    for (size_t i = 0; i < drawCount; i++)
+    {
+        samples[i] = visualizer_sample(visualizer, i, drawCount);
+        Color base = RAYWHITE;
+        if (visualizer->mode == Spiral)
+            base = BLUE;
+        else if (visualizer->mode == Circle)
+            base = hsv_to_rgb(samples[i], 1.0f, 1.0f);
+        colors[i] = visualizer_pixel(visualizer_color(visualizer, i, drawCount, base));
+        float edge = (float)i * (360.0f / (float)drawCount) * DEG2RAD;
+        cotangents[i] = cosf(edge) / sinf(edge);
+        // Laid out as visualizer_draw lays out the staircase
+        float drawHeight = (float)(renderer->height - TOOLBAR_HEIGHT) / (float)renderer->height;
+        float barWidth = (float)renderer->width / (float)drawCount;
+        float barHeight = (float)renderer->height * samples[i] * drawHeight;
+        bars[i].x = (int)((float)i * barWidth);
+        bars[i].y = renderer->height - (int)barHeight - TOOLBAR_HEIGHT;
+        bars[i].width = barWidth < 1.0f ? 1 : (int)barWidth;
+        bars[i].height = barHeight < 1.0f ? 1 : (int)barHeight;
+    }
+    struct SoftFrame frame = {visualizer, drawCount, samples, colors, cotangents, bars};
+    soft_renderer_draw(renderer, visualizer_pixel(BLACK), visualizer_draw_band, &frame);
+}
+
+// Draw the array on the CPU and show it with one texture upload, in place of a primitive call for every value
+static void visualizer_draw_canvas(struct Visualizer *visualizer, int screenWidth, int screenHeight)
+{
+    struct SoftCanvas *canvas = visualizer->canvas;
+    if (canvas == NULL)
+    {
+        canvas = malloc(sizeof(struct SoftCanvas));
+        if (canvas == NULL)
+        {
+            fputs("Failed to allocate memory for software renderer\n", stderr);
+            exit(EXIT_FAILURE);
+        }
+        soft_renderer_init(&canvas->renderer);
+        canvas->texture.id = 0;
+        visualizer->canvas = canvas;
+    }
+    soft_renderer_resize(&canvas->renderer, screenWidth, screenHeight);
+    visualizer_rasterize(visualizer, &canvas->renderer);
+    if (canvas->texture.id == 0 || canvas->texture.width != screenWidth || canvas->texture.height != screenHeight)
+    {
+        if (canvas->texture.id != 0)
+            UnloadTexture(canvas->texture);
+        Image image = {canvas->renderer.pixels, screenWidth, screenHeight, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+        canvas->texture = LoadTextureFromImage(image);
+    }
+    else
+    {
+        UpdateTexture(canvas->texture, canvas->renderer.pixels);
+    }
+    DrawTexture(canvas->texture, 0, 0, WHITE);
+}
+
+void visualizer_render(struct Visualizer *visualizer, struct SoftRenderer *renderer)
+{
+    visualizer_advance(visualizer);
+    visualizer_rasterize(visualizer, renderer);
+}
+
+// Fills the stream's buffers on the audio device's thread
+static void visualizer_mix_sound(void *buffer, unsigned int frames)
+{
+    sonifier_mix(streamSonifier, (float *)buffer, frames);
+}
+
+void visualizer_load_audio(struct Visualizer *visualizer)
+{
+    if (!IsAudioDeviceReady())
+    {
+        fputs("No audio device, sorts will be silent\n", stderr);
+        return;
+    }
+    struct SoundOutput *output = malloc(sizeof(struct SoundOutput));
+    if (output == NULL)
+    {
+        fputs("Failed to allocate memory for sound\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+    sonifier_init(&output->sonifier);
+    sonifier_scale(&output->sonifier, visualizer->maximum);
+    streamSonifier = &output->sonifier;
+    SetAudioStreamBufferSizeDefault(SOUND_BUFFER_FRAMES);
+    output->stream = LoadAudioStream(SONIFY_SAMPLE_RATE, 32, 1);
+    SetAudioStreamCallback(output->stream, visualizer_mix_sound);
+    PlayAudioStream(output->stream);
+    if (!visualizer->sound)
+        PauseAudioStream(output->stream);
+    visualizer->soundOutput = output;
+}
+
+// Turn the sound on or off. What was queued while it was off is thrown away rather than played late
+static void visualizer_set_sound(struct Visualizer *visualizer, bool sound)
+{
+    visualizer->sound = sound;
+    if (visualizer->soundOutput == NULL)
+        return;
+    if (sound)
+    {
+        sonifier_flush(&visualizer->soundOutput->sonifier);
+        ResumeAudioStream(visualizer->soundOutput->stream);
+    }
+    else
+    {
+        PauseAudioStream(visualizer->soundOutput->stream);
+    }
+}
+
+void visualizer_unload(struct Visualizer *visualizer)
+{
+    if (visualizer->soundOutput != NULL)
+    {
+        UnloadAudioStream(visualizer->soundOutput->stream);
+        streamSonifier = NULL;
+        // A running sort may still be queueing tones
+        if (visualizer->jobs != NULL)
+        {
+            if (atomic_load(&visualizer->isSorting))
+                visualizer_cancel(visualizer);
+            job_queue_wait(visualizer->jobs, &visualizer->sortJob);
+        }
+        visualizer->sortStats.tones = NULL;
+        sonifier_free(&visualizer->soundOutput->sonifier);
+        free(visualizer->soundOutput);
+        visualizer->soundOutput = NULL;
+    }
+    if (visualizer->canvas == NULL)
+        return;
+    if (visualizer->canvas->texture.id != 0)
+        UnloadTexture(visualizer->canvas->texture);
+    soft_renderer_free(&visualizer->canvas->renderer);
+    free(visualizer->canvas);
+    visualizer->canvas = NULL;
+}
+
 void visualizer_draw(struct Visualizer *visualizer)
 {
     const int screenWidth = GetScreenWidth();
     const int screenHeight = GetScreenHeight();
+    if (visualizer->externalJob != NULL)
+    {
+        visualizer_draw_external(visualizer);
+        return;
+    }
+    if (visualizer->raceMode && visualizer->race != NULL && visualizer->race->paneCount > 0)
+    {
+        visualizer_draw_race(visualizer);
+        return;
+    }
+    visualizer_advance(visualizer);
+    if (visualizer->softwareRender)
+    {
+        visualizer_draw_canvas(visualizer, screenWidth, screenHeight);
+        return;
+    }
     float drawHeight = (screenHeight - TOOLBAR_HEIGHT) / (float)screenHeight;
 
     switch (visualizer->mode)
     {
     case Staircase: {
-        float barWidth = (float)screenWidth / visualizer->count;
-        float barUnitHeight = (float)screenHeight / visualizer->count;
+        size_t drawCount = visualizer_draw_count(visualizer, screenWidth);
+        float barWidth = (float)screenWidth / drawCount;
 
-        for (size_t i = 0; i < visualizer->count; i++)
+        for (size_t i = 0; i < drawCount; i++)
         {
-            float barHeight = barUnitHeight * visualizer->values[i] * drawHeight;
+            float barHeight = (float)screenHeight * visualizer_sample(visualizer, i, drawCount) * drawHeight;
             int x = (int)(i * barWidth);
             int y = screenHeight - (int)barHeight;
             int width = (int)barWidth;
@@ -123,7 +916,7 @@ void visualizer_draw(struct Visualizer *visualizer)
                 width = 1;
             if (height < 1)
                 height = 1;
-            DrawRectangle(x, y - TOOLBAR_HEIGHT, width, height, RAYWHITE);
+            DrawRectangle(x, y - TOOLBAR_HEIGHT, width, height, visualizer_color(visualizer, i, drawCount, RAYWHITE));
             if (barWidth > 4.0f)
             {
                 DrawRectangleLines(x, y - TOOLBAR_HEIGHT, width, height, BLACK);
@@ -132,11 +925,11 @@ void visualizer_draw(struct Visualizer *visualizer)
         break;
     }
     case Pyramid: {
-        float barUnitWidth = (float)screenWidth / visualizer->count;
-        float barHeight = ((float)screenHeight / visualizer->count) * drawHeight;
-        for (size_t i = 0; i < visualizer->count; i++)
+        size_t drawCount = visualizer_draw_count(visualizer, screenHeight - TOOLBAR_HEIGHT);
+        float barHeight = ((float)screenHeight / drawCount) * drawHeight;
+        for (size_t i = 0; i < drawCount; i++)
         {
-            float barWidth = barUnitWidth * visualizer->values[i];
+            float barWidth = (float)screenWidth * visualizer_sample(visualizer, i, drawCount);
             int x = (int)(((float)screenWidth - barWidth) / 2);
             int y = (int)(barHeight * i);
             int width = (int)(barWidth);
@@ -145,7 +938,7 @@ void visualizer_draw(struct Visualizer *visualizer)
                 width = 1;
             if (height < 1)
                 height = 1;
-            DrawRectangle(x, y, width, height, RAYWHITE);
+            DrawRectangle(x, y, width, height, visualizer_color(visualizer, i, drawCount, RAYWHITE));
             if (barHeight > 4.0f)
             {
                 DrawRectangleLines(x, y, width, (int)(height * drawHeight), BLACK);
@@ -154,30 +947,32 @@ void visualizer_draw(struct Visualizer *visualizer)
         break;
     }
     case Spiral: {
+        size_t drawCount = visualizer_draw_count(visualizer, MAX_DRAWN_POINTS);
         float theta = 0.0f; 
-        float deltaTheta = (360.0f / visualizer->count) * 3.0f;
+        float deltaTheta = (360.0f / drawCount) * 3.0f;
         Vector2 center = {(float)screenWidth / 2.0f, (float)(screenHeight / 2.0f) - TOOLBAR_HEIGHT / 2.0f};
         float radius = ((float)screenHeight * drawHeight) / 2.0f;
 
-        for (size_t i = 0; i < visualizer->count; i++) {
-            float length = visualizer->values[i] / (float)visualizer->count;
+        for (size_t i = 0; i < drawCount; i++) {
+            float length = visualizer_sample(visualizer, i, drawCount);
             float x = center.x + radius * length * cosf(theta * DEG2RAD);
             float y = center.y + radius * length * sinf(theta * DEG2RAD);
-            DrawCircle(x, y, 5.0f, BLUE);
+            DrawCircle(x, y, 5.0f, visualizer_color(visualizer, i, drawCount, BLUE));
             theta += deltaTheta;
         }
         break;
     }
     case Circle: {
-        float theta = 360.0f / visualizer->count;
+        size_t drawCount = visualizer_draw_count(visualizer, MAX_DRAWN_POINTS);
+        float theta = 360.0f / drawCount;
         Vector2 center = {(float)screenWidth / 2.0f, (float)(screenHeight / 2.0f) - TOOLBAR_HEIGHT / 2.0f};
         float radius = ((float)screenHeight * drawHeight) / 2.0f;
-        for (size_t i = 0; i < visualizer->count; i++)
+        for (size_t i = 0; i < drawCount; i++)
         {
             float startAngle = theta * i;
             float endAngle = theta * (i + 1);
-            float hue = (visualizer->values[i] / (float)visualizer->count);
-            Color color = hsv_to_rgb(hue, 1.0f, 1.0f);
+            float hue = visualizer_sample(visualizer, i, drawCount);
+            Color color = visualizer_color(visualizer, i, drawCount, hsv_to_rgb(hue, 1.0f, 1.0f));
             DrawCircleSector(center, radius, startAngle, endAngle, 10, color);
         }
         break;
@@ -186,20 +981,36 @@ void visualizer_draw(struct Visualizer *visualizer)
         fputs("Error: Current selected visualizer mode is somehow invalid, tell a programmer!\n", stderr);
         exit(EXIT_FAILURE);
     }
+    // Mark where the k smallest values end when selecting
+    if (visualizer->selectMode)
+    {
+        float position = (float)visualizer_select_k(visualizer) / (float)visualizer->count;
+        if (visualizer->mode == Staircase)
+        {
+            int x = (int)(position * (float)screenWidth);
+            DrawRectangle(x - 1, 0, 2, screenHeight - TOOLBAR_HEIGHT, RED);
+        }
+        else if (visualizer->mode == Pyramid)
+        {
+            int y = (int)(position * (float)screenHeight * drawHeight);
+            DrawRectangle(0, y - 1, screenWidth, 2, RED);
+        }
+    }
 }
 
-void visualizer_draw_gui(struct Visualizer *visualizer)
+// Counters of the run top left, what auto sort picked below them and hardware counters top right
+static void visualizer_draw_stats(struct Visualizer *visualizer)
 {
-    // Top left text
     struct SortStats *sortStats = &visualizer->sortStats;
-    char formatted[256];
+    char formatted[512];
     int result = snprintf(formatted, sizeof(formatted),
                           "Swaps Made : %zu\nComparisons Made : %zu\n"
-                          "Array Accesses: %zu\nArray Writes: %zu",
+                          "Array Accesses: %zu\nArray Writes: %zu\nKernels: %s",
                           sortStats->swaps,
                           sortStats->comparisons,
                           sortStats->arrayAccesses,
-                          sortStats->arrayWrites
+                          sortStats->arrayWrites,
+                          cpuLevelNames[cpu_dispatch_level()]
                           );
     if (result == -1)
     {
@@ -207,6 +1018,86 @@ void visualizer_draw_gui(struct Visualizer *visualizer)
         exit(EXIT_FAILURE);
     }
     DrawText(formatted, 20, 20, 20, GREEN);
+    if (!visualizer->selectMode && visualizer->selectedSort == AutoSort && visualizer->autoDecision.sort != AutoSort)
+    {
+        struct AutoSortDecision *decision = &visualizer->autoDecision;
+        result = snprintf(formatted, sizeof(formatted), "Auto picked %s: %s", sortNames[decision->sort],
+                          decision->reason);
+        if (result == -1)
+        {
+            fputs("Failed to format string\n", stderr);
+            exit(EXIT_FAILURE);
+        }
+        DrawText(formatted, 20, 132, 20, GREEN);
+    }
+    // Hardware counters of the last run of the selected sort, top right
+    const struct PerfSample *perfSample = visualizer->selectMode ? &visualizer->perfBySelect[visualizer->selectedSelect]
+                                                                 : &visualizer->perfBySort[visualizer->selectedSort];
+    if (!atomic_load(&visualizer->isSorting) && perfSample->available[PerfTaskClock])
+    {
+        int length = 0;
+        if (!perfSample->available[PerfCycles])
+            length += snprintf(formatted, sizeof(formatted), "Hardware counters unavailable\n");
+        for (int i = 0; i < NumPerfCounters && length < (int)sizeof(formatted); i++)
+        {
+            if (perfSample->available[i])
+                length += snprintf(formatted + length, sizeof(formatted) - (size_t)length, "%s: %llu\n",
+                                   perfCounterNames[i], (unsigned long long)perfSample->values[i]);
+        }
+        if (perfSample->available[PerfCycles] && length < (int)sizeof(formatted))
+            snprintf(formatted + length, sizeof(formatted) - (size_t)length, "IPC: %.2f", perf_sample_ipc(perfSample));
+        DrawText(formatted, GetScreenWidth() - 340, 20, 20, GREEN);
+    }
+    // While it runs, the pace of the sort goes where its hardware counters will be
+    else if (atomic_load(&visualizer->isSorting) && visualizer->externalJob == NULL)
+    {
+        unsigned long long rate = (unsigned long long)atomic_load(&visualizer->pacer.opsPerSecond);
+        if (visualizer->streaming)
+        {
+            // A streamed sort is paced by the drawing thread, how far behind it is shows as records still queued
+            size_t queued = atomic_load(&visualizer->opRing->head) - atomic_load(&visualizer->opRing->tail);
+            snprintf(formatted, sizeof(formatted), "Pace: %llu ops/s\nQueued: %zu ops", rate, queued);
+        }
+        else
+        {
+            double lag = (double)atomic_load(&visualizer->pacer.lagNanoseconds) / 1e6;
+            snprintf(formatted, sizeof(formatted), "Pace: %llu ops/s\nBehind: %.1f ms", rate, lag);
+        }
+        if (visualizer->pacer.targetSeconds != NULL)
+        {
+            size_t length = strlen(formatted);
+            snprintf(formatted + length, sizeof(formatted) - length, "\n%zu ops in %.0f s",
+                     visualizer->pacer.targetOps, visualizer->targetSeconds);
+        }
+        DrawText(formatted, GetScreenWidth() - 340, 20, 20, GREEN);
+    }
+}
+
+// Check boxes picking the sorts of the next race, in place of the stats while no race panes are shown
+static void visualizer_draw_race_entries(struct Visualizer *visualizer)
+{
+    size_t entries = race_entry_count(visualizer);
+    char formatted[64];
+    snprintf(formatted, sizeof(formatted), "Racing %zu sorts, pick %d to %d", entries, RACE_MIN_PANES,
+             RACE_MAX_PANES);
+    DrawText(formatted, 20, 20, 20, GREEN);
+    for (size_t s = 0; s < NumSorts; s++)
+    {
+        // A full race only lets sorts be taken out
+        if (entries >= RACE_MAX_PANES && !visualizer->raceEntries[s])
+            GuiLock();
+        GuiCheckBox((Rectangle){20, 50.0f + 24.0f * (float)s, 16, 16}, sortNames[s], &visualizer->raceEntries[s]);
+        GuiUnlock();
+    }
+}
+
+void visualizer_draw_gui(struct Visualizer *visualizer)
+{
+    // Race panes carry stats of their own
+    if (!visualizer->raceMode)
+        visualizer_draw_stats(visualizer);
+    else if (!atomic_load(&visualizer->isSorting) && (visualizer->race == NULL || visualizer->race->paneCount == 0))
+        visualizer_draw_race_entries(visualizer);
     // Toolbar
     DrawRectangle(0, GetScreenHeight() - TOOLBAR_HEIGHT, GetScreenWidth(), TOOLBAR_HEIGHT,
                   GetColor(GuiGetStyle(DEFAULT, BACKGROUND_COLOR)));
@@ -221,8 +1112,17 @@ void visualizer_draw_gui(struct Visualizer *visualizer)
     }
     // Draw rollup box
     GuiSetStyle(DROPDOWNBOX, DROPDOWN_ROLL_UP, 1);
-    if (GuiDropdownBox((Rectangle){10, widgetY, 150, 20},
-                       "Bubble Sort;Selection Sort;Insertion Sort;Shell Sort;Cocktail Shaker Sort;Quick Sort;Merge Sort;Heap Sort;Bogo Sort",
+    if (visualizer->selectMode)
+    {
+        if (GuiDropdownBox((Rectangle){10, widgetY, 150, 20}, "Nth Element;Partial Sort;Top K",
+                           (int *)&visualizer->selectedSelect, sortDropdownEditMode))
+        {
+            sortDropdownEditMode = !sortDropdownEditMode;
+        }
+    }
+    else if (GuiDropdownBox((Rectangle){10, widgetY, 150, 20},
+                       "Bubble Sort;Selection Sort;Insertion Sort;Shell Sort;Cocktail Shaker Sort;Quick Sort;Merge Sort;Heap Sort;"
+                       "Bogo Sort;Odd-Even Sort;Shear Sort;Counting Sort;Radix Sort;Natural Merge Sort;Intro Sort;K-Way Merge Sort;Auto",
                        (int*)&visualizer->selectedSort, sortDropdownEditMode))
     {
         sortDropdownEditMode = !sortDropdownEditMode;
@@ -235,15 +1135,46 @@ void visualizer_draw_gui(struct Visualizer *visualizer)
     {
         modeDropdwonEditMode = !modeDropdwonEditMode;
     }
+    // Input distribution dropdown
+    static bool distributionDropdownEditMode = false;
+    if (atomic_load(&visualizer->isSorting) || visualizer->dataset != NULL) {
+        GuiLock();
+    }
+    if (GuiDropdownBox((Rectangle){290, widgetY, 120, 20},
+                       "Shuffled;Random;Sorted;Reversed;Nearly Sorted;Sawtooth;Organ Pipe;Few Unique;All Equal;Zipf;"
+                       "Gaussian;Sorted Runs",
+                       (int *)&visualizer->distribution, distributionDropdownEditMode))
+    {
+        // Picking a new input fills the array with it straight away
+        if (distributionDropdownEditMode)
+            visualizer_generate(visualizer);
+        distributionDropdownEditMode = !distributionDropdownEditMode;
+    }
+    GuiUnlock();
     GuiSetStyle(DROPDOWNBOX, DROPDOWN_ROLL_UP, 0);
-    // Speed slider
-    GuiSliderBar((Rectangle){290, widgetY, 140, 20}, NULL, "Delay", &visualizer->speed, 0.0f, 1.0f);
+    // Speed slider, or the length of a timed run in its place. Either changes the pace of a run that is going on
+    if (visualizer->timed && !visualizer->raceMode)
+    {
+        char durationText[16];
+        snprintf(durationText, sizeof(durationText), "%.0f s", visualizer->targetSeconds);
+        GuiSliderBar((Rectangle){420, widgetY, 60, 20}, NULL, durationText, &visualizer->targetSeconds,
+                     MIN_TARGET_SECONDS, MAX_TARGET_SECONDS);
+    }
+    else
+    {
+        GuiSliderBar((Rectangle){420, widgetY, 60, 20}, NULL, "Delay", &visualizer->speed, 0.0f, 1.0f);
+    }
+    // Runs are counted before they start, and a race is paced by operations for a fair start whatever its length
+    if (atomic_load(&visualizer->isSorting) || visualizer->raceMode)
+        GuiLock();
+    GuiToggle((Rectangle){532, widgetY, 44, 20}, "Timed", &visualizer->timed);
+    GuiUnlock();
     // Size slider
     if (atomic_load(&visualizer->isSorting)) {
         GuiLock();
     }
     static float x = (float)DEFAULT_VISUALIZER_SIZE / (float)(MAX_VISUALIZER_SIZE - MIN_VISUALIZER_SIZE);
-    if (GuiSliderBar((Rectangle){480, widgetY, 140, 20}, NULL, "Size", &x, 0.0f, 1.0f)) {
+    if (GuiSliderBar((Rectangle){580, widgetY, 110, 20}, NULL, "Size", &x, 0.0f, 1.0f)) {
         float new_size = (float)MIN_VISUALIZER_SIZE + x * (float)(MAX_VISUALIZER_SIZE - MIN_VISUALIZER_SIZE);
         visualizer_resize(visualizer, (size_t)new_size);
     };
@@ -251,37 +1182,389 @@ void visualizer_draw_gui(struct Visualizer *visualizer)
     // Sort and shuffle button
     if (atomic_load(&visualizer->isSorting))
     {
-        if (GuiButton((Rectangle){660, widgetY, 50, 20}, "Cancel"))
+        // A loaded file is sorted in place, a cancel only stops the sort once its current phase has put every key back
+        bool stopping = visualizer->dataset != NULL && atomic_load(&visualizer->cancelSort);
+        if (stopping)
+            GuiLock();
+        if (GuiButton((Rectangle){730, widgetY, 55, 20}, stopping ? "Stopping" : "Cancel"))
         {
-            atomic_store(&visualizer->cancelSort, true);
+            visualizer_cancel(visualizer);
         }
-        GuiLock();
-        GuiButton((Rectangle){720, widgetY, 50, 20}, "Shuffle");
+        GuiUnlock();
+        // An external sort can only be cancelled
+        if (visualizer->externalJob != NULL)
+            GuiLock();
+        bool paused = visualizer_paused(visualizer);
+        if (GuiButton((Rectangle){790, widgetY, 55, 20}, paused ? "Resume" : "Pause"))
+            visualizer_command(visualizer, paused ? SortCommandResume : SortCommandPause);
         GuiUnlock();
     }
     else
     {
-        if (GuiButton((Rectangle){660, widgetY, 50, 20}, "Shuffle"))
+        if (GuiButton((Rectangle){730, widgetY, 55, 20}, "Shuffle"))
+        {
+            visualizer_generate(visualizer);
+        }
+        if (visualizer->raceMode)
         {
-            shuffle(visualizer->values, visualizer->count, NULL);
+            if (race_entry_count(visualizer) < RACE_MIN_PANES)
+                GuiLock();
+            if (GuiButton((Rectangle){790, widgetY, 55, 20}, "Race"))
+                race_start(visualizer);
+            GuiUnlock();
         }
-        if (GuiButton((Rectangle){720, widgetY, 50, 20}, "Sort"))
+        else if (GuiButton((Rectangle){790, widgetY, 55, 20}, visualizer->selectMode ? "Select" : "Sort"))
         {
             visualizer_start_sort(visualizer);
         }
     }
+    // Selection, heatmap and race toggles and k slider, the first two make way for the step buttons while sorting
+    bool wasRacing = visualizer->raceMode;
+    if (atomic_load(&visualizer->isSorting))
+    {
+        if (visualizer->externalJob != NULL)
+            GuiLock();
+        if (GuiButton((Rectangle){855, widgetY, 60, 20}, "Step"))
+            visualizer_command(visualizer, SortCommandStepOp);
+        if (GuiButton((Rectangle){920, widgetY, 60, 20}, "Phase"))
+            visualizer_command(visualizer, SortCommandStepPhase);
+        GuiLock();
+    }
+    else
+    {
+        GuiToggle((Rectangle){855, widgetY, 60, 20}, "Selection", &visualizer->selectMode);
+        // Accesses are only tracked for sorts started with the overlay on
+        GuiToggle((Rectangle){920, widgetY, 60, 20}, "Heatmap", &visualizer->heatmapOverlay);
+    }
+    if (visualizer->selectMode)
+    {
+        char kText[32];
+        snprintf(kText, sizeof(kText), "K = %zu", visualizer_select_k(visualizer));
+        GuiSliderBar((Rectangle){1035, widgetY, 40, 20}, NULL, kText, &visualizer->selectFraction, 0.0f, 1.0f);
+    }
+    // A loaded file may be far too large to copy for every pane
+    if (visualizer->dataset != NULL)
+        GuiLock();
+    GuiToggle((Rectangle){985, widgetY, 45, 20}, "Race", &visualizer->raceMode);
+    GuiUnlock();
+    // Selecting and racing are both modes of the sort button, turning one on turns the other off
+    if (visualizer->selectMode && visualizer->raceMode)
+    {
+        if (wasRacing)
+            visualizer->raceMode = false;
+        else
+            visualizer->selectMode = false;
+    }
+    // Seed box, pressing enter reseeds so the following shuffles can be reproduced
+    static char seedText[24] = "";
+    static bool seedEditMode = false;
+    if (!seedEditMode)
+        snprintf(seedText, sizeof(seedText), "%llu", (unsigned long long)random_global_seed());
+    if (GuiTextBox((Rectangle){1140, widgetY, 95, 20}, seedText, (int)sizeof(seedText), seedEditMode))
+    {
+        if (seedEditMode)
+        {
+            random_set_global_seed(strtoull(seedText, NULL, 0));
+            random_seed_thread(RandomStreamMain);
+        }
+        seedEditMode = !seedEditMode;
+    }
+    GuiLabel((Rectangle){1235, widgetY, 40, 20}, "Seed");
+    // M mutes and unmutes the tones of compares and writes
+    if (!seedEditMode && IsKeyPressed(KEY_M))
+        visualizer_set_sound(visualizer, !visualizer->sound);
+    // I steps the kernels down an instruction set, from scalar back up to the widest the CPU has. A running sort
+    // picks them up from its next call into them
+    if (!seedEditMode && IsKeyPressed(KEY_I))
+    {
+        enum CpuLevel level = cpu_dispatch_level();
+        cpu_dispatch_set_level(level == CpuLevelScalar ? cpu_detected_level() : (enum CpuLevel)(level - 1));
+    }
+    // Space pauses and resumes the running sort, N steps it by one operation and P by one phase
+    if (atomic_load(&visualizer->isSorting) && visualizer->externalJob == NULL && !seedEditMode)
+    {
+        if (IsKeyPressed(KEY_SPACE))
+            visualizer_command(visualizer, visualizer_paused(visualizer) ? SortCommandResume : SortCommandPause);
+        if (IsKeyPressed(KEY_N))
+            visualizer_command(visualizer, SortCommandStepOp);
+        if (IsKeyPressed(KEY_P))
+            visualizer_command(visualizer, SortCommandStepPhase);
+    }
 }
 
-void visualizer_start_sort(struct Visualizer *visualizer)
+bool visualizer_animating(struct Visualizer *visualizer)
 {
-    if (is_already_sorted(visualizer->values, visualizer->count, NULL))
+    bool busy = atomic_load(&visualizer->isSorting);
+    // The ring may still hold a finished sort's last accesses, or the array it left after a cancel
+    if (visualizer->streaming)
+        busy = busy || atomic_load(&visualizer->opRing->head) != atomic_load(&visualizer->opRing->tail) ||
+               atomic_load(&visualizer->opRing->resync);
+    double now = GetTime();
+    if (busy)
+        visualizer->lastAnimated = now;
+    return now - visualizer->lastAnimated < VISUALIZER_SETTLE_SECONDS;
+}
+
+void visualizer_generate(struct Visualizer *visualizer)
+{
+    // The panes of the last race and the copy of the last streamed sort make way for the new input
+    if (visualizer->race != NULL)
+        visualizer->race->paneCount = 0;
+    visualizer->streaming = false;
+    // A loaded file is only ever reordered, never overwritten with generated values
+    if (visualizer->dataset != NULL)
+    {
+        shuffle(visualizer->values, visualizer->count, NULL);
         return;
-    thrd_t sortThreadID;
+    }
+    distribution_generate(visualizer->values, visualizer->count, visualizer->distribution, NULL,
+                          random_next(random_thread_state()), 0);
+}
+
+static int perform_external_sort(void *arg)
+{
+    struct ExternalSortJob *job = (struct ExternalSortJob *)arg;
+    struct Visualizer *visualizer = job->visualizer;
+    trace_thread_name("External Sort");
+    random_seed_thread(RandomStreamSort);
+    sort_stats_reset(&visualizer->sortStats);
+    visualizer->sortStats.heatmap = NULL;
+    visualizer->sortStats.pacer = NULL;
+    visualizer->sortStats.ops = NULL;
+    visualizer->sortStats.tones = NULL;
+    external_sort(&job->options, &visualizer->sortStats, &visualizer->cancelSort, &job->progress);
+    atomic_store(&visualizer->isSorting, false);
+    return 0;
+}
+
+void visualizer_start_external_sort(struct Visualizer *visualizer, const struct ExternalSortOptions *options)
+{
+    struct ExternalSortJob *job = malloc(sizeof(struct ExternalSortJob));
+    if (job == NULL)
+    {
+        fputs("Failed to allocate memory for external sort\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+    job->options = *options;
+    job->visualizer = visualizer;
+    job->startNanoseconds = monotonic_nanoseconds();
+    atomic_store(&job->progress.phase, ExternalSortIdle);
+    atomic_store(&job->progress.bytesTotal, 0);
+    atomic_store(&job->progress.bytesDone, 0);
+    atomic_store(&job->progress.runs, 0);
+    atomic_store(&job->progress.generatedRuns, 0);
+    atomic_store(&job->progress.pass, 0);
+    visualizer->externalJob = job;
     atomic_store(&visualizer->isSorting, true);
     atomic_store(&visualizer->cancelSort, false);
-    if (thrd_create(&sortThreadID, perform_sort, (void *)visualizer) != thrd_success)
+    job_queue_submit(visualizer->jobs, &job->job, perform_external_sort, job);
+}
+
+// Append a finished run of the visualizer to its results log
+static void record_run(struct Visualizer *visualizer, uint64_t wallNanoseconds, const struct PerfSample *perfSample)
+{
+    char algorithm[96];
+    if (visualizer->selectMode)
+        snprintf(algorithm, sizeof(algorithm), "%s (k = %zu)", selectNames[visualizer->selectedSelect],
+                 visualizer_select_k(visualizer));
+    else if (visualizer->selectedSort == AutoSort)
+        snprintf(algorithm, sizeof(algorithm), "Auto (%s)", sortNames[visualizer->autoDecision.sort]);
+    else
+        snprintf(algorithm, sizeof(algorithm), "%s", sortNames[visualizer->selectedSort]);
+    struct RunRecord record;
+    record.source = "gui";
+    record.algorithm = algorithm;
+    record.count = visualizer->count;
+    record.distribution = visualizer->dataset != NULL ? "file" : distributionNames[visualizer->distribution];
+    record.seed = random_global_seed();
+    record.wallNanoseconds = wallNanoseconds;
+    record.sortStats = visualizer->sortStats;
+    record.perf = perfSample;
+    results_write(visualizer->results, &record);
+}
+
+// Run whichever sort or selection the visualizer has selected
+static void run_selected(struct Visualizer *visualizer, struct SortFunctionArgs args)
+{
+    if (visualizer->selectMode)
+        selectFunctions[visualizer->selectedSelect](args, visualizer_select_k(visualizer));
+    else if (visualizer->selectedSort == AutoSort)
+        auto_sort_dispatch(args, &visualizer->autoDecision);
+    else
+        sortFunctions[visualizer->selectedSort](args);
+}
+
+// Comparisons and array writes the run the visualizer is about to start will take, counted by running it on a copy
+// of the array. Mapped files are too large to copy and bogo sort might never finish, those are estimated instead
+static size_t count_run_ops(struct Visualizer *visualizer)
+{
+    enum SortType sort = visualizer->selectedSort == AutoSort ? visualizer->autoDecision.sort : visualizer->selectedSort;
+    if (visualizer->dataset != NULL || (!visualizer->selectMode && sort == BogoSort))
+        return visualizer->selectMode ? 4 * visualizer->count : estimate_sort_ops(sort, visualizer->count);
+    SortValueType *values = malloc(visualizer->count * sizeof(SortValueType));
+    if (values == NULL)
     {
-        fputs("Error creating thread\n", stderr);
+        fputs("Failed to allocate memory to count sort operations\n", stderr);
         exit(EXIT_FAILURE);
     }
+    memcpy(values, visualizer->values, visualizer->count * sizeof(SortValueType));
+    // The run draws the same numbers as the real one will, on this thread's stream which is put back afterwards
+    struct RandomState saved = *random_thread_state();
+    random_seed_thread(RandomStreamSort);
+    struct SortStats sortStats = {0, 0, 0, 0, 1, NULL, NULL, NULL, NULL};
+    _Atomic bool cancelSort = false;
+    float speed = 0.0f;
+    struct SortFunctionArgs args = {&sortStats, values, visualizer->count, &cancelSort, &speed, NULL};
+    trace_begin("count run");
+    run_selected(visualizer, args);
+    trace_end("count run");
+    *random_thread_state() = saved;
+    free(values);
+    return sortStats.comparisons + sortStats.arrayWrites;
+}
+
+// Runs the visualizer's selected sort or selection on one of its workers
+static int perform_sort(void *arg)
+{
+    struct Visualizer *visualizer = (struct Visualizer *)arg;
+    trace_thread_name("Sort");
+    // Every run draws the same numbers for the same seed, whichever thread it lands on
+    random_seed_thread(RandomStreamSort);
+    sort_stats_reset(&visualizer->sortStats);
+    struct SortFunctionArgs sortFunctionArgs = {&visualizer->sortStats, visualizer->values, visualizer->count,
+                                         &visualizer->cancelSort, &visualizer->speed, &visualizer->control};
+    struct PerfCounters perfCounters;
+    perf_counters_open(&perfCounters);
+    perf_counters_start(&perfCounters);
+    const char *runName = visualizer->selectMode ? selectNames[visualizer->selectedSelect]
+                                                 : sortNames[visualizer->selectedSort];
+    trace_begin(runName);
+    uint64_t start = monotonic_nanoseconds();
+    run_selected(visualizer, sortFunctionArgs);
+    // Time spent paused is left out, so stepping through a run doesn't skew its results
+    uint64_t wallNanoseconds = monotonic_nanoseconds() - start - visualizer->control.pausedNanoseconds;
+    trace_end(runName);
+    if (visualizer->sortStats.ops != NULL)
+        op_ring_publish(visualizer->sortStats.ops);
+    struct PerfSample *perfSample = visualizer->selectMode ? &visualizer->perfBySelect[visualizer->selectedSelect]
+                                                           : &visualizer->perfBySort[visualizer->selectedSort];
+    perf_counters_stop(&perfCounters, perfSample);
+    perf_counters_close(&perfCounters);
+    // Cancelled runs are left out, they would only skew comparisons
+    if (visualizer->results != NULL && !atomic_load(&visualizer->cancelSort))
+        record_run(visualizer, wallNanoseconds, perfSample);
+    if (atomic_load(&visualizer->cancelSort))
+    {
+        // A cancelled sort on a loaded file leaves it as far as it got rather than overwriting it
+        if (visualizer->dataset == NULL)
+            distribution_generate(visualizer->values, visualizer->count, visualizer->distribution, NULL,
+                                  random_next(random_thread_state()), 0);
+        if (visualizer->sortStats.ops != NULL)
+            op_ring_resync(visualizer->sortStats.ops);
+        sort_stats_reset(&visualizer->sortStats);
+        atomic_store(&visualizer->cancelSort, false);
+    }
+    atomic_store(&visualizer->isSorting, false);
+    return 0;
+}
+
+/*
+* Stream the accesses of the sort about to start to the drawing thread. Sorts writing the array from several threads
+* at once can't feed a single producer ring and a mapped file is too large to keep a copy of, those are drawn
+* straight from the array as it is written instead.
+*/
+static void visualizer_start_stream(struct Visualizer *visualizer)
+{
+    enum SortType sort = visualizer->selectedSort == AutoSort ? visualizer->autoDecision.sort : visualizer->selectedSort;
+    visualizer->sortStats.ops = NULL;
+    visualizer->streaming = visualizer->dataset == NULL &&
+                            (visualizer->selectMode || (sort != OddEvenSort && sort != ShearSort));
+    if (!visualizer->streaming)
+        return;
+    if (visualizer->opRing == NULL)
+    {
+        visualizer->opRing = malloc(sizeof(struct OpRing));
+        if (visualizer->opRing == NULL)
+        {
+            fputs("Failed to allocate memory for operation ring\n", stderr);
+            exit(EXIT_FAILURE);
+        }
+        op_ring_init(visualizer->opRing);
+    }
+    if (visualizer->shown == NULL)
+    {
+        visualizer->shown = malloc(visualizer->count * sizeof(SortValueType));
+        if (visualizer->shown == NULL)
+        {
+            fputs("Failed to allocate memory for visualizer\n", stderr);
+            exit(EXIT_FAILURE);
+        }
+    }
+    memcpy(visualizer->shown, visualizer->values, visualizer->count * sizeof(SortValueType));
+    op_ring_reset(visualizer->opRing, visualizer->values, visualizer->count, &visualizer->cancelSort);
+    visualizer->opBudget = 0.0f;
+    visualizer->sortStats.ops = visualizer->opRing;
+}
+
+void visualizer_start_sort(struct Visualizer *visualizer)
+{
+    if (is_already_sorted(visualizer->values, visualizer->count, NULL))
+        return;
+    if (!visualizer->selectMode && visualizer->selectedSort == AutoSort)
+    {
+        // Probe here rather than on the sort thread so the GUI never reads a half written decision
+        auto_sort_probe(visualizer->values, visualizer->count, &visualizer->autoDecision);
+        fprintf(stderr, "Auto sort chose %s: %s\n", sortNames[visualizer->autoDecision.sort],
+                visualizer->autoDecision.reason);
+    }
+    if (visualizer->dataset != NULL)
+    {
+        enum SortType sort = visualizer->selectMode ? Quicksort : visualizer->selectedSort;
+        if (sort == AutoSort)
+            sort = visualizer->autoDecision.sort;
+        dataset_advise(visualizer->dataset, sort);
+    }
+    visualizer->sortStats.heatmap = NULL;
+    if (visualizer->heatmapOverlay)
+    {
+        if (visualizer->heatmap == NULL)
+        {
+            visualizer->heatmap = malloc(sizeof(struct AccessHeatmap));
+            if (visualizer->heatmap == NULL)
+            {
+                fputs("Failed to allocate memory for access heatmap\n", stderr);
+                exit(EXIT_FAILURE);
+            }
+            heatmap_init(visualizer->heatmap, visualizer->values, visualizer->count);
+        }
+        else
+        {
+            heatmap_reset(visualizer->heatmap);
+        }
+        visualizer->sortStats.heatmap = visualizer->heatmap;
+    }
+    // The last run has cleared isSorting, but it may still be on its way out of perform_sort
+    job_queue_wait(visualizer->jobs, &visualizer->sortJob);
+    // Counted before the pacer starts, so the count doesn't already put the run behind
+    size_t targetOps = visualizer->timed ? count_run_ops(visualizer) : 0;
+    op_pacer_start(&visualizer->pacer, &visualizer->speed, false);
+    if (visualizer->timed)
+        op_pacer_target(&visualizer->pacer, &visualizer->targetSeconds, targetOps);
+    visualizer->sortStats.pacer = &visualizer->pacer;
+    visualizer_start_stream(visualizer);
+    // A streamed sort runs ahead of what is drawn by whatever the ring holds, it is heard as the drawing thread
+    // replays it instead. The others are drawn straight from the array and heard straight from the sort
+    visualizer->sortStats.tones = NULL;
+    if (visualizer->soundOutput != NULL)
+    {
+        sonifier_scale(&visualizer->soundOutput->sonifier, visualizer->maximum);
+        if (visualizer->sound && !visualizer->streaming)
+            visualizer->sortStats.tones = &visualizer->soundOutput->sonifier.queue;
+    }
+    sort_control_start(&visualizer->control, visualizer->startPaused);
+    // Cancelling part way through a pass would leave some of the file's keys only in the sort's scratch
+    visualizer->control.cancelAtPhaseEnd = visualizer->dataset != NULL;
+    atomic_store(&visualizer->isSorting, true);
+    atomic_store(&visualizer->cancelSort, false);
+    job_queue_submit(visualizer->jobs, &visualizer->sortJob, perform_sort, visualizer);
 }
@@ -7,10 +7,16 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include "parallel/job_queue.h"
+#include "perf/perf_counters.h"
+#include "sorts/pacer.h"
+#include "sorts/sort_control.h"
+#include "sorts/sort_types.h"
 
 #define DEFAULT_VISUALIZER_SIZE 64
-
-typedef uint16_t SortValueType;
+// Range of the length a timed run can be spread over, in seconds
+#define MIN_TARGET_SECONDS 1.0f
+#define MAX_TARGET_SECONDS 120.0f
 
 enum VisualizerMode {
     Staircase,
@@ -20,43 +26,127 @@ enum VisualizerMode {
     NumModes,
 };
 
-enum SortType {
-    BubbleSort,
-    SelectionSort,
-    InsertionSort,
-    CocktailShakerSort,
-    Quicksort,
-    MergeSort,
-    BogoSort,
-};
-
-struct SortStats {
-    size_t swaps;
-    size_t comparisons;
-    size_t arrayAccesses;
-    size_t arrayWrites;
-};
-
-// Set all sort stats to zero
-void sort_stats_reset(struct SortStats *sortStats);
+struct Dataset;
+struct ExternalSortJob;
+struct ExternalSortOptions;
+struct Race;
+struct ResultsLog;
+struct SoftCanvas;
+struct SoftRenderer;
+struct SoundOutput;
 
 struct Visualizer
 {
     SortValueType *values;
     size_t count;
+    // Largest value in the array, bars are drawn relative to it
+    SortValueType maximum;
+    // File the values are mapped from, or NULL when they were generated
+    struct Dataset *dataset;
+    // Out of core sort of a file too large to map, its progress is drawn instead of the array while it runs
+    struct ExternalSortJob *externalJob;
     struct SortStats sortStats;
     enum VisualizerMode mode;
     float speed;
+    // Spread a sort over targetSeconds whatever its number of operations, instead of pacing it off the delay slider
+    bool timed;
+    float targetSeconds;
     _Atomic bool isSorting;
     _Atomic bool cancelSort;
+    // Pauses and steps the running sort, race panes have one each
+    struct SortControl control;
+    // Start sorts paused at their first checkpoint, for stepping through them from the start
+    bool startPaused;
+    // Schedules the delays of the running sort and measures its pace for the HUD
+    struct OpPacer pacer;
     enum SortType selectedSort;
+    // Filled in on the GUI thread when an auto sort starts, sort is AutoSort until then
+    struct AutoSortDecision autoDecision;
+    // When set the sort button runs selectedSelect instead, moving the k smallest values to the front
+    bool selectMode;
+    enum SelectType selectedSelect;
+    // k as a fraction of count
+    float selectFraction;
+    // Pattern the shuffle button fills the array with
+    enum Distribution distribution;
+    // Hardware counters of the last run of every sort and selection, written by the sort thread before it clears
+    // isSorting so the GUI only reads them while no sort is running
+    struct PerfSample perfBySort[NumSorts];
+    struct PerfSample perfBySelect[NumSelects];
+    // Colour the array by how often each part of it is read and written instead of by value
+    bool heatmapOverlay;
+    // Counts of the current or last sort, allocated when the overlay is first turned on
+    struct AccessHeatmap *heatmap;
+    // Accesses of the running sort on their way to the drawing thread, allocated by the first streamed sort
+    struct OpRing *opRing;
+    // The array as drawn while streaming, which trails the sort by whatever is still in the ring
+    SortValueType *shown;
+    // Draw shown instead of values, set for a streamed sort and cleared once the array is refilled
+    bool streaming;
+    // Records the drawing thread may still apply, topped up every frame from the delay slider
+    float opBudget;
+    // Records applied every frame whatever the delay slider says, 0 to follow the slider. Set when exporting frames
+    // so each of them moves the sort on by the same amount
+    size_t frameOps;
+    // Draw the array on the CPU and upload it as one texture, see soft_render.h. Races and external sorts are still
+    // drawn by raylib
+    bool softwareRender;
+    // Framebuffer and texture of the software renderer, made by the first frame drawn with it
+    struct SoftCanvas *canvas;
+    // Play a tone for every value compared or written, pitched by the value, see audio/sonify.h
+    bool sound;
+    // Stream the tones are mixed into, NULL until visualizer_load_audio has opened it
+    struct SoundOutput *soundOutput;
+    // Where every finished run is recorded, NULL when results aren't exported
+    struct ResultsLog *results;
+    // Split the screen between sorts racing on copies of the array instead of sorting it, see race.h
+    bool raceMode;
+    // Sorts ticked to take part in the next race
+    bool raceEntries[NumSorts];
+    // Panes of the current or last race, NULL until the first one starts
+    struct Race *race;
+    // Long lived workers that sorts and the panes of a race run on, set before the first sort is started
+    struct JobQueue *jobs;
+    struct Job sortJob;
+    // Window time of the last frame something was still moving, see visualizer_animating
+    double lastAnimated;
 };
 
 void visualizer_init(struct Visualizer *visualizer);
+// Mode of the name shown in the mode dropdown, ignoring case and spaces, NumModes when nothing matches
+enum VisualizerMode visualizer_mode_from_name(const char *name);
+// Cancel and wait for a running sort, then release the array
 void visualizer_free(struct Visualizer *visualizer);
 void visualizer_resize(struct Visualizer *visualizer, size_t count);
+// Replace the array with a binary file of keys mapped in place, sorting it rewrites the file. A cancel lets the pass
+// or merge under way finish, so the file always holds its own keys. Returns false and keeps the current array when
+// the file can't be mapped
+bool visualizer_load(struct Visualizer *visualizer, const char *path, unsigned keyBits);
 void visualizer_start_sort(struct Visualizer *visualizer);
+// Sort a file larger than memory on a background thread, showing run generation and merge progress
+void visualizer_start_external_sort(struct Visualizer *visualizer, const struct ExternalSortOptions *options);
+// Refill the array following the selected distribution
+void visualizer_generate(struct Visualizer *visualizer);
+
+// The k passed to the selected selection function for the current size
+static inline size_t visualizer_select_k(const struct Visualizer *visualizer)
+{
+    size_t k = (size_t)(visualizer->selectFraction * (float)visualizer->count);
+    if (k < 1)
+        k = 1;
+    return k < visualizer->count ? k : visualizer->count;
+}
 void visualizer_draw(struct Visualizer *visualizer);
+// Draw the next frame of the array into renderer's framebuffer at its size, without needing a window or GPU
+void visualizer_render(struct Visualizer *visualizer, struct SoftRenderer *renderer);
+// Open the stream accesses are heard through, once the audio device is up
+void visualizer_load_audio(struct Visualizer *visualizer);
+// Release the software renderer's texture and threads and the audio stream, while the window and audio device are
+// still open
+void visualizer_unload(struct Visualizer *visualizer);
 void visualizer_draw_gui(struct Visualizer *visualizer);
+// Whether the next frames would change without any input, because a sort is running or has only just finished and
+// its last accesses are still being replayed or fading from the heatmap. From the drawing thread only
+bool visualizer_animating(struct Visualizer *visualizer);
 
 #endif // !VISUALIZER_H
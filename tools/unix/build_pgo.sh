@@ -0,0 +1,51 @@
+#! /bin/sh
+#
+# Release build with LTO and a profile trained on the benchmarks, in three steps:
+#   1. build/release, LTO only, timed as the baseline
+#   2. build/pgo with SORTSIM_PGO=GENERATE, run over the training suites to write the profile
+#   3. build/pgo again with SORTSIM_PGO=USE, timed the same way as the baseline
+# and ends with the wall time of every kernel in both timed builds side by side. Extra arguments are passed to
+# cmake, such as -DSORTSIM_VISUALIZER=OFF. The optimized binaries are left in build/pgo.
+
+set -e
+cd "$(dirname "$0")/../.."
+root=$(pwd)
+
+# Sizes and distributions representative of what gets sorted, kept small enough to train in a few minutes
+train() {
+    ./SortSimBench matrix --sizes 1k,16k,64k
+    ./SortSimBench select
+    ./SortSimBench auto
+    ./SortSimBench kway
+}
+
+# Best of three of the matrix, the kernels compared afterwards
+measure() {
+    rm -f "$1"
+    for run in 1 2 3; do
+        ./SortSimBench matrix --sizes 64k --results "$1" > /dev/null
+    done
+}
+
+cmake -DCMAKE_BUILD_TYPE=Release -DSORTSIM_LTO=ON -DSORTSIM_PGO=OFF "$@" -S "$root" -B "$root/build/release"
+cmake --build "$root/build/release" -j
+cd "$root/build/release"
+measure "$root/build/before.csv"
+
+# Stale counters from an earlier training run would be added to the new ones
+rm -rf "$root/build/pgo/profile"
+cmake -DCMAKE_BUILD_TYPE=Release -DSORTSIM_LTO=ON -DSORTSIM_PGO=GENERATE "$@" -S "$root" -B "$root/build/pgo"
+cmake --build "$root/build/pgo" -j
+cd "$root/build/pgo"
+train > /dev/null
+# Clang writes raw profiles to be merged into the one it reads, GCC reads its own directly
+if ls profile/*.profraw > /dev/null 2>&1; then
+    llvm-profdata merge -output=profile/default.profdata profile/*.profraw
+fi
+
+# Same directory, the object paths the GCC profiles are named after have to match
+cmake -DSORTSIM_PGO=USE "$root/build/pgo"
+cmake --build "$root/build/pgo" -j --clean-first
+measure "$root/build/after.csv"
+
+./SortSimBench compare "$root/build/before.csv" "$root/build/after.csv"
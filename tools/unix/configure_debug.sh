@@ -1,3 +1,3 @@
 #! /bin/sh
 
-cmake -DCMAKE_CXX_FLAGS="-O0" -S ../../ -B ../../build/
\ No newline at end of file
+cmake -DCMAKE_BUILD_TYPE=Debug -S ../../ -B ../../build/
\ No newline at end of file
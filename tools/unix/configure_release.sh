@@ -1,3 +1,3 @@
 #! /bin/sh
 
-cmake -DCMAKE_CXX_FLAGS="-O3" -S ../../ -B ../../build/
\ No newline at end of file
+cmake -DCMAKE_BUILD_TYPE=Release -DSORTSIM_LTO=ON -S ../../ -B ../../build/
\ No newline at end of file